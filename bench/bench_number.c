@@ -0,0 +1,90 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Times number literals: SetNumberType on its own, strtod on
+ * the same text for comparison, and a whole run of one
+ * expression made of them all. The literals are half 9 digit
+ * integers, a quarter with 2 decimals and a quarter with 9.
+ *
+ *   cmake -S . -B build -DBUILD_BENCH=1 -DCMAKE_BUILD_TYPE=Release
+ *   cmake --build build && ./build/bench/build/bench_number [count]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Condor.h"
+#include "condor/number/number.h"
+#include "utils/clock.h"
+
+#define BENCH_LITERALS 200000
+#define BENCH_ROUNDS 20
+
+uint64_t NextBenchBits(uint64_t* state){
+	*state = *state * 6364136223846793005UL + 1442695040888963407UL;
+	return *state >> 33;
+}
+
+int WriteLiteral(uint64_t* state, char* buffer){
+	uint64_t bits = NextBenchBits(state);
+	switch (bits % 4){
+		case 0: return sprintf(buffer, "%lu.%02lu", 10000 + bits % 90000, bits % 100);
+		case 1: return sprintf(buffer, "%lu.%09lu", 10 + bits % 990, (bits * 7919) % 1000000000);
+		default: return sprintf(buffer, "%lu", 10000000 + (bits * 31) % 990000000);
+	}
+}
+
+int main(int argc, char** argv){
+	int count = argc > 1 ? atoi(argv[1]) : BENCH_LITERALS;
+	char* literals = malloc((size_t) count * 24);
+	char** starts = malloc(sizeof(char*) * count);
+	int* lengths = malloc(sizeof(int) * count);
+	uint64_t state = 1;
+	char* spot = literals;
+	for (int i = 0; i < count; i++){
+		starts[i] = spot;
+		lengths[i] = WriteLiteral(&state, spot);
+		spot += lengths[i] + 1;
+	}
+
+	Clock clock;
+	ASTNode node;
+	double sum = 0;
+	StartClock(&clock);
+	for (int r = 0; r < BENCH_ROUNDS; r++){
+		for (int i = 0; i < count; i++){
+			SetNumberType(&node, starts[i], lengths[i]);
+			sum += node.type == DOUBLE ? node.meta.doubleExpr.value : (double) node.meta.longExpr.value;
+		}
+	}
+	EndClock(&clock);
+	printf("SetNumberType: %.1f ns per literal\n", GetClockNanosecond(&clock) / ((double) BENCH_ROUNDS * count));
+
+	double check = 0;
+	StartClock(&clock);
+	for (int r = 0; r < BENCH_ROUNDS; r++){
+		for (int i = 0; i < count; i++) check += strtod(starts[i], NULL);
+	}
+	EndClock(&clock);
+	printf("strtod: %.1f ns per literal\n", GetClockNanosecond(&clock) / ((double) BENCH_ROUNDS * count));
+	if (sum != check) printf("The sums differ: %.17g and %.17g\n", sum, check);
+
+	// One expression of every literal, run start to finish
+	char* source = malloc((size_t) count * 27 + 64);
+	int length = sprintf(source, "func sum(double a){ return a");
+	for (int i = 0; i < count; i++) length += sprintf(&source[length], " + %s", starts[i]);
+	sprintf(&source[length], "; } sum(0.5);");
+	StartClock(&clock);
+	char* output = ScanToMemory(source, &length);
+	EndClock(&clock);
+	printf("Whole run: %.3f s, %s", GetClockNanosecond(&clock) / 1e9, output);
+
+	free(output);
+	free(source);
+	free(lengths);
+	free(starts);
+	free(literals);
+	return 0;
+}
@@ -1 +1,7 @@
-void Scan(char* rawSourceCode);
\ No newline at end of file
+#include <stdbool.h>
+
+void Scan(char* rawSourceCode);
+void ScanToCallback(char* rawSourceCode, void (*callback)(const char* data, int length, void* user), void* user);
+char* ScanToMemory(char* rawSourceCode, int* length);
+bool ScanToSnapshot(char* rawSourceCode, char* entry, char* path);
+bool ScanFromSnapshot(char* path);
@@ -1,330 +1,246 @@
-#include "ast.h"
-
-int ASTNODE_ID_SPOT = 1;
-
-/**
- * Simple init
- */
-void InitNodes(ASTNode nodes[], int len){
-	for (int i = 0; i < len; i++){
-		nodes[i].id = ASTNODE_ID_SPOT++;
-		nodes[i].type = UNDEFINED;
-		nodes[i].isStmt = false;
-		nodes[i].scopeId = -1;
-	}
-}
-
-/**
- * Free up any unused memory
- */
-void DestroyNodes(ASTNode nodes[], int len){
-	for (int i = 0; i < len; i++){
-		int type = (int) nodes[i].type;
-		switch (type){
-			case VAR: Free(nodes[i].meta.varExpr.name); break;
-			case STRING: Free(nodes[i].meta.stringExpr.value); break;
-		}
-	}
-}
-
-/**
- * Expand the ASTNode object and all the children.
- * This can be called when the ./configure -a
- * is called.
- */
-char* ExpandASTNode(Scope* scope, ASTNode* node, int tab){
-	if (node == NULL) return "";
-	char tabs[(tab * 2) + 1];
-	for (int i = 0; i < tab * 2; i++) tabs[i] = ' ';
-	tabs[(tab * 2)] = '\0';
-
-	char* json = "";
-	char tmp1[80];
-	sprintf(tmp1, "{\"type\": \"%s\", \"id\": %d", TokenToString(node->type), node->id);
-	json = Concat(json, tmp1);
-
-	#ifdef EXPAND_AST
-	printf("%s[%s]: \n %s-id: %d\n", tabs, TokenToString(node->type), tabs, node->id);
-	#endif
-
-	int type = (int) node->type;
-	switch (type){
-		case VAR: {
-			#ifdef EXPAND_AST
-				printf(" %s-name: %s\n %s-inc: %s\n %s-dataType: %s\n %s-value\n", tabs, node->meta.varExpr.name, tabs, TokenToString(node->meta.varExpr.inc), tabs, TokenToString(node->meta.varExpr.dataType), tabs);
-			#endif
-			char* value = ExpandASTNode(scope, node->meta.varExpr.value, tab + 2);
-			char temp2[500];
-			bool nothing = strlen(value) == 0;
-			sprintf(temp2, ",\"name\": \"%s\", \"inc\": \"%s\", \"dataType\": \"%s\", \"value\": %s", node->meta.varExpr.name, TokenToString(node->meta.varExpr.inc), TokenToString(node->meta.varExpr.dataType), nothing ? "\"" : " ");
-			char* result = Concat(temp2, value);
-			if (nothing) result = Concat(result, "\"");
-			json = Concat(json, result);
-			break;	
-		}
-		case RETURN: {
-			#ifdef EXPAND_AST
-				printf(" %s-value\n", tabs);
-			#endif
-			char* results = ExpandASTNode(scope, node->meta.returnStmt.value, tab + 2);
-			json = Concat(json, Concat(", \"value\": ", results));
-			break;
-		}
-		case STRING: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: \"%s\"\n", tabs, node->meta.stringExpr.value);
-			#endif
-			char temp2[strlen(node->meta.stringExpr.value) + 15];
-			sprintf(temp2, ", \"value\": \"%s\"", node->meta.stringExpr.value);
-			json = Concat(json, temp2);
-			break;
-		}
-		case BINARY: {
-			char* json2 = "";
-			json2 = Concat(json2, ", \"operator\": \"");
-			json2 = Concat(json2, TokenToString(node->meta.binaryExpr.op));
-			json2 = Concat(json2, "\", \"left\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-operator: %s\n %s-left:\n", tabs, TokenToString(node->meta.binaryExpr.op), tabs);
-			#endif
-			char* results = ExpandASTNode(scope, node->meta.binaryExpr.left, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"right\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-right:\n", tabs);
-			#endif
-			results = ExpandASTNode(scope, node->meta.binaryExpr.right, tab + 2);
-			json2 = Concat(json2, results);
-			json = Concat(json, json2);
-			break;
-		}
-		case BOOLEAN: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: %d\n", tabs, node->meta.booleanExpr.value);
-			#endif
-			char temp2[15];
-			sprintf(temp2, ", \"value\": \"%d\"", node->meta.booleanExpr.value);
-			json = Concat(json, temp2);
-			break;	
-		}
-		case BYTE: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: %d\n", tabs, node->meta.byteExpr.value);
-			#endif
-			char temp2[30];
-			sprintf(temp2, ", \"value\": \"%d\"", node->meta.byteExpr.value);
-			json = Concat(json, temp2);
-			break;	
-		}
-		case SHORT: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: %d\n", tabs, node->meta.shortExpr.value);
-			#endif
-			char temp2[30];
-			sprintf(temp2, ", \"value\": \"%d\"", node->meta.shortExpr.value);
-			json = Concat(json, temp2);
-			break;	
-		}
-		case INT: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: %d\n", tabs, node->meta.intExpr.value);
-			#endif
-			char temp2[60];
-			sprintf(temp2, ", \"value\": \"%d\"", node->meta.intExpr.value);
-			json = Concat(json, temp2);
-			break;	
-		}
-		case FLOAT: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: %f\n", tabs, node->meta.floatExpr.value);
-			#endif
-			char temp2[60];
-			sprintf(temp2, ", \"value\": \"%f\"", node->meta.floatExpr.value);
-			json = Concat(json, temp2);
-			break;	
-		}
-		case DOUBLE: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: %f\n", tabs, node->meta.doubleExpr.value);
-			#endif
-			char temp2[60];
-			sprintf(temp2, ", \"value\": \"%f\"", node->meta.doubleExpr.value);
-			json = Concat(json, temp2);
-			break;	
-		}
-		case LONG: {
-			#ifdef EXPAND_AST
-				printf(" %s-value: %ld\n", tabs, node->meta.longExpr.value);
-			#endif
-			char temp2[60];
-			sprintf(temp2, ", \"value\": \"%ld\"", node->meta.longExpr.value);
-			json = Concat(json, temp2);
-			break;	
-		}
-		case FOR: {
-			char* json2 = "";
-			json2 = Concat(json2, ", \"var\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-var:\n", tabs);
-			#endif
-			char* results = ExpandASTNode(scope, node->meta.forExpr.var, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"condition\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-condition:\n", tabs);
-			#endif
-			results = ExpandASTNode(scope, node->meta.forExpr.condition, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"incrementor\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-incrementor:\n", tabs);
-			#endif
-			results = ExpandASTNode(scope, node->meta.forExpr.inc, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"body\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-body:\n", tabs);
-			#endif
-			results = ExpandSubScope(scope, node->meta.forExpr.body, tab);
-			json2 = Concat(json2, results);
-			json = Concat(json, json2);
-			break;
-		}
-		case IF: {
-			char* json2 = "";
-			json2 = Concat(json2, ", \"condition\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-condition:\n", tabs);
-			#endif
-			char* results = ExpandASTNode(scope, node->meta.ifExpr.condition, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"body\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-body:\n", tabs);
-			#endif
-			results = ExpandSubScope(scope, node->meta.ifExpr.body, tab);
-			json2 = Concat(json2, results);
-			json = Concat(json, json2);
-			break;
-		}
-		case WHILE: {
-			char* json2 = "";
-			json2 = Concat(json2, ", \"condition\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-condition:\n", tabs);
-			#endif
-			char* results = ExpandASTNode(scope, node->meta.whileExpr.condition, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"body\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-body:\n", tabs);
-			#endif
-			results = ExpandSubScope(scope, node->meta.whileExpr.body, tab);
-			json2 = Concat(json2, results);
-			json = Concat(json, json2);
-			break;
-		}
-		case SWITCH: {
-			char* json2 = "";
-			json2 = Concat(json2, ", \"condition\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-condition:\n", tabs);
-			#endif
-			char* results = ExpandASTNode(scope, node->meta.switchExpr.condition, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"body\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-body:\n", tabs);
-			#endif
-			results = ExpandSubScope(scope, node->meta.switchExpr.body, tab);
-			json2 = Concat(json2, results);
-			json = Concat(json, json2);
-			break;
-		}
-		case CASE: {
-			char* json2 = "";
-			json2 = Concat(json2, ", \"condition\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-condition:\n", tabs);
-			#endif
-			char* results = ExpandASTNode(scope, node->meta.caseStmt.condition, tab + 2);
-			json2 = Concat(json2, results);
-			json2 = Concat(json2, ", \"body\": ");
-			#ifdef EXPAND_AST
-				printf(" %s-body:\n", tabs);
-			#endif
-			results = ExpandSubScope(scope, node->meta.caseStmt.body, tab);
-			json2 = Concat(json2, results);
-			json = Concat(json, json2);
-			break;
-		}
-		case FUNC_CALL: {
-			char* json2 = "";
-			char* funcName = node->meta.funcCallExpr.func->meta.funcExpr.name;
-			json2 = Concat(json2, ", \"name\": \"");
-			json2 = Concat(json2, funcName);
-			json2 = Concat(json2, "\", \"params\": [");
-			#ifdef EXPAND_AST
-				printf(" %s-name: %s\n %s-Params:\n", tabs, funcName, tabs);
-			#endif
-
-			bool first = true;
-			char* results = "";
-			FOREACH_AST(node->meta.funcCallExpr.args){
-				results = ExpandASTNode(scope, item->node, tab + 2);
-				if (first) first = false;
-				else json2 = Concat(json2, ",");
-				json2 = Concat(json2, results);
-			}
-
-			json2 = Concat(json2, "]");
-			json = Concat(json, json2);
-			break;
-		}
-		case FUNC: {
-			char* json2 = "";
-			json2 = Concat(json2, ", \"name\": \"");
-			json2 = Concat(json2, node->meta.funcExpr.name);
-			json2 = Concat(json2, "\", \"params\": [");
-			#ifdef EXPAND_AST
-				printf(" %s-name: %s\n %s-Params:\n", tabs, node->meta.funcExpr.name, tabs);
-			#endif
-
-			bool first = true;
-			char* results = "";
-			FOREACH_AST(node->meta.funcExpr.params){
-				results = ExpandASTNode(scope, item->node, tab + 2);
-				if (first) first = false;
-				else json2 = Concat(json2, ",");
-				json2 = Concat(json2, results);
-			}
-
-			json2 = Concat(json2, "], \"body\": ");
-
-			#ifdef EXPAND_AST
-				printf(" %s-body:\n", tabs);
-			#endif
-			results = ExpandSubScope(scope, node->meta.funcExpr.body, tab);
-			json2 = Concat(json2, results);
-			json = Concat(json, json2);
-			break;
-		}
-	}
-	return Concat(json, "}");
-}
-
-ASTNode* FindSymbol(Scope* scope, char* name){
-	for (int i = 0; i < scope->nodeLength; i++){
-		Token t = scope->nodes[i].type;
-		if (t == OBJECT) {
-			NOT_IMPLEMENTED("Symbol for OBJECT");
-		}
-		else if (t == FUNC && strcmp(name, scope->nodes[i].meta.funcExpr.name) == 0){
-			return &scope->nodes[i];
-		}
-		else if (t == VAR && strcmp(name, scope->nodes[i].meta.varExpr.name) == 0){
-			return &scope->nodes[i];
-		}
-	}
-	return NULL;
+#include "ast.h"
+
+int ASTNODE_ID_SPOT = 1;
+
+/**
+ * Simple init
+ */
+void InitNodes(ASTNode nodes[], int len){
+	for (int i = 0; i < len; i++){
+		nodes[i].id = ASTNODE_ID_SPOT++;
+		nodes[i].type = UNDEFINED;
+		nodes[i].isStmt = false;
+		nodes[i].valueType = UNDEFINED;
+		nodes[i].scopeId = -1;
+		nodes[i].parentScopeId = -1;
+	}
+}
+
+/**
+ * Free up any unused memory
+ */
+void DestroyNodes(ASTNode nodes[], int len){
+	for (int i = 0; i < len; i++){
+		int type = (int) nodes[i].type;
+		switch (type){
+			case VAR: Free(nodes[i].meta.varExpr.name); break;
+			case STRING: Free(nodes[i].meta.stringExpr.value); break;
+		}
+	}
+}
+
+/**
+ * Stream the ASTNode object and all the children as JSON.
+ * With EXPAND_AST the tree is also printed to the console.
+ * A missing child is written as null.
+ */
+void ExpandASTNode(AstWriter* writer, ASTNode* node, int tab){
+	if (node == NULL){
+		WriteJson(writer, "null");
+		return;
+	}
+	char tabs[(tab * 2) + 1];
+	for (int i = 0; i < tab * 2; i++) tabs[i] = ' ';
+	tabs[(tab * 2)] = '\0';
+
+	char number[FORMAT_BUFFER_SIZE];
+	FormatLong(node->id, number);
+	WriteJson(writer, "{\"type\": ");
+	WriteJsonString(writer, TokenToString(node->type));
+	WriteJson(writer, ", \"id\": ");
+	WriteJson(writer, number);
+
+	#ifdef EXPAND_AST
+	printf("%s[%s]: \n %s-id: %d\n", tabs, TokenToString(node->type), tabs, node->id);
+	#endif
+
+	int type = (int) node->type;
+	if (IsAssignment(node->type) || type == INC || type == DEC){
+		#ifdef EXPAND_AST
+			printf(" %s-var: %s\n %s-value\n", tabs, node->meta.assignExpr.var->meta.varExpr.name, tabs);
+		#endif
+		WriteJson(writer, ", \"var\": ");
+		WriteJsonString(writer, node->meta.assignExpr.var->meta.varExpr.name);
+		WriteJson(writer, ", \"value\": ");
+		ExpandASTNode(writer, node->meta.assignExpr.value, tab + 2);
+		WriteJson(writer, "}");
+		return;
+	}
+
+	switch (type){
+		case VAR: {
+			#ifdef EXPAND_AST
+				printf(" %s-name: %s\n %s-dataType: %s\n %s-value\n", tabs, node->meta.varExpr.name, tabs, TokenToString(node->meta.varExpr.dataType), tabs);
+			#endif
+			WriteJson(writer, ", \"name\": ");
+			WriteJsonString(writer, node->meta.varExpr.name);
+			WriteJson(writer, ", \"dataType\": ");
+			WriteJsonString(writer, TokenToString(node->meta.varExpr.dataType));
+			WriteJson(writer, ", \"value\": ");
+			ExpandASTNode(writer, node->meta.varExpr.value, tab + 2);
+			break;
+		}
+		case RETURN: {
+			#ifdef EXPAND_AST
+				printf(" %s-value\n", tabs);
+			#endif
+			WriteJson(writer, ", \"value\": ");
+			ExpandASTNode(writer, node->meta.returnStmt.value, tab + 2);
+			break;
+		}
+		case STRING: {
+			#ifdef EXPAND_AST
+				printf(" %s-value: \"%s\"\n", tabs, node->meta.stringExpr.value);
+			#endif
+			WriteJson(writer, ", \"value\": ");
+			WriteJsonString(writer, node->meta.stringExpr.value);
+			break;
+		}
+		case BINARY: {
+			WriteJson(writer, ", \"operator\": ");
+			WriteJsonString(writer, TokenToString(node->meta.binaryExpr.op));
+			if (node->meta.binaryExpr.operands != NULL){
+				#ifdef EXPAND_AST
+					printf(" %s-operator: %s\n %s-operands:\n", tabs, TokenToString(node->meta.binaryExpr.op), tabs);
+				#endif
+				WriteJson(writer, ", \"operands\": ");
+				ExpandList(writer, node->meta.binaryExpr.operands, tab);
+				break;
+			}
+			#ifdef EXPAND_AST
+				printf(" %s-operator: %s\n %s-left:\n", tabs, TokenToString(node->meta.binaryExpr.op), tabs);
+			#endif
+			WriteJson(writer, ", \"left\": ");
+			ExpandASTNode(writer, node->meta.binaryExpr.left, tab + 2);
+			#ifdef EXPAND_AST
+				printf(" %s-right:\n", tabs);
+			#endif
+			WriteJson(writer, ", \"right\": ");
+			ExpandASTNode(writer, node->meta.binaryExpr.right, tab + 2);
+			break;
+		}
+		case BOOLEAN: FormatLong(node->meta.booleanExpr.value, number); ExpandNumber(writer, number, tabs); break;
+		case BYTE: FormatLong(node->meta.byteExpr.value, number); ExpandNumber(writer, number, tabs); break;
+		case SHORT: FormatLong(node->meta.shortExpr.value, number); ExpandNumber(writer, number, tabs); break;
+		case INT: FormatLong(node->meta.intExpr.value, number); ExpandNumber(writer, number, tabs); break;
+		case FLOAT: FormatFloat(node->meta.floatExpr.value, number); ExpandNumber(writer, number, tabs); break;
+		case DOUBLE: FormatDouble(node->meta.doubleExpr.value, number); ExpandNumber(writer, number, tabs); break;
+		case LONG: FormatLong(node->meta.longExpr.value, number); ExpandNumber(writer, number, tabs); break;
+		case FOR: {
+			#ifdef EXPAND_AST
+				printf(" %s-var:\n", tabs);
+			#endif
+			WriteJson(writer, ", \"var\": ");
+			ExpandASTNode(writer, node->meta.forExpr.var, tab + 2);
+			#ifdef EXPAND_AST
+				printf(" %s-condition:\n", tabs);
+			#endif
+			WriteJson(writer, ", \"condition\": ");
+			ExpandASTNode(writer, node->meta.forExpr.condition, tab + 2);
+			#ifdef EXPAND_AST
+				printf(" %s-incrementor:\n", tabs);
+			#endif
+			WriteJson(writer, ", \"incrementor\": ");
+			ExpandASTNode(writer, node->meta.forExpr.inc, tab + 2);
+			ExpandBody(writer, node->meta.forExpr.body, tabs, tab);
+			break;
+		}
+		case IF: ExpandCondition(writer, node->meta.ifExpr.condition, node->meta.ifExpr.body, tabs, tab); break;
+		case WHILE: ExpandCondition(writer, node->meta.whileExpr.condition, node->meta.whileExpr.body, tabs, tab); break;
+		case SWITCH: ExpandCondition(writer, node->meta.switchExpr.condition, node->meta.switchExpr.body, tabs, tab); break;
+		case CASE: ExpandCondition(writer, node->meta.caseStmt.condition, node->meta.caseStmt.body, tabs, tab); break;
+		case FUNC_CALL: {
+			char* funcName = node->meta.funcCallExpr.func->meta.funcExpr.name;
+			#ifdef EXPAND_AST
+				printf(" %s-name: %s\n %s-Params:\n", tabs, funcName, tabs);
+			#endif
+			WriteJson(writer, ", \"name\": ");
+			WriteJsonString(writer, funcName);
+			WriteJson(writer, ", \"params\": ");
+			ExpandList(writer, node->meta.funcCallExpr.args, tab);
+			break;
+		}
+		case FUNC: {
+			#ifdef EXPAND_AST
+				printf(" %s-name: %s\n %s-Params:\n", tabs, node->meta.funcExpr.name, tabs);
+			#endif
+			WriteJson(writer, ", \"name\": ");
+			WriteJsonString(writer, node->meta.funcExpr.name);
+			WriteJson(writer, ", \"params\": ");
+			ExpandList(writer, node->meta.funcExpr.params, tab);
+			ExpandBody(writer, node->meta.funcExpr.body, tabs, tab);
+			break;
+		}
+	}
+	WriteJson(writer, "}");
+}
+
+/**
+ * A number's "value" field, the number already formatted
+ */
+void ExpandNumber(AstWriter* writer, char* number, char* tabs){
+	#ifdef EXPAND_AST
+		printf(" %s-value: %s\n", tabs, number);
+	#endif
+	WriteJson(writer, ", \"value\": \"");
+	WriteJson(writer, number);
+	WriteJson(writer, "\"");
+}
+
+void ExpandList(AstWriter* writer, ASTList* list, int tab){
+	WriteJson(writer, "[");
+	if (list != NULL){
+		FOREACH_AST(list){
+			if (item != list->first) WriteJson(writer, ",");
+			ExpandASTNode(writer, item->node, tab + 2);
+		}
+	}
+	WriteJson(writer, "]");
+}
+
+void ExpandBody(AstWriter* writer, int body, char* tabs, int tab){
+	#ifdef EXPAND_AST
+		printf(" %s-body:\n", tabs);
+	#endif
+	WriteJson(writer, ", \"body\": ");
+	ExpandSubScope(writer, body, tab);
+}
+
+/**
+ * The fields of if, while, switch and case
+ */
+void ExpandCondition(AstWriter* writer, ASTNode* condition, int body, char* tabs, int tab){
+	#ifdef EXPAND_AST
+		printf(" %s-condition:\n", tabs);
+	#endif
+	WriteJson(writer, ", \"condition\": ");
+	ExpandASTNode(writer, condition, tab + 2);
+	ExpandBody(writer, body, tabs, tab);
+}
+
+/**
+ * The declaration name means where the parser is: the one in
+ * the innermost open scope, the first if that scope has more.
+ * Declarations record their scope in parentScopeId, params
+ * and a for's variable that of the body. NULL for none.
+ */
+ASTNode* FindSymbol(Scope* scope, char* name){
+	ASTNode* found = NULL;
+	int foundDepth = 0;
+	for (int i = 0; i < scope->nodeSpot; i++){
+		ASTNode* node = &scope->nodes[i];
+		Token t = node->type;
+		if (t == OBJECT) {
+			NOT_IMPLEMENTED("Symbol for OBJECT");
+		}
+		else if ((t == FUNC && strcmp(name, node->meta.funcExpr.name) == 0) ||
+			(t == VAR && strcmp(name, node->meta.varExpr.name) == 0)){
+			int depth = GetScopeDepth(scope, node->parentScopeId);
+			if (depth < 0 || (found != NULL && depth >= foundDepth)) continue;
+			found = node;
+			foundDepth = depth;
+			if (depth == 0) break;
+		}
+	}
+	return found;
 }
\ No newline at end of file
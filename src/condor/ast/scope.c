@@ -1,45 +1,147 @@
-#include "scope.h"
-
-void DestroyScope(Scope* scope){
-	
-}
-
-void InitScope(Scope* scope){
-	scope->nodeSpot = 0;
-	scope->scopeLength = 0;
-	scope->nodeLength = 0;
-	scope->scopeSpot = 0;
-	scope->paramsLength = 0;
-	scope->paramsSpot = 0;
-	scope->paramItemsLength = 0;
-	scope->paramItemsSpot = 0;
-}
-
-char* ExpandScope(Scope* scope, int tab){
-	char* json = "[";
-	bool first = true;
-	for (int i = 0; i < scope->nodeLength; i++){
-		if (scope->nodes[i].isStmt && scope->nodes[i].scopeId == scope->scopes[0]){
-			printf("\n");
-			char* results = ExpandASTNode(scope, &scope->nodes[i], tab);
-			if (first) first = false;
-			else json = Concat(json, ",");
-			json = Concat(json, results);
-		}
-	}
-	return Concat(json, "]");
-}
-
-char* ExpandSubScope(Scope* scope, int id, int tab){
-	char* json = "[";
-	bool first = true;
-	for (int i = 0; i < scope->nodeLength; i++){
-		if (scope->nodes[i].isStmt && scope->nodes[i].scopeId == id){
-			char* results = ExpandASTNode(scope, &scope->nodes[i], tab + 2);
-			if (first) first = false;
-			else json = Concat(json, ",");
-			json = Concat(json, results);
-		}
-	}
-	return Concat(json, "]");
-}
\ No newline at end of file
+#include "scope.h"
+
+void DestroyScope(Scope* scope){
+	
+}
+
+void InitScope(Scope* scope){
+	scope->nodeSpot = 0;
+	scope->scopeLength = 0;
+	scope->nodeLength = 0;
+	scope->scopeSpot = 0;
+	scope->paramsLength = 0;
+	scope->paramsSpot = 0;
+	scope->paramItemsLength = 0;
+	scope->paramItemsSpot = 0;
+	scope->entry = NULL;
+	scope->openScope = 0;
+	scope->scopeParents = NULL;
+}
+
+/**
+ * Opening the scope that is already open, as a function does
+ * for its params and then its body, changes nothing
+ */
+void OpenScope(Scope* scope, int id){
+	if (scope->openScope == id) return;
+	scope->scopeParents[id] = scope->openScope;
+	scope->openScope = id;
+}
+
+void CloseScope(Scope* scope, int id){
+	if (scope->openScope == id) scope->openScope = scope->scopeParents[id];
+}
+
+/**
+ * How many scopes out from the open one id is, 0 for the
+ * open one itself, -1 when it is not open
+ */
+int GetScopeDepth(Scope* scope, int id){
+	int depth = 0;
+	for (int open = scope->openScope; open > 0; open = scope->scopeParents[open]){
+		if (open == id) return depth;
+		depth++;
+	}
+	return -1;
+}
+
+/**
+ * Group the statements by scope id, keeping source order, a
+ * counting sort. Scope n's statements end up in
+ * statements[starts[n]] up to statements[starts[n + 1]], for
+ * ids below totalScopes. starts holds totalScopes + 1 entries.
+ */
+void GroupStatements(Scope* scope, ASTNode** statements, int* starts, int totalScopes){
+	for (int i = 0; i <= totalScopes; i++){
+		starts[i] = 0;
+	}
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->isStmt && node->scopeId > 0 && node->scopeId < totalScopes) starts[node->scopeId + 1]++;
+	}
+	for (int i = 1; i <= totalScopes; i++){
+		starts[i] += starts[i - 1];
+	}
+
+	int spot[totalScopes > 0 ? totalScopes : 1];
+	for (int i = 0; i < totalScopes; i++){
+		spot[i] = starts[i];
+	}
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->isStmt && node->scopeId > 0 && node->scopeId < totalScopes) statements[spot[node->scopeId]++] = node;
+	}
+}
+
+/**
+ * Write the global scope's statements as a JSON array
+ */
+void ExpandScope(Scope* scope, FILE* file){
+	AstWriter writer;
+	writer.scope = scope;
+	writer.file = file;
+	writer.totalScopes = 0;
+	for (int i = 0; i < scope->nodeLength; i++){
+		if (scope->nodes[i].isStmt && scope->nodes[i].scopeId >= writer.totalScopes){
+			writer.totalScopes = scope->nodes[i].scopeId + 1;
+		}
+	}
+
+	writer.scopeStarts = Allocate(sizeof(int) * (writer.totalScopes + 1));
+	writer.statements = Allocate(sizeof(ASTNode*) * (scope->nodeLength + 1));
+	GroupStatements(scope, writer.statements, writer.scopeStarts, writer.totalScopes);
+
+	WriteJson(&writer, "[");
+	int id = scope->scopes[0];
+	if (id < writer.totalScopes){
+		for (int i = writer.scopeStarts[id]; i < writer.scopeStarts[id + 1]; i++){
+			#ifdef EXPAND_AST
+				printf("\n");
+			#endif
+			if (i > writer.scopeStarts[id]) WriteJson(&writer, ",");
+			ExpandASTNode(&writer, writer.statements[i], 0);
+		}
+	}
+	WriteJson(&writer, "]");
+
+	Free(writer.statements);
+	Free(writer.scopeStarts);
+}
+
+void ExpandSubScope(AstWriter* writer, int id, int tab){
+	WriteJson(writer, "[");
+	if (id >= 0 && id < writer->totalScopes){
+		for (int i = writer->scopeStarts[id]; i < writer->scopeStarts[id + 1]; i++){
+			if (i > writer->scopeStarts[id]) WriteJson(writer, ",");
+			ExpandASTNode(writer, writer->statements[i], tab + 2);
+		}
+	}
+	WriteJson(writer, "]");
+}
+
+void WriteJson(AstWriter* writer, const char* text){
+	fputs(text, writer->file);
+}
+
+/**
+ * Write text as a quoted JSON string, escaping what JSON
+ * does not allow as is
+ */
+void WriteJsonString(AstWriter* writer, const char* text){
+	FILE* file = writer->file;
+	putc('"', file);
+	for (const unsigned char* c = (const unsigned char*) text; *c != '\0'; c++){
+		switch (*c){
+			case '"': fputs("\\\"", file); break;
+			case '\\': fputs("\\\\", file); break;
+			case '\n': fputs("\\n", file); break;
+			case '\t': fputs("\\t", file); break;
+			case '\r': fputs("\\r", file); break;
+			default: {
+				if (*c < 0x20) fprintf(file, "\\u%04x", *c);
+				else putc(*c, file);
+			}
+		}
+	}
+	putc('"', file);
+}
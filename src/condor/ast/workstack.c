@@ -0,0 +1,35 @@
+#include "workstack.h"
+#include <string.h>
+
+void InitWorkStack(WorkStack* stack){
+	stack->items = stack->inlineItems;
+	stack->length = 0;
+	stack->capacity = WORK_STACK_INLINE;
+}
+
+void DestroyWorkStack(WorkStack* stack){
+	if (stack->items != stack->inlineItems) Free(stack->items);
+	InitWorkStack(stack);
+}
+
+void PushWork(WorkStack* stack, ASTNode* node, int state, int value){
+	if (stack->length == stack->capacity){
+		WorkItem* items = Reallocate(
+			stack->items == stack->inlineItems ? NULL : stack->items,
+			sizeof(WorkItem) * stack->capacity * 2);
+		if (stack->items == stack->inlineItems){
+			memcpy(items, stack->inlineItems, sizeof(WorkItem) * stack->length);
+		}
+		stack->items = items;
+		stack->capacity *= 2;
+	}
+
+	WorkItem* item = &stack->items[stack->length++];
+	item->node = node;
+	item->state = state;
+	item->value = value;
+}
+
+WorkItem PopWork(WorkStack* stack){
+	return stack->items[--stack->length];
+}
@@ -0,0 +1,43 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef WORK_STACK_H_
+#define WORK_STACK_H_
+
+#include <stdbool.h>
+#include "ast.h"
+#include "../mem/allocate.h"
+
+typedef struct ASTNode ASTNode; // forward declare
+
+/**
+ * An explicit stack used to walk expression trees without C
+ * recursion, so the depth of a tree never limits how much C
+ * stack is used. The first WORK_STACK_INLINE items live in the
+ * struct itself; only deeper walks touch the heap.
+ */
+#define WORK_STACK_INLINE 32
+
+typedef struct WorkItem {
+	ASTNode* node;
+	int state; // What the walk still has to do with the node
+	int value; // e.g. a type computed for the node
+} WorkItem;
+
+typedef struct WorkStack {
+	WorkItem* items;
+	int length;
+	int capacity;
+	WorkItem inlineItems[WORK_STACK_INLINE];
+} WorkStack;
+
+void InitWorkStack(WorkStack* stack);
+void DestroyWorkStack(WorkStack* stack);
+void PushWork(WorkStack* stack, ASTNode* node, int state, int value);
+WorkItem PopWork(WorkStack* stack);
+
+#define IS_WORK_STACK_EMPTY(stack) ((stack)->length == 0)
+#define PEEK_WORK(stack) (&(stack)->items[(stack)->length - 1])
+
+#endif // WORK_STACK_H_
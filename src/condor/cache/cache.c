@@ -0,0 +1,469 @@
+#include "cache.h"
+
+void InitCompileCache(CompileCache* cache, char* rawSourceCode){
+	cache->map = NULL;
+	cache->mapSize = 0;
+	cache->key = 0;
+
+	char* directory = getenv(CACHE_DIR_ENV);
+	cache->enabled = directory != NULL && directory[0] != '\0';
+	if (!cache->enabled) return;
+
+	cache->key = HashCacheKey(rawSourceCode);
+	int length = snprintf(cache->path, sizeof(cache->path), "%s/%016llx.cdc", directory, (unsigned long long) cache->key);
+	if (length < 0 || length >= (int) sizeof(cache->path)) cache->enabled = false;
+}
+
+/**
+ * Map the tree saved for this source into scope. False on a
+ * miss, scope is then untouched.
+ */
+bool LoadCompileCache(CompileCache* cache, Scope* scope){
+	if (!cache->enabled) return false;
+
+	size_t size;
+	char* map = MapCacheFile(cache->path, sizeof(CacheHeader), &size);
+	if (map == NULL) return false;
+
+	CacheHeader* header = (CacheHeader*) map;
+	if (!IsHeaderValid(header, CACHE_MAGIC, cache->key, size, sizeof(CacheHeader), 0)){
+		munmap(map, size);
+		return false;
+	}
+
+	CacheRelocation relocation;
+	InitRelocation(&relocation, NULL, map, size, header);
+	RelocateTree(&relocation, header);
+	if (!relocation.valid){
+		munmap(map, size);
+		return false;
+	}
+
+	MapScope(scope, map, header);
+	cache->map = map;
+	cache->mapSize = size;
+	return true;
+}
+
+/**
+ * Best effort, a tree that cannot be saved is left out
+ */
+void SaveCompileCache(CompileCache* cache, Scope* scope){
+	if (!cache->enabled) return;
+
+	CacheHeader header;
+	memset(&header, 0, sizeof(CacheHeader));
+	header.magic = CACHE_MAGIC;
+	header.key = cache->key;
+	char* image = PackTree(&header, scope, sizeof(CacheHeader), 0);
+	if (image == NULL) return;
+
+	CacheRelocation relocation;
+	InitRelocation(&relocation, scope, image, header.strings, &header);
+	RelocateTree(&relocation, &header);
+
+	header.size = header.strings + relocation.strings.length;
+	memcpy(image, &header, sizeof(CacheHeader));
+	((CacheHeader*) image)->checksum = HashCacheFile(image, header.strings, relocation.strings.value, relocation.strings.length);
+	if (relocation.valid){
+		WriteCacheFile(cache->path, image, header.strings, relocation.strings.value, relocation.strings.length);
+	}
+
+	DestroyRelocation(&relocation);
+	Free(image);
+}
+
+void CloseCompileCache(CompileCache* cache){
+	if (cache->map != NULL) munmap(cache->map, cache->mapSize);
+	cache->map = NULL;
+	cache->mapSize = 0;
+}
+
+/**
+ * FNV-1a of the source and of what the tree depends on in the
+ * build: the compiler, the layout of the structures, the
+ * options and the optimizer passes
+ */
+uint64_t HashCacheKey(char* rawSourceCode){
+	char build[512];
+	snprintf(build, sizeof(build), "%d %s %d %d %d %d %d %d %d %d %d %d %d %d %d",
+		CACHE_VERSION, __VERSION__, (int) sizeof(void*),
+		(int) sizeof(ASTNode), (int) offsetof(ASTNode, meta), (int) sizeof(ASTList), (int) sizeof(ASTListItem),
+		(int) sizeof(Value), (int) sizeof(RunnerContext), (int) sizeof(MemoTable),
+		CLONE_LIMIT, INLINE_THRESHOLD, MEMO_TABLE_SIZE, GetOptimizerPasses(), (int) sizeof(Token));
+
+	uint64_t hash = HashBytes(FNV_OFFSET, build, strlen(build));
+	return HashBytes(hash, rawSourceCode, strlen(rawSourceCode));
+}
+
+/**
+ * The checksum of a file: image holds its first size bytes,
+ * strings the rest. Everything after the checksum field is
+ * covered, the header's other fields are checked one by one.
+ * size is 8 byte aligned, so the mapped file hashes the same.
+ */
+uint64_t HashCacheFile(char* image, uint64_t size, char* strings, int length){
+	uint64_t hash = HashBytes(FNV_OFFSET, image + CACHE_CHECKSUM_START, size - CACHE_CHECKSUM_START);
+	return HashBytes(hash, strings, (uint64_t) length);
+}
+
+/**
+ * FNV-1a taken a word at a time, then byte by byte for the
+ * tail. Each step is a bijection of the hash, so a file that
+ * differs in a single word never hashes the same.
+ */
+uint64_t HashBytes(uint64_t hash, char* data, uint64_t size){
+	uint64_t words = size / sizeof(uint64_t);
+	for (uint64_t i = 0; i < words; i++){
+		uint64_t word;
+		memcpy(&word, data + i * sizeof(uint64_t), sizeof(uint64_t));
+		hash = (hash ^ word) * FNV_PRIME;
+	}
+	for (uint64_t i = words * sizeof(uint64_t); i < size; i++){
+		hash = (hash ^ (unsigned char) data[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+/**
+ * The file image of scope's tree: header's lengths and
+ * sections are set and the arrays copied in, pointers and
+ * all, for RelocateTree to pack. The first start bytes are
+ * left for the header, and extra bytes between the tree and
+ * the strings for the caller. NULL when out of memory.
+ */
+char* PackTree(CacheHeader* header, Scope* scope, uint64_t start, uint64_t extra){
+	header->version = CACHE_VERSION;
+	header->nodeLength = scope->nodeLength;
+	header->listLength = scope->paramsLength;
+	header->itemLength = scope->paramItemsLength;
+	header->scopeLength = scope->scopeLength;
+	LayoutCache(header, start, extra);
+
+	char* image = Allocate((int) header->strings);
+	if (image == NULL) return NULL;
+	memset(image, 0, header->strings);
+	memcpy(image + header->nodes, scope->nodes, sizeof(ASTNode) * header->nodeLength);
+	memcpy(image + header->lists, scope->params, sizeof(ASTList) * header->listLength);
+	memcpy(image + header->items, scope->paramItems, sizeof(ASTListItem) * header->itemLength);
+	memcpy(image + header->scopes, scope->scopes, sizeof(int) * (header->scopeLength + 1));
+	return image;
+}
+
+/**
+ * The sections follow the first start bytes in order, each 8
+ * byte aligned. There are scopeLength + 1 scope ids. The
+ * strings come extra bytes after the tree.
+ */
+void LayoutCache(CacheHeader* header, uint64_t start, uint64_t extra){
+	header->nodes = ALIGN_SECTION(start);
+	header->lists = ALIGN_SECTION(header->nodes + sizeof(ASTNode) * (uint64_t) header->nodeLength);
+	header->items = ALIGN_SECTION(header->lists + sizeof(ASTList) * (uint64_t) header->listLength);
+	header->scopes = ALIGN_SECTION(header->items + sizeof(ASTListItem) * (uint64_t) header->itemLength);
+	header->strings = GetCacheTreeEnd(header) + ALIGN_SECTION(extra);
+}
+
+// The end of the tree, where any sections after it start
+uint64_t GetCacheTreeEnd(CacheHeader* header){
+	return ALIGN_SECTION(header->scopes + sizeof(int) * ((uint64_t) header->scopeLength + 1));
+}
+
+bool IsHeaderValid(CacheHeader* header, uint32_t magic, uint64_t key, uint64_t size, uint64_t start, uint64_t extra){
+	if (header->magic != magic || header->version != CACHE_VERSION) return false;
+	if (header->key != key || header->size != size) return false;
+	if (header->nodeLength < 0 || header->listLength < 0 ||
+		header->itemLength < 0 || header->scopeLength < 0) return false;
+
+	CacheHeader layout = *header;
+	LayoutCache(&layout, start, extra);
+	if (layout.nodes != header->nodes || layout.lists != header->lists ||
+		layout.items != header->items || layout.scopes != header->scopes ||
+		layout.strings != header->strings) return false;
+	if (header->strings >= size || ((char*) header)[size - 1] != '\0') return false;
+	return header->checksum == HashCacheFile((char*) header, size, NULL, 0);
+}
+
+/**
+ * The file at path mapped privately, so turning offsets into
+ * pointers, and the runner's writes to the nodes, never reach
+ * the file. NULL when it is missing or shorter than minimum.
+ */
+char* MapCacheFile(char* path, uint64_t minimum, size_t* size){
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < (off_t) minimum){
+		close(fd);
+		return NULL;
+	}
+
+	*size = (size_t) info.st_size;
+	char* map = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	return map == MAP_FAILED ? NULL : map;
+}
+
+/**
+ * Point scope at the relocated tree in map
+ */
+void MapScope(Scope* scope, char* map, CacheHeader* header){
+	InitScope(scope);
+	scope->nodes = (ASTNode*) (map + header->nodes);
+	scope->nodeLength = header->nodeLength;
+	scope->params = (ASTList*) (map + header->lists);
+	scope->paramsLength = header->listLength;
+	scope->paramItems = (ASTListItem*) (map + header->items);
+	scope->paramItemsLength = header->itemLength;
+	scope->scopes = (int*) (map + header->scopes);
+	scope->scopeLength = header->scopeLength;
+}
+
+/**
+ * Packs scope's pointers in the image base when scope is set,
+ * otherwise unpacks the mapped file base
+ */
+void InitRelocation(CacheRelocation* relocation, Scope* scope, char* base, uint64_t size, CacheHeader* header){
+	relocation->scope = scope;
+	relocation->base = base;
+	relocation->size = size;
+	relocation->packing = scope != NULL;
+	relocation->valid = true;
+	relocation->header = header;
+	relocation->interned = NULL;
+	relocation->internedCapacity = 0;
+	if (!relocation->packing) return;
+
+	InitStringBuilder(&relocation->strings, NULL);
+	relocation->internedCapacity = 16;
+	while (relocation->internedCapacity < scope->nodeLength * 2) relocation->internedCapacity *= 2;
+	relocation->interned = Allocate(sizeof(uint32_t) * relocation->internedCapacity);
+	memset(relocation->interned, 0, sizeof(uint32_t) * relocation->internedCapacity);
+
+	// Offset 0 of the strings is "", and the file always ends
+	// with a NUL, so no string can run past it
+	AppendChar(&relocation->strings, '\0');
+}
+
+void DestroyRelocation(CacheRelocation* relocation){
+	if (!relocation->packing) return;
+	Free(relocation->interned);
+	DestroyStringBuilder(&relocation->strings);
+}
+
+void RelocateTree(CacheRelocation* relocation, CacheHeader* header){
+	ASTNode* nodes = (ASTNode*) (relocation->base + header->nodes);
+	for (int i = 0; i < header->nodeLength; i++){
+		RelocateNode(relocation, &nodes[i]);
+	}
+
+	ASTList* lists = (ASTList*) (relocation->base + header->lists);
+	for (int i = 0; i < header->listLength; i++){
+		RelocateItem(relocation, &lists[i].first);
+		RelocateItem(relocation, &lists[i].last);
+		RelocateItem(relocation, &lists[i].current);
+	}
+
+	ASTListItem* items = (ASTListItem*) (relocation->base + header->items);
+	for (int i = 0; i < header->itemLength; i++){
+		RelocateNodePointer(relocation, &items[i].node);
+		RelocateItem(relocation, &items[i].prev);
+		RelocateItem(relocation, &items[i].next);
+	}
+}
+
+/**
+ * The pointers of each type of node, as in CopyChildren
+ */
+void RelocateNode(CacheRelocation* relocation, ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case VAR: {
+			RelocateString(relocation, &GET_VAR_NAME(node));
+			RelocateNodePointer(relocation, &GET_VAR_VALUE(node));
+			break;
+		}
+		case STRING: {
+			RelocateString(relocation, &GET_STRING_VALUE(node));
+			break;
+		}
+		case BINARY: {
+			RelocateNodePointer(relocation, &GET_BIN_LEFT(node));
+			RelocateNodePointer(relocation, &GET_BIN_RIGHT(node));
+			RelocateList(relocation, &GET_BIN_OPERANDS(node));
+			RelocateNodePointer(relocation, &GET_BIN_OWNER(node));
+			break;
+		}
+		case FUNC_CALL: {
+			RelocateNodePointer(relocation, &GET_FUNC_CALL_FUNC(node));
+			RelocateList(relocation, &GET_FUNC_CALL_PARAMS(node));
+			break;
+		}
+		case FUNC: {
+			RelocateString(relocation, &GET_FUNC_NAME(node));
+			RelocateList(relocation, &GET_FUNC_PARAMS(node));
+			break;
+		}
+		case FOR: {
+			RelocateNodePointer(relocation, &GET_FOR_VAR(node));
+			RelocateNodePointer(relocation, &GET_FOR_CONDITION(node));
+			RelocateNodePointer(relocation, &GET_FOR_INC(node));
+			break;
+		}
+		case IF: RelocateNodePointer(relocation, &GET_IF_CONDITION(node)); break;
+		case WHILE: RelocateNodePointer(relocation, &GET_WHILE_CONDITION(node)); break;
+		case SWITCH: RelocateNodePointer(relocation, &GET_SWITCH_CONDITION(node)); break;
+		case CASE: RelocateNodePointer(relocation, &GET_CASE_CONDITION(node)); break;
+		case RETURN: RelocateNodePointer(relocation, &GET_RETURN_VALUE(node)); break;
+		default: {
+			if (!IsAssignment(node->type) && node->type != INC && node->type != DEC) break;
+			RelocateNodePointer(relocation, &GET_ASSIGN_VAR(node));
+			RelocateNodePointer(relocation, &GET_ASSIGN_VALUE(node));
+			break;
+		}
+	}
+}
+
+void RelocateNodePointer(CacheRelocation* relocation, ASTNode** node){
+	CacheHeader* header = relocation->header;
+	if (relocation->packing){
+		uint64_t offset = PackPointer(relocation, *node, relocation->scope->nodes, sizeof(ASTNode), header->nodeLength, header->nodes);
+		*node = (ASTNode*) (uintptr_t) offset;
+	}
+	else {
+		*node = UnpackPointer(relocation, (uint64_t) (uintptr_t) *node, header->nodes, sizeof(ASTNode), header->nodeLength);
+	}
+}
+
+void RelocateList(CacheRelocation* relocation, ASTList** list){
+	CacheHeader* header = relocation->header;
+	if (relocation->packing){
+		uint64_t offset = PackPointer(relocation, *list, relocation->scope->params, sizeof(ASTList), header->listLength, header->lists);
+		*list = (ASTList*) (uintptr_t) offset;
+	}
+	else {
+		*list = UnpackPointer(relocation, (uint64_t) (uintptr_t) *list, header->lists, sizeof(ASTList), header->listLength);
+	}
+}
+
+void RelocateItem(CacheRelocation* relocation, ASTListItem** item){
+	CacheHeader* header = relocation->header;
+	if (relocation->packing){
+		uint64_t offset = PackPointer(relocation, *item, relocation->scope->paramItems, sizeof(ASTListItem), header->itemLength, header->items);
+		*item = (ASTListItem*) (uintptr_t) offset;
+	}
+	else {
+		*item = UnpackPointer(relocation, (uint64_t) (uintptr_t) *item, header->items, sizeof(ASTListItem), header->itemLength);
+	}
+}
+
+void RelocateString(CacheRelocation* relocation, char** value){
+	CacheHeader* header = relocation->header;
+	if (relocation->packing){
+		uint64_t offset = *value == NULL ? 0 : header->strings + InternString(relocation, *value);
+		*value = (char*) (uintptr_t) offset;
+		return;
+	}
+
+	uint64_t offset = (uint64_t) (uintptr_t) *value;
+	if (offset == 0){
+		*value = NULL;
+	}
+	else if (offset < header->strings || offset >= relocation->size){
+		relocation->valid = false;
+		*value = NULL;
+	}
+	else {
+		*value = relocation->base + offset;
+	}
+}
+
+/**
+ * The offset in the file of an element of a pool of length
+ * elements of size bytes, which starts at start in memory and
+ * at section in the file
+ */
+uint64_t PackPointer(CacheRelocation* relocation, void* pointer, void* start, int size, int length, uint64_t section){
+	if (pointer == NULL) return 0;
+	uintptr_t distance = (uintptr_t) pointer - (uintptr_t) start;
+	if ((uintptr_t) pointer < (uintptr_t) start ||
+		distance >= (uintptr_t) size * (uintptr_t) length ||
+		distance % size != 0){
+		relocation->valid = false;
+		return 0;
+	}
+	return section + distance;
+}
+
+void* UnpackPointer(CacheRelocation* relocation, uint64_t offset, uint64_t section, int size, int length){
+	if (offset == 0) return NULL;
+	uint64_t distance = offset - section;
+	if (offset < section || distance >= (uint64_t) size * (uint64_t) length || distance % size != 0){
+		relocation->valid = false;
+		return NULL;
+	}
+	return relocation->base + offset;
+}
+
+/**
+ * The offset of value in the strings, added the first time it
+ * is seen
+ */
+uint64_t InternString(CacheRelocation* relocation, char* value){
+	uint32_t hash = 2166136261U;
+	int length = 0;
+	for (unsigned char* c = (unsigned char*) value; *c != '\0'; c++, length++){
+		hash = (hash ^ *c) * 16777619U;
+	}
+
+	int mask = relocation->internedCapacity - 1;
+	for (int slot = (int) (hash & mask); ; slot = (slot + 1) & mask){
+		uint32_t entry = relocation->interned[slot];
+		if (entry == 0){
+			uint32_t offset = (uint32_t) relocation->strings.length;
+			AppendStringLength(&relocation->strings, value, length + 1);
+			relocation->interned[slot] = offset + 1;
+			return offset;
+		}
+		if (strcmp(relocation->strings.value + entry - 1, value) == 0) return entry - 1;
+	}
+}
+
+/**
+ * Written to a file of its own, then renamed over the cache
+ * file, so a run reading it never sees half a file
+ */
+bool WriteCacheFile(char* path, char* image, uint64_t size, char* strings, int length){
+	char directory[PATH_MAX];
+	strcpy(directory, path);
+	char* slash = strrchr(directory, '/');
+	if (slash != NULL && slash != directory){
+		*slash = '\0';
+		mkdir(directory, 0755);
+	}
+
+	char temporary[PATH_MAX + 32];
+	snprintf(temporary, sizeof(temporary), "%s.%d.tmp", path, (int) getpid());
+	int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+
+	bool written = WriteAll(fd, image, size) && WriteAll(fd, strings, (uint64_t) length);
+	if (close(fd) != 0) written = false;
+	if (!written || rename(temporary, path) != 0){
+		unlink(temporary);
+		return false;
+	}
+	return true;
+}
+
+bool WriteAll(int fd, char* data, uint64_t size){
+	while (size > 0){
+		ssize_t written = write(fd, data, size);
+		if (written < 0){
+			if (errno == EINTR) continue;
+			return false;
+		}
+		data += written;
+		size -= (uint64_t) written;
+	}
+	return true;
+}
@@ -0,0 +1,135 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * The compile cache. Once checked and optimized, the tree is
+ * saved in the directory named by CONDOR_CACHE_DIR, in a file
+ * named by a hash of the source, of the compiler's build and
+ * of the passes that ran. The build is the C compiler, the
+ * layout of the saved structures, the build options and
+ * CACHE_VERSION. A later run of the same source maps the file
+ * instead of lexing, parsing and checking, and runs it.
+ *
+ * The file is the node, list, item and scope arrays as they
+ * are in memory, followed by the strings, each only once.
+ * Pointers are stored as offsets from the start of the file,
+ * 0 for NULL. Loading maps the file privately and turns the
+ * offsets back into pointers in place, so nothing is copied
+ * and the file does not depend on where it is mapped.
+ *
+ * With no CONDOR_CACHE_DIR there is no cache. A file that is
+ * missing, from another build or damaged is a miss. Damage is
+ * caught by a checksum over the whole file, see HashCacheFile.
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "condor/ast/scope.h"
+#include "condor/ast/ast.h"
+#include "condor/ast/astlist.h"
+#include "condor/mem/allocate.h"
+#include "condor/optimizer/optimizer.h"
+#include "condor/optimizer/optimizer-inline.h"
+#include "condor/semantic/monomorphize.h"
+#include "condor/runner/runner-types.h"
+#include "utils/string/string.h"
+
+// Raised whenever the tree, how it is built or the file
+// layout changes
+#define CACHE_VERSION 3
+#define CACHE_MAGIC 0x43444E43 // "CNDC"
+#define CACHE_DIR_ENV "CONDOR_CACHE_DIR"
+
+// Where the bytes covered by the checksum start
+#define CACHE_CHECKSUM_START (offsetof(CacheHeader, checksum) + sizeof(uint64_t))
+#define FNV_OFFSET 14695981039346656037UL
+#define FNV_PRIME 1099511628211UL
+
+#define ALIGN_SECTION(offset) (((offset) + 7) & ~((uint64_t) 7))
+
+typedef struct CacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;
+	uint64_t size; // Of the whole file
+	uint64_t checksum; // Of the bytes after it, see HashCacheFile
+	int nodeLength;
+	int listLength;
+	int itemLength;
+	int scopeLength;
+	uint64_t nodes; // Offsets of the sections
+	uint64_t lists;
+	uint64_t items;
+	uint64_t scopes;
+	uint64_t strings;
+} CacheHeader;
+
+typedef struct CompileCache {
+	bool enabled;
+	uint64_t key;
+	char path[PATH_MAX];
+	char* map; // The mapped file on a hit
+	size_t mapSize;
+} CompileCache;
+
+/**
+ * Turns the pointers of a tree into offsets, or back
+ */
+typedef struct CacheRelocation {
+	Scope* scope; // The tree being saved
+	char* base; // The file image
+	uint64_t size;
+	bool packing;
+	bool valid; // Cleared by a pointer that cannot be relocated
+	CacheHeader* header; // Where the sections are
+	StringBuilder strings; // Packing only
+	uint32_t* interned; // Open addressing, offsets into strings plus 1
+	int internedCapacity;
+} CacheRelocation;
+
+void InitCompileCache(CompileCache* cache, char* rawSourceCode);
+bool LoadCompileCache(CompileCache* cache, Scope* scope);
+void SaveCompileCache(CompileCache* cache, Scope* scope);
+void CloseCompileCache(CompileCache* cache);
+
+/**
+ * Private Functions
+ */
+uint64_t HashCacheKey(char* rawSourceCode);
+uint64_t HashCacheFile(char* image, uint64_t size, char* strings, int length);
+uint64_t HashBytes(uint64_t hash, char* data, uint64_t size);
+char* PackTree(CacheHeader* header, Scope* scope, uint64_t start, uint64_t extra);
+void LayoutCache(CacheHeader* header, uint64_t start, uint64_t extra);
+uint64_t GetCacheTreeEnd(CacheHeader* header);
+bool IsHeaderValid(CacheHeader* header, uint32_t magic, uint64_t key, uint64_t size, uint64_t start, uint64_t extra);
+char* MapCacheFile(char* path, uint64_t minimum, size_t* size);
+void MapScope(Scope* scope, char* map, CacheHeader* header);
+void InitRelocation(CacheRelocation* relocation, Scope* scope, char* base, uint64_t size, CacheHeader* header);
+void DestroyRelocation(CacheRelocation* relocation);
+void RelocateTree(CacheRelocation* relocation, CacheHeader* header);
+void RelocateNode(CacheRelocation* relocation, ASTNode* node);
+void RelocateNodePointer(CacheRelocation* relocation, ASTNode** node);
+void RelocateList(CacheRelocation* relocation, ASTList** list);
+void RelocateItem(CacheRelocation* relocation, ASTListItem** item);
+void RelocateString(CacheRelocation* relocation, char** value);
+uint64_t PackPointer(CacheRelocation* relocation, void* pointer, void* start, int size, int length, uint64_t section);
+void* UnpackPointer(CacheRelocation* relocation, uint64_t offset, uint64_t section, int size, int length);
+uint64_t InternString(CacheRelocation* relocation, char* value);
+bool WriteCacheFile(char* path, char* image, uint64_t size, char* strings, int length);
+bool WriteAll(int fd, char* data, uint64_t size);
+
+#endif // CACHE_H_
@@ -0,0 +1,336 @@
+#include "snapshot.h"
+
+/**
+ * Run scopeId's statements, saving the snapshot before the
+ * first one calling point's entry. Without one the run is as
+ * usual and nothing is saved.
+ */
+void RunToSnapshot(Runner* runner, int scopeId, SnapshotPoint* point){
+	int start = runner->scopeStarts[scopeId];
+	int end = runner->scopeStarts[scopeId + 1];
+	int entry = FindEntryCall(runner, scopeId, point->entry);
+	point->saved = false;
+	if (entry < 0){
+		RunStatements(runner, scopeId, start, end);
+		return;
+	}
+
+	RunStatements(runner, scopeId, start, entry);
+	if (runner->control != UNDEFINED) return;
+	point->saved = SaveSnapshot(runner, entry, point->path);
+	RunStatements(runner, scopeId, entry, end);
+}
+
+/**
+ * Save the tree and runner, to resume at statements[resumeAt].
+ * Written like a compile cache file, never half a file.
+ */
+bool SaveSnapshot(Runner* runner, int resumeAt, char* path){
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(SnapshotHeader));
+	header.tree.magic = SNAPSHOT_MAGIC;
+	header.tree.key = HashSnapshotKey();
+	header.totalContexts = runner->totalContexts;
+	header.totalScopes = runner->totalScopes;
+	header.totalMemos = runner->totalMemos;
+	header.firstFreeContext = runner->firstFreeContext;
+	header.resumeAt = resumeAt;
+	header.tree.nodeLength = runner->scope->nodeLength;
+	for (int i = 0; i < runner->totalMemos; i++){
+		header.memoSize += GetMemoSize(&runner->memos[i]);
+	}
+
+	uint64_t extra = LayoutSnapshot(&header, 0);
+	char* image = PackTree(&header.tree, runner->scope, sizeof(SnapshotHeader), extra);
+	if (image == NULL) return false;
+	LayoutSnapshot(&header, GetCacheTreeEnd(&header.tree));
+	PackRunner(runner, &header, image);
+
+	CacheRelocation relocation;
+	InitRelocation(&relocation, runner->scope, image, header.tree.strings, &header.tree);
+	RelocateTree(&relocation, &header.tree);
+	RelocateRunner(&relocation, &header, runner->contexts);
+
+	header.tree.size = header.tree.strings + relocation.strings.length;
+	memcpy(image, &header, sizeof(SnapshotHeader));
+	((CacheHeader*) image)->checksum = HashCacheFile(image, header.tree.strings, relocation.strings.value, relocation.strings.length);
+	bool saved = relocation.valid &&
+		WriteCacheFile(path, image, header.tree.strings, relocation.strings.value, relocation.strings.length);
+
+	DestroyRelocation(&relocation);
+	Free(image);
+	return saved;
+}
+
+/**
+ * Map the snapshot at path and run the rest of the top-level
+ * statements from its entry call. False, with nothing run,
+ * when the file is missing, damaged or from another build.
+ */
+bool ResumeSnapshot(char* path, RunnerOutput* output){
+	size_t size;
+	char* map = MapCacheFile(path, sizeof(SnapshotHeader), &size);
+	if (map == NULL) return false;
+
+	SnapshotHeader* header = (SnapshotHeader*) map;
+	if (!IsSnapshotValid(header, size)){
+		munmap(map, size);
+		return false;
+	}
+
+	CacheRelocation relocation;
+	InitRelocation(&relocation, NULL, map, size, &header->tree);
+	RelocateTree(&relocation, &header->tree);
+	RelocateRunner(&relocation, header, NULL);
+
+	Scope scope;
+	MapScope(&scope, map, &header->tree);
+	int* scopeStarts = (int*) (map + header->scopeStarts);
+	int root = scope.scopes[0];
+	if (!relocation.valid || root < 0 || root >= header->totalScopes ||
+		header->resumeAt < scopeStarts[root] || header->resumeAt > scopeStarts[root + 1]){
+		munmap(map, size);
+		return false;
+	}
+
+	Runner runner;
+	RestoreRunner(&runner, &scope, map, header, output);
+	RunStatements(&runner, root, header->resumeAt, runner.scopeStarts[root + 1]);
+	FlushOutput(output);
+
+	Free(runner.frames);
+	DestroyActivations(&runner);
+	munmap(map, size);
+	return true;
+}
+
+/**
+ * The index in statements of scopeId's first statement that
+ * calls the function named entry, -1 when there is none
+ */
+int FindEntryCall(Runner* runner, int scopeId, char* entry){
+	for (int i = runner->scopeStarts[scopeId]; i < runner->scopeStarts[scopeId + 1]; i++){
+		ASTNode* node = runner->statements[i];
+		if (node->type != FUNC_CALL || GET_FUNC_CALL_FUNC(node) == NULL) continue;
+		char* name = GET_FUNC_CALL_NAME(node);
+		if (name != NULL && strcmp(name, entry) == 0) return i;
+	}
+	return -1;
+}
+
+/**
+ * A snapshot depends on the runner's structures as well as
+ * on the tree's
+ */
+uint64_t HashSnapshotKey(void){
+	char build[64];
+	snprintf(build, sizeof(build), "snapshot %d %d %d %d",
+		(int) sizeof(Value), (int) sizeof(RunnerContext), (int) sizeof(MemoTable), (int) sizeof(bool));
+	return HashCacheKey(build);
+}
+
+uint64_t GetMemoSize(MemoTable* memo){
+	return ALIGN_SECTION(sizeof(Value) * MEMO_TABLE_SIZE * (uint64_t) memo->arity) +
+		ALIGN_SECTION(sizeof(Value) * MEMO_TABLE_SIZE) +
+		ALIGN_SECTION(sizeof(bool) * MEMO_TABLE_SIZE);
+}
+
+/**
+ * The runner's sections in order from start, each 8 byte
+ * aligned. Returns their size.
+ */
+uint64_t LayoutSnapshot(SnapshotHeader* header, uint64_t start){
+	uint64_t nodeLength = (uint64_t) header->tree.nodeLength;
+	header->contexts = ALIGN_SECTION(start);
+	header->contextUsed = ALIGN_SECTION(header->contexts + sizeof(RunnerContext) * (uint64_t) header->totalContexts);
+	header->nodeContexts = ALIGN_SECTION(header->contextUsed + sizeof(bool) * (uint64_t) header->totalContexts);
+	header->statements = ALIGN_SECTION(header->nodeContexts + sizeof(RunnerContext*) * nodeLength);
+	header->scopeStarts = ALIGN_SECTION(header->statements + sizeof(ASTNode*) * nodeLength);
+	header->memos = ALIGN_SECTION(header->scopeStarts + sizeof(int) * ((uint64_t) header->totalScopes + 2));
+	header->memoData = ALIGN_SECTION(header->memos + sizeof(MemoTable) * (uint64_t) header->totalMemos);
+	return ALIGN_SECTION(header->memoData + header->memoSize) - start;
+}
+
+bool IsSnapshotValid(SnapshotHeader* header, uint64_t size){
+	if (header->tree.nodeLength < 0 || header->tree.scopeLength < 0 ||
+		header->totalContexts < 0 || header->totalMemos < 0 ||
+		header->totalScopes != header->tree.scopeLength + 1 ||
+		header->firstFreeContext < 0 || header->firstFreeContext > header->totalContexts ||
+		header->memoSize > size) return false;
+
+	SnapshotHeader layout = *header;
+	uint64_t extra = LayoutSnapshot(&layout, 0);
+	if (!IsHeaderValid(&header->tree, SNAPSHOT_MAGIC, HashSnapshotKey(), size, sizeof(SnapshotHeader), extra)) return false;
+
+	LayoutSnapshot(&layout, GetCacheTreeEnd(&header->tree));
+	return layout.contexts == header->contexts && layout.contextUsed == header->contextUsed &&
+		layout.nodeContexts == header->nodeContexts && layout.statements == header->statements &&
+		layout.scopeStarts == header->scopeStarts && layout.memos == header->memos &&
+		layout.memoData == header->memoData;
+}
+
+/**
+ * Copy the runner's arrays into image, for RelocateRunner to
+ * pack. Each memo table's keys, results and used flags follow
+ * one another, and its pointers become their offsets.
+ */
+void PackRunner(Runner* runner, SnapshotHeader* header, char* image){
+	int totalStatements = runner->scopeStarts[runner->totalScopes + 1];
+	memcpy(image + header->contexts, runner->contexts, sizeof(RunnerContext) * runner->totalContexts);
+	memcpy(image + header->contextUsed, runner->contextUsed, sizeof(bool) * runner->totalContexts);
+	memcpy(image + header->nodeContexts, runner->nodeContexts, sizeof(RunnerContext*) * header->tree.nodeLength);
+	memcpy(image + header->statements, runner->statements, sizeof(ASTNode*) * totalStatements);
+	memcpy(image + header->scopeStarts, runner->scopeStarts, sizeof(int) * (runner->totalScopes + 2));
+
+	MemoTable* memos = (MemoTable*) (image + header->memos);
+	uint64_t offset = header->memoData;
+	for (int i = 0; i < runner->totalMemos; i++){
+		MemoTable* memo = &runner->memos[i];
+		MemoTable* copy = &memos[i];
+		*copy = *memo;
+		uint64_t keySize = sizeof(Value) * MEMO_TABLE_SIZE * (uint64_t) memo->arity;
+		uint64_t keys = offset;
+		uint64_t results = keys + ALIGN_SECTION(keySize);
+		uint64_t used = results + ALIGN_SECTION(sizeof(Value) * MEMO_TABLE_SIZE);
+		memcpy(image + keys, memo->keys, keySize);
+		memcpy(image + results, memo->results, sizeof(Value) * MEMO_TABLE_SIZE);
+		memcpy(image + used, memo->used, sizeof(bool) * MEMO_TABLE_SIZE);
+		copy->keys = (Value*) (uintptr_t) keys;
+		copy->results = (Value*) (uintptr_t) results;
+		copy->used = (bool*) (uintptr_t) used;
+		offset += GetMemoSize(memo);
+
+		// Looked up by address, a string key would not be found
+		bool* usedCopy = (bool*) (image + used);
+		Value* keysCopy = (Value*) (image + keys);
+		for (int slot = 0; slot < MEMO_TABLE_SIZE; slot++){
+			for (int k = 0; k < memo->arity && usedCopy[slot]; k++){
+				if (VALUE_IS_STRING(keysCopy[slot * memo->arity + k])) usedCopy[slot] = false;
+			}
+		}
+	}
+}
+
+/**
+ * The runner's pointers, as RelocateTree does the tree's. The
+ * contexts are the runner's own when packing, for the node
+ * contexts pointing into them.
+ */
+void RelocateRunner(CacheRelocation* relocation, SnapshotHeader* header, RunnerContext* contexts){
+	char* base = relocation->base;
+	int nodeLength = header->tree.nodeLength;
+	int* scopeStarts = (int*) (base + header->scopeStarts);
+	for (int i = 0; i <= header->totalScopes + 1; i++){
+		int previous = i == 0 ? 0 : scopeStarts[i - 1];
+		if (scopeStarts[i] < previous || scopeStarts[i] > nodeLength){
+			relocation->valid = false;
+			return;
+		}
+	}
+
+	RunnerContext* runnerContexts = (RunnerContext*) (base + header->contexts);
+	for (int i = 0; i < header->totalContexts; i++){
+		RelocateNodePointer(relocation, &runnerContexts[i].node);
+		RelocateValue(relocation, &runnerContexts[i].value);
+	}
+
+	RunnerContext** nodeContexts = (RunnerContext**) (base + header->nodeContexts);
+	for (int i = 0; i < nodeLength; i++){
+		if (relocation->packing){
+			uint64_t offset = PackPointer(relocation, nodeContexts[i], contexts, sizeof(RunnerContext), header->totalContexts, header->contexts);
+			nodeContexts[i] = (RunnerContext*) (uintptr_t) offset;
+		}
+		else {
+			nodeContexts[i] = UnpackPointer(relocation, (uint64_t) (uintptr_t) nodeContexts[i], header->contexts, sizeof(RunnerContext), header->totalContexts);
+		}
+	}
+
+	ASTNode** statements = (ASTNode**) (base + header->statements);
+	int totalStatements = scopeStarts[header->totalScopes + 1];
+	for (int i = 0; i < totalStatements; i++){
+		RelocateNodePointer(relocation, &statements[i]);
+		if (statements[i] == NULL) relocation->valid = false;
+	}
+
+	MemoTable* memos = (MemoTable*) (base + header->memos);
+	for (int i = 0; i < header->totalMemos; i++){
+		RelocateMemo(relocation, header, &memos[i]);
+	}
+}
+
+/**
+ * The memo's arrays are at offsets within the memo data
+ */
+void RelocateMemo(CacheRelocation* relocation, SnapshotHeader* header, MemoTable* memo){
+	RelocateNodePointer(relocation, &memo->func);
+
+	uint64_t keys = (uint64_t) (uintptr_t) memo->keys;
+	uint64_t results = (uint64_t) (uintptr_t) memo->results;
+	uint64_t used = (uint64_t) (uintptr_t) memo->used;
+	uint64_t end = header->memoData + header->memoSize;
+	if (!relocation->packing){
+		uint64_t keySize = sizeof(Value) * MEMO_TABLE_SIZE * (uint64_t) memo->arity;
+		uint64_t resultSize = sizeof(Value) * MEMO_TABLE_SIZE;
+		if (memo->arity < 0 || memo->arity > header->tree.nodeLength ||
+			keys < header->memoData || keys > end || keySize > end - keys || keys % 8 != 0 ||
+			results < header->memoData || results > end || resultSize > end - results || results % 8 != 0 ||
+			used < header->memoData || used > end || sizeof(bool) * MEMO_TABLE_SIZE > end - used){
+			relocation->valid = false;
+			memo->arity = 0;
+			return;
+		}
+		memo->keys = (Value*) (relocation->base + keys);
+		memo->results = (Value*) (relocation->base + results);
+		memo->used = (bool*) (relocation->base + used);
+	}
+
+	Value* keyValues = (Value*) (relocation->base + keys);
+	Value* resultValues = (Value*) (relocation->base + results);
+	bool* usedSlots = (bool*) (relocation->base + used);
+	for (int slot = 0; slot < MEMO_TABLE_SIZE; slot++){
+		if (!usedSlots[slot]) continue;
+		RelocateValue(relocation, &resultValues[slot]);
+		for (int k = 0; k < memo->arity; k++){
+			RelocateValue(relocation, &keyValues[slot * memo->arity + k]);
+		}
+	}
+}
+
+/**
+ * Strings are the only values holding a pointer
+ */
+void RelocateValue(CacheRelocation* relocation, Value* value){
+	if (!VALUE_IS_STRING(*value)) return;
+	char* string = VALUE_STRING(*value);
+	RelocateString(relocation, &string);
+	*value = StringValue(string);
+}
+
+/**
+ * The runner as it was saved, its arrays in the mapped file
+ */
+void RestoreRunner(Runner* runner, Scope* scope, char* map, SnapshotHeader* header, RunnerOutput* output){
+	runner->scope = scope;
+	runner->output = output;
+	runner->currentNode = NULL;
+	runner->control = UNDEFINED;
+	runner->returnSlot = NULL;
+	runner->statement = NULL;
+	runner->frameSpot = 0;
+	runner->totalFrames = RUNNER_FRAMES;
+	runner->frames = Allocate(sizeof(RunnerFrame) * RUNNER_FRAMES);
+	runner->stackBase = __builtin_frame_address(0);
+	runner->firstNodeId = scope->nodeLength > 0 ? scope->nodes[0].id : 0;
+
+	runner->contexts = (RunnerContext*) (map + header->contexts);
+	runner->contextUsed = (bool*) (map + header->contextUsed);
+	runner->totalContexts = header->totalContexts;
+	runner->firstFreeContext = header->firstFreeContext;
+	runner->nodeContexts = (RunnerContext**) (map + header->nodeContexts);
+	runner->statements = (ASTNode**) (map + header->statements);
+	runner->scopeStarts = (int*) (map + header->scopeStarts);
+	runner->totalScopes = header->totalScopes;
+	runner->memos = (MemoTable*) (map + header->memos);
+	runner->totalMemos = header->totalMemos;
+	InitActivations(runner);
+}
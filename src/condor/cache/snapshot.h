@@ -0,0 +1,75 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Runner snapshots. A run asked for one stops just before the
+ * first top-level statement calling the entry function, saves
+ * the tree and the runner's state to a file, and goes on. A
+ * later process maps the file and resumes at that statement,
+ * so the setup before it is neither compiled nor run again.
+ *
+ * The file is a compile cache file, see cache.h, with the
+ * runner's contexts, statement index and memo tables between
+ * the tree and the strings. Values holding strings point into
+ * the strings like the nodes do. Memo slots keyed by a string
+ * are dropped, their slot came from the string's address.
+ *
+ * A file from another build, or damaged, is not resumed. The
+ * checksum in the tree's header covers the runner's sections
+ * as well, see HashCacheFile.
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "cache.h"
+#include "condor/runner/runner.h"
+
+#define SNAPSHOT_MAGIC 0x53444E43 // "CNDS"
+
+typedef struct SnapshotHeader {
+	CacheHeader tree;
+	int totalContexts;
+	int totalScopes;
+	int totalMemos;
+	int firstFreeContext;
+	int resumeAt; // Index in statements of the entry call
+	uint64_t memoSize; // Of the keys, results and used flags
+	uint64_t contexts; // Offsets of the sections
+	uint64_t contextUsed;
+	uint64_t nodeContexts;
+	uint64_t statements;
+	uint64_t scopeStarts;
+	uint64_t memos;
+	uint64_t memoData;
+} SnapshotHeader;
+
+/**
+ * Where a run saves its snapshot
+ */
+typedef struct SnapshotPoint {
+	char* entry; // Name of the function
+	char* path;
+	bool saved;
+} SnapshotPoint;
+
+void RunToSnapshot(Runner* runner, int scopeId, SnapshotPoint* point);
+bool SaveSnapshot(Runner* runner, int resumeAt, char* path);
+bool ResumeSnapshot(char* path, RunnerOutput* output);
+
+/**
+ * Private Functions
+ */
+int FindEntryCall(Runner* runner, int scopeId, char* entry);
+uint64_t HashSnapshotKey(void);
+uint64_t GetMemoSize(MemoTable* memo);
+uint64_t LayoutSnapshot(SnapshotHeader* header, uint64_t start);
+bool IsSnapshotValid(SnapshotHeader* header, uint64_t size);
+void PackRunner(Runner* runner, SnapshotHeader* header, char* image);
+void RelocateRunner(CacheRelocation* relocation, SnapshotHeader* header, RunnerContext* contexts);
+void RelocateMemo(CacheRelocation* relocation, SnapshotHeader* header, MemoTable* memo);
+void RelocateValue(CacheRelocation* relocation, Value* value);
+void RestoreRunner(Runner* runner, Scope* scope, char* map, SnapshotHeader* header, RunnerOutput* output);
+
+#endif // SNAPSHOT_H_
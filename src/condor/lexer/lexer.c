@@ -1,474 +1,682 @@
-#include "lexer.h"
-
-void InitLexer(Lexer* lexer, char* rawSourceCode){
-	// Init lexer
-	lexer->rawSourceCode = rawSourceCode;
-	lexer->length = strlen(rawSourceCode);
-	lexer->currentTokenString = NULL;
-
-	// Init lexer tracker
-	lexer->tracker.currentTokenPosition = 0;
-	lexer->tracker.tokenStart = 0;
-	lexer->tracker.tokenEnd = 0;
-	lexer->tracker.row = 1;
-	lexer->tracker.col = 1;
-	lexer->previousTrackerSpot = -1;
-	lexer->totalTrackers = 5;
-
-	for (int i = 0; i < lexer->totalTrackers; i++) {
-		lexer->previousTrackers[i].col = 0;
-		lexer->previousTrackers[i].row = 0;
-		lexer->previousTrackers[i].tokenEnd = 0;
-		lexer->previousTrackers[i].tokenStart = 0;
-		lexer->previousTrackers[i].currentTokenPosition = 0;
-	}
-}
-
-void DestroyLexer(Lexer* lexer){
-	if (lexer->currentTokenString != NULL) Free(lexer->currentTokenString);
-}
-
-void SetPreviousTracker(Lexer* lexer){
-
-	lexer->previousTrackerSpot++;
-	if (lexer->previousTrackerSpot >= lexer->totalTrackers){
-		lexer->previousTrackerSpot = 0;
-	}
-
-	LexerTracker* previous = &lexer->previousTrackers[lexer->previousTrackerSpot];
-
-	previous->col = lexer->tracker.col;
-	previous->currentTokenPosition = lexer->tracker.currentTokenPosition;
-	previous->row = lexer->tracker.row;
-	previous->tokenEnd = lexer->tracker.tokenEnd;
-	previous->tokenStart = lexer->tracker.tokenStart;
-}
-
-Token GetNextToken(Lexer* lexer){
-	SetPreviousTracker(lexer);
-
-	// Reset token locations
-	lexer->tracker.tokenStart = 0;
-	lexer->tracker.tokenEnd = 0;
-
-	SetNextTokenRange(lexer);
-	if (lexer->tracker.tokenEnd - lexer->tracker.tokenStart == 0) return UNDEFINED;
-	char* token = GetTokenString(lexer);
-
-
-	if (lexer->currentTokenString != NULL) {
-		Free(lexer->currentTokenString);
-	}
-	lexer->currentTokenString = token;
-	Token tok = StringToToken(token);
-	
-	bool containsChars = strlen(token) > 0;
-	if (tok == UNDEFINED && containsChars && (token[0] == '.' || isdigit(token[0]))) {
-		return NUMBER;
-	}
-	else if (tok == UNDEFINED && containsChars && (token[0] == '\'' || token[0] == '"')){
-		return STRING;
-	}
-	else if (tok == UNDEFINED && containsChars){
-		return IDENTIFIER;
-	}
-	return tok;
-}
-
-void PeekNextToken(Lexer* lexer, PeekedToken* peeked){
-	peeked->token = GetNextToken(lexer);
-	peeked->raw = lexer->currentTokenString;
-	BackOneToken(lexer);
-}
-
-Token GetCurrentToken(Lexer* lexer){
-	BackOneToken(lexer);
-	return GetNextToken(lexer);
-}
-	
-/**
- * This function is key in allocation the correct number of 
- * ASTNodes.
- *
- * Logic:
- * 	If VAR appears, allocate 1 ASTVar slot
- * 	If ASSIGN appears, allocate 1 ASTBinaryExpr slot var a = 10;
- */
-int CountTotalASTTokens(Lexer* lexer){
-	int total = 0;
-	PeekedToken peeked;
-	Token tok = GetNextToken(lexer);
-	while (tok != UNDEFINED){
-
-		if (tok == IDENTIFIER){
-			PeekNextToken(lexer, &peeked);
-			if (peeked.token == LPAREN) total++;
-		}
-		else if (tok == VAR ||
-			tok == FOR ||
-			tok == WHILE ||
-			tok == ASSIGN ||
-			tok == NUMBER ||
-			tok == STRING || 
-			tok == IF ||
-			tok == BREAK ||
-			tok == SWITCH ||
-			tok == CASE ||
-			tok == RETURN ||
-			tok == FUNC ||
-			IsBinaryOperator(tok) ||
-			IsBooleanOperator(tok) ||
-			IsNumber(tok) || 
-			IsString(tok)) {
-			total++;
-		}
-		tok = GetNextToken(lexer);
-	}
-	DestroyLexer(lexer);
-	return total;
-}
-
-/**
- * Count the total number of scopes
- */
-int CountTotalScopes(Lexer* lexer){
-	int total = 1;
-	Token tok = GetNextToken(lexer);
-	while (tok != UNDEFINED){
-		if (tok == CASE ||
-			tok == SWITCH ||
-			tok == FOR ||
-			tok == IF ||
-			tok == WHILE ||
-			tok == FUNC) {
-			total++;
-		}
-		tok = GetNextToken(lexer);
-	}
-	DestroyLexer(lexer);
-	return total;
-}
-
-/**
- * This counts every function that
- */
-int CountTotalFuncs(Lexer* lexer){	
-	int total = 0;
-	Token tok = GetNextToken(lexer);
-
-	while (tok != UNDEFINED){
-		if (tok == FUNC) total++;
-		tok = GetNextToken(lexer);
-	}
-	DestroyLexer(lexer);
-	return total;
-}
-
-/**
- * Count the total number of func calls
- */
-int CountTotalFuncCalls(Lexer* lexer){
-	int total = 0;
-	bool inFunc = false;
-	bool isIdent = false;
-	Token tok = GetNextToken(lexer);
-	while (tok != UNDEFINED){
-		if (tok == FUNC) inFunc = true;
-		if (tok == RPAREN && inFunc) inFunc = false;
-
-		if (tok == IDENTIFIER && !inFunc) isIdent = true;
-		if (tok == RPAREN && isIdent) total++;
-		if (tok == COMMA && isIdent) total++;
-		if (tok == RPAREN && isIdent) isIdent = false;
-		tok = GetNextToken(lexer);
-	}
-	DestroyLexer(lexer);
-	return total;
-}
-
-/**
- * Count the total number of param items,
- * assuming that there aren't any mis-parsed
- * itemd
- */
-int CountTotalParamItems(Lexer* lexer){
-	int total = 0;
-	bool inFunc = false;
-	bool isIdent = false;
-	Token tok = GetNextToken(lexer);
-	while (tok != UNDEFINED){
-		if (tok == FUNC) inFunc = true;
-		if (IsString(tok) ||
-			IsNumber(tok) ||
-			tok == VAR) total++;
-		if (tok == RPAREN && inFunc) inFunc = false;
-
-		if (tok == IDENTIFIER && !inFunc) isIdent = true;
-		if (tok == RPAREN && isIdent) total++;
-		if (tok == COMMA && isIdent) total++;
-		if (tok == RPAREN && isIdent) isIdent = false;
-		tok = GetNextToken(lexer);
-	}
-	DestroyLexer(lexer);
-	return total;
-}
-
-void BackOneToken(Lexer* lexer){
-
-	LexerTracker* previous = &lexer->previousTrackers[lexer->previousTrackerSpot];
-
-	lexer->previousTrackerSpot--;
-	if (lexer->previousTrackerSpot < 0) {
-		lexer->previousTrackerSpot = lexer->totalTrackers - 1;
-	}
-	
-	lexer->tracker.col = previous->col;
-	lexer->tracker.currentTokenPosition = previous->currentTokenPosition;
-	lexer->tracker.row = previous->row;
-	lexer->tracker.tokenEnd = previous->tokenEnd;
-	lexer->tracker.tokenStart = previous->tokenStart;
-
-	char* token = GetTokenString(lexer);
-
-	if (lexer->currentTokenString != NULL) {
-		Free(lexer->currentTokenString);
-	}
-
-	lexer->currentTokenString = token;
-}
-
-void ResetLexer(Lexer* lexer){
-	lexer->tracker.tokenStart = 0;
-	lexer->tracker.tokenEnd = 0;
-	lexer->tracker.currentTokenPosition = 0;
-	lexer->currentTokenString = NULL;
-}
-
-char* GetCurrentTokenString(Lexer* lexer){
-	return lexer->currentTokenString;
-}
-
-void SetNextTokenRange(Lexer* lexer){
-	CrawlSpaces(lexer); // common
-	if (CrawlIdentifierCharacters(lexer) ||
-		CrawlNumbers(lexer) ||
-		CrawlString(lexer) ||
-		CrawlOperators(lexer)){
-		// Just need to break
-	}
-}
-
-bool CrawlOperators(Lexer* lexer){
-	char currentChar = GetCurrentCharacter(lexer);
-	char nextChar = PeekNextCharacter(lexer);
-	SetTokenStart(lexer);
-	switch (currentChar){
-		case '/': {
-			if (nextChar == '/' || nextChar == '*') {} // TODO: Eat Comments
-			if (nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '*': {
-			if (nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '=': {
-			if (nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '+': {
-			if (nextChar == '+' || nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '-': {
-			if (nextChar == '-' || nextChar == '=' || nextChar == '>') GetNextCharacter(lexer);
-			if (isdigit(nextChar) || nextChar == '.') CrawlNumbers(lexer);
-			break;
-		}
-		case '%': {
-			if (nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '<': {
-			if (nextChar == '-' || nextChar == '=') GetNextCharacter(lexer);
-			else if (nextChar == '<') GetNextCharacter(lexer); // TODO: Implement <<=
-			break;
-		}
-		case '>': {
-			if (nextChar == '=') GetNextCharacter(lexer);
-			else if (nextChar == '>') GetNextCharacter(lexer); // TODO: Implement >>=
-			break;
-		}
-		case '!': {
-			if (nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '&': {
-			if (nextChar == '&' || nextChar == '^' || nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '|': {
-			if (nextChar == '|' || nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '^': {
-			if (nextChar == '=') GetNextCharacter(lexer);
-			break;
-		}
-		case '.': {
-			if (isdigit(nextChar)) CrawlNumbers(lexer);
-			break;
-		}
-		case '`':
-		case '@':
-		case '$':
-		case ';':
-		case ',':
-		case '(':
-		case ')':
-		case '[':
-		case ']':
-		case '{':
-		case '}':
-		case '#':
-		case ':': break;
-		default: {
-			SetTokenEnd(lexer);
-			return false;
-		}
-	}
-	GetNextCharacter(lexer);
-	SetTokenEnd(lexer);
-	return true;
-}
-
-bool CrawlString(Lexer* lexer){
-	char currentChar = GetCurrentCharacter(lexer);
-	if (currentChar != '\'' && currentChar != '"') return false;
-	SetTokenStart(lexer);
-	char nextChar = PeekNextCharacter(lexer);
-	char stringBreak = currentChar == '\'' ? '\'' : '"';
-	while (nextChar != stringBreak){
-		GetNextCharacter(lexer);
-		nextChar = PeekNextCharacter(lexer);
-	}
-	GetNextCharacter(lexer);
-	GetNextCharacter(lexer);
-	SetTokenEnd(lexer);
-	return true;
-}
-
-/**
- * Permitted number patterns:
- * 	([.0-9]+)|([0-9]+\.[0-9]+)
- */
-bool CrawlNumbers(Lexer* lexer){
-	char currentChar = GetCurrentCharacter(lexer);
-	char nextChar = PeekNextCharacter(lexer);
-	bool isTrailingPeriod = currentChar == '.';
-	if (isdigit(currentChar) || isTrailingPeriod){
-		SetTokenStart(lexer);
-		bool inside = false;
-		while (true){
-			if (!isdigit(nextChar) && nextChar != '.') break;
-			nextChar = PeekNextCharacter(lexer);
-			GetNextCharacter(lexer);
-			inside = true;
-		}
-		if (!inside) GetNextCharacter(lexer);
-		SetTokenEnd(lexer);
-		return true;
-	}
-	return false;
-}
-
-/**
- * Permitted identifier patterns:
- * 	[a-zA-Z_][a-zA-Z0-9_$]+
- */
-bool CrawlIdentifierCharacters(Lexer* lexer){
-	char currentChar = GetCurrentCharacter(lexer);
-	char nextChar = PeekNextCharacter(lexer);
-	if (isalpha(currentChar) || currentChar == '_'){
-		SetTokenStart(lexer);
-		char* checkCharacters = "$_";
-		bool inside = false;
-		while (true){
-			if (!isalnum(nextChar) && !IsCharacter(nextChar, checkCharacters)) break;
-			nextChar = PeekNextCharacter(lexer);
-			GetNextCharacter(lexer);
-			inside = true;
-		}
-		if (!inside) GetNextCharacter(lexer);
-		SetTokenEnd(lexer);
-		return true;
-	}
-	return false;
-}
-
-bool CrawlSpaces(Lexer* lexer){
-	char currentChar = GetCurrentCharacter(lexer);
-	if (currentChar == ' '){
-		char nextChar = PeekNextCharacter(lexer);
-		char* checkCharacters = " \n\r";
-		while (IsCharacter(nextChar, checkCharacters)){
-			if (nextChar == '\n'){
-				lexer->tracker.row++;
-				lexer->tracker.col = 1;
-			}
-
-			nextChar = PeekNextCharacter(lexer);
-			GetNextCharacter(lexer);
-		}
-		GetNextCharacter(lexer);
-		return true;
-	}
-	return false;
-}
-
-char GetCurrentCharacter(Lexer* lexer){
-	if (lexer->length > lexer->tracker.currentTokenPosition){
-		return lexer->rawSourceCode[lexer->tracker.currentTokenPosition];
-	}
-	return -1; // End of File
-}
-
-char GetNextCharacter(Lexer* lexer){
-	lexer->tracker.currentTokenPosition++;
-	return GetCurrentCharacter(lexer);
-}
-
-char PeekNextCharacter(Lexer* lexer){
-	lexer->tracker.currentTokenPosition++;
-	char c = GetCurrentCharacter(lexer);
-	lexer->tracker.currentTokenPosition--;
-	return c;
-}
-
-bool IsCharacter(char character, char charactersToCheck[]){
-	int len = strlen(charactersToCheck);
-	for (int i = 0; i < len; i++){
-		if (character == charactersToCheck[i]) return true;
-	}
-	return false;
-}
-
-char* GetTokenString(Lexer* lexer){
-	LexerTracker tracker = lexer->tracker;
-	int len = tracker.tokenEnd - tracker.tokenStart;
-	char* placeholder = (char*) Allocate((sizeof(char) * len) + sizeof(char));
-	int charSpot = 0;
-	for (int i = tracker.tokenStart; i < tracker.tokenEnd; i++){
-		placeholder[charSpot++] = lexer->rawSourceCode[i];
-	}
-	placeholder[len] = '\0';
-	return placeholder;
-}
-
-void SetTokenStart(Lexer* lexer){
-	lexer->tracker.tokenStart = lexer->tracker.currentTokenPosition;
-}
-
-void SetTokenEnd(Lexer* lexer){
-	lexer->tracker.tokenEnd = lexer->tracker.currentTokenPosition;
+#include "lexer.h"
+
+void InitLexer(Lexer* lexer, char* rawSourceCode){
+	// Init lexer
+	lexer->rawSourceCode = rawSourceCode;
+	lexer->length = strlen(rawSourceCode);
+	lexer->currentTokenString = NULL;
+
+	// Init lexer tracker
+	lexer->tracker.currentTokenPosition = 0;
+	lexer->tracker.tokenStart = 0;
+	lexer->tracker.tokenEnd = 0;
+	lexer->tracker.row = 1;
+	lexer->tracker.col = 1;
+	lexer->previousTrackerSpot = -1;
+	lexer->totalTrackers = 5;
+
+	for (int i = 0; i < lexer->totalTrackers; i++) {
+		lexer->previousTrackers[i].col = 0;
+		lexer->previousTrackers[i].row = 0;
+		lexer->previousTrackers[i].tokenEnd = 0;
+		lexer->previousTrackers[i].tokenStart = 0;
+		lexer->previousTrackers[i].currentTokenPosition = 0;
+	}
+}
+
+void DestroyLexer(Lexer* lexer){
+	if (lexer->currentTokenString != NULL) Free(lexer->currentTokenString);
+}
+
+void SetPreviousTracker(Lexer* lexer){
+
+	lexer->previousTrackerSpot++;
+	if (lexer->previousTrackerSpot >= lexer->totalTrackers){
+		lexer->previousTrackerSpot = 0;
+	}
+
+	LexerTracker* previous = &lexer->previousTrackers[lexer->previousTrackerSpot];
+
+	previous->col = lexer->tracker.col;
+	previous->currentTokenPosition = lexer->tracker.currentTokenPosition;
+	previous->row = lexer->tracker.row;
+	previous->tokenEnd = lexer->tracker.tokenEnd;
+	previous->tokenStart = lexer->tracker.tokenStart;
+}
+
+Token GetNextToken(Lexer* lexer){
+	SetPreviousTracker(lexer);
+
+	// Reset token locations
+	lexer->tracker.tokenStart = 0;
+	lexer->tracker.tokenEnd = 0;
+
+	SetNextTokenRange(lexer);
+	if (lexer->tracker.tokenEnd - lexer->tracker.tokenStart == 0) return UNDEFINED;
+	char* token = GetTokenString(lexer);
+
+
+	if (lexer->currentTokenString != NULL) {
+		Free(lexer->currentTokenString);
+	}
+	lexer->currentTokenString = token;
+
+	// No token starts with a digit, number literals skip the
+	// lookup in the token table
+	if (isdigit(token[0])) return NUMBER;
+	Token tok = StringToToken(token);
+	
+	bool containsChars = strlen(token) > 0;
+	if (tok == UNDEFINED && containsChars && (token[0] == '.' || isdigit(token[0]))) {
+		return NUMBER;
+	}
+	else if (tok == UNDEFINED && containsChars && (token[0] == '\'' || token[0] == '"')){
+		return STRING;
+	}
+	else if (tok == UNDEFINED && containsChars){
+		return IDENTIFIER;
+	}
+	return tok;
+}
+
+void PeekNextToken(Lexer* lexer, PeekedToken* peeked){
+	peeked->token = GetNextToken(lexer);
+	peeked->raw = lexer->currentTokenString;
+	BackOneToken(lexer);
+}
+
+Token GetCurrentToken(Lexer* lexer){
+	BackOneToken(lexer);
+	return GetNextToken(lexer);
+}
+	
+/**
+ * This function is key in allocation the correct number of 
+ * ASTNodes.
+ *
+ * Logic:
+ * 	If VAR appears, allocate 1 ASTVar slot
+ * 	If ASSIGN appears, allocate 1 ASTBinaryExpr slot var a = 10;
+ */
+int CountTotalASTTokens(Lexer* lexer){
+	int total = 0;
+	PeekedToken peeked;
+	Token tok = GetNextToken(lexer);
+	while (tok != UNDEFINED){
+
+		if (tok == IDENTIFIER){
+			PeekNextToken(lexer, &peeked);
+			if (peeked.token == LPAREN) total++;
+		}
+		else if (tok == VAR ||
+			tok == FOR ||
+			tok == WHILE ||
+			IsAssignment(tok) ||
+			tok == INC ||
+			tok == DEC ||
+			tok == NUMBER ||
+			tok == STRING || 
+			tok == IF ||
+			tok == BREAK ||
+			tok == SWITCH ||
+			tok == CASE ||
+			tok == RETURN ||
+			tok == FUNC ||
+			tok == TRUE_LITERAL ||
+			tok == FALSE_LITERAL ||
+			IsBinaryOperator(tok) ||
+			IsBooleanOperator(tok) ||
+			IsNumber(tok) || 
+			IsString(tok)) {
+			total++;
+		}
+
+		// A negation adds a 0 operand, see ParseExpression
+		if (tok == SUB) total++;
+		tok = GetNextToken(lexer);
+	}
+	DestroyLexer(lexer);
+	return total;
+}
+
+/**
+ * Count the total number of scopes
+ */
+int CountTotalScopes(Lexer* lexer){
+	int total = 1;
+	Token tok = GetNextToken(lexer);
+	while (tok != UNDEFINED){
+		if (tok == CASE ||
+			tok == SWITCH ||
+			tok == FOR ||
+			tok == IF ||
+			tok == WHILE ||
+			tok == FUNC) {
+			total++;
+		}
+		tok = GetNextToken(lexer);
+	}
+	DestroyLexer(lexer);
+	return total;
+}
+
+/**
+ * This counts every function that
+ */
+int CountTotalFuncs(Lexer* lexer){	
+	int total = 0;
+	Token tok = GetNextToken(lexer);
+
+	while (tok != UNDEFINED){
+		if (tok == FUNC) total++;
+		tok = GetNextToken(lexer);
+	}
+	DestroyLexer(lexer);
+	return total;
+}
+
+/**
+ * Count the total number of func calls, every identifier
+ * followed by a paren that is not a function declaration.
+ * Nested calls are counted too.
+ */
+int CountTotalFuncCalls(Lexer* lexer){
+	int total = 0;
+	Token previous = UNDEFINED;
+	Token beforePrevious = UNDEFINED;
+	Token tok = GetNextToken(lexer);
+	while (tok != UNDEFINED){
+		if (tok == LPAREN && previous == IDENTIFIER && beforePrevious != FUNC) total++;
+		beforePrevious = previous;
+		previous = tok;
+		tok = GetNextToken(lexer);
+	}
+	DestroyLexer(lexer);
+	return total;
+}
+
+/**
+ * Count the total number of param items. Every param or
+ * argument starts right after a paren or a comma, so this
+ * is an upper bound even for nested calls.
+ */
+int CountTotalParamItems(Lexer* lexer){
+	int total = 0;
+	Token tok = GetNextToken(lexer);
+	while (tok != UNDEFINED){
+		if (tok == LPAREN || tok == COMMA) total++;
+		tok = GetNextToken(lexer);
+	}
+	DestroyLexer(lexer);
+	return total;
+}
+
+/**
+ * Count the total number of infix operators. Chains of them
+ * are flattened into lists, see ReduceOperator.
+ */
+int CountTotalOperators(Lexer* lexer){
+	int total = 0;
+	Token tok = GetNextToken(lexer);
+	while (tok != UNDEFINED){
+		if (GetPrecedence(tok) > 0) total++;
+		tok = GetNextToken(lexer);
+	}
+	DestroyLexer(lexer);
+	return total;
+}
+
+/**
+ * Count the nodes that inlining may add. A function whose
+ * body is a single return of at most threshold tokens, with
+ * no calls, can be inlined; every call to it may need a copy
+ * of those tokens. See InlineCalls.
+ */
+int CountInlineNodes(Lexer* lexer, int threshold){
+	int total = 0;
+	int length = 0;
+	char** names = NULL;
+	int* sizes = NULL;
+	int pending = 0;
+	Token tok = GetNextToken(lexer);
+	while (tok != UNDEFINED){
+		if (tok == FUNC){
+			tok = GetNextToken(lexer);
+			if (tok != IDENTIFIER) continue;
+			char* name = Allocate(strlen(lexer->currentTokenString) + 1);
+			strcpy(name, lexer->currentTokenString);
+
+			while (tok != UNDEFINED && tok != RPAREN) tok = GetNextToken(lexer);
+			tok = GetNextToken(lexer);
+			bool braces = tok == LBRACE;
+			if (braces) tok = GetNextToken(lexer);
+
+			int size = -1;
+			if (tok == RETURN){
+				size = 0;
+				tok = GetNextToken(lexer);
+				while (tok != UNDEFINED && tok != SEMICOLON && tok != RBRACE){
+					if (tok == LPAREN){
+						size = threshold + 1;
+						total += pending;
+					}
+					pending = tok == IDENTIFIER ? FindInlineSize(names, sizes, length, lexer->currentTokenString) : 0;
+					size++;
+					tok = GetNextToken(lexer);
+				}
+				if (tok == SEMICOLON) tok = GetNextToken(lexer);
+				if (braces && tok != RBRACE) size = -1;
+			}
+
+			if (size > 0 && size <= threshold){
+				names = Reallocate(names, sizeof(char*) * (length + 1));
+				sizes = Reallocate(sizes, sizeof(int) * (length + 1));
+				names[length] = name;
+				sizes[length++] = size;
+			}
+			else {
+				Free(name);
+			}
+			pending = 0;
+			continue;
+		}
+
+		// The size of the function an identifier names, counted
+		// once the paren makes it a call
+		if (tok == LPAREN) total += pending;
+		pending = tok == IDENTIFIER ? FindInlineSize(names, sizes, length, lexer->currentTokenString) : 0;
+		tok = GetNextToken(lexer);
+	}
+
+	for (int i = 0; i < length; i++) Free(names[i]);
+	if (names != NULL) Free(names);
+	if (sizes != NULL) Free(sizes);
+	DestroyLexer(lexer);
+	return total;
+}
+
+/**
+ * Count the nodes that cloning may add, and the scopes through
+ * scopes. A function with a param declared var gets a clone
+ * for each other type of arguments it is called with, at most
+ * limit of them, and a clone is no larger than the function's
+ * tokens. A function called once is never cloned. See
+ * Monomorphize.
+ */
+int CountCloneNodes(Lexer* lexer, int limit, int* scopes){
+	int total = 0;
+	int length = 0;
+	char** names = NULL;
+	int* sizes = NULL;
+	int* bodies = NULL;
+	int* calls = NULL;
+	int pending = -1;
+	Token previous = UNDEFINED;
+	Token tok = GetNextToken(lexer);
+	while (tok != UNDEFINED){
+		if (tok == FUNC){
+			tok = GetNextToken(lexer);
+			if (tok != IDENTIFIER) continue;
+			char* name = Allocate(strlen(lexer->currentTokenString) + 1);
+			strcpy(name, lexer->currentTokenString);
+
+			int size = 2;
+			int scopeCount = 1;
+			bool generic = false;
+			while (tok != UNDEFINED && tok != RPAREN){
+				tok = GetNextToken(lexer);
+				if (tok == VAR) generic = true;
+				size++;
+			}
+
+			// The body runs to its closing brace, or without
+			// braces to the end of its one statement
+			int depth = 0;
+			previous = UNDEFINED;
+			tok = GetNextToken(lexer);
+			while (tok != UNDEFINED){
+				size++;
+				if (tok == CASE || tok == SWITCH || tok == FOR || tok == IF || tok == WHILE || tok == FUNC) scopeCount++;
+				if (tok == LBRACE || tok == LPAREN) depth++;
+				if (tok == RBRACE || tok == RPAREN) depth--;
+				if (tok == LPAREN && previous == IDENTIFIER && pending >= 0) calls[pending]++;
+				pending = tok == IDENTIFIER ? FindCloneIndex(names, length, lexer->currentTokenString) : -1;
+				previous = tok;
+				tok = GetNextToken(lexer);
+				if (depth <= 0 && (previous == RBRACE || previous == SEMICOLON)) break;
+			}
+
+			if (generic){
+				names = Reallocate(names, sizeof(char*) * (length + 1));
+				sizes = Reallocate(sizes, sizeof(int) * (length + 1));
+				bodies = Reallocate(bodies, sizeof(int) * (length + 1));
+				calls = Reallocate(calls, sizeof(int) * (length + 1));
+				names[length] = name;
+				sizes[length] = size;
+				bodies[length] = scopeCount;
+				calls[length++] = 0;
+			}
+			else {
+				Free(name);
+			}
+			pending = -1;
+			continue;
+		}
+
+		if (tok == LPAREN && previous == IDENTIFIER && pending >= 0) calls[pending]++;
+		pending = tok == IDENTIFIER ? FindCloneIndex(names, length, lexer->currentTokenString) : -1;
+		previous = tok;
+		tok = GetNextToken(lexer);
+	}
+
+	*scopes = 0;
+	for (int i = 0; i < length; i++){
+		int clones = calls[i] - 1 < limit ? calls[i] - 1 : limit;
+		if (clones > 0){
+			total += sizes[i] * clones;
+			*scopes += bodies[i] * clones;
+		}
+		Free(names[i]);
+	}
+	if (names != NULL){
+		Free(names);
+		Free(sizes);
+		Free(bodies);
+		Free(calls);
+	}
+	DestroyLexer(lexer);
+	return total;
+}
+
+int FindCloneIndex(char** names, int length, char* name){
+	for (int i = 0; i < length; i++){
+		if (strcmp(names[i], name) == 0) return i;
+	}
+	return -1;
+}
+
+int FindInlineSize(char** names, int* sizes, int length, char* name){
+	for (int i = 0; i < length; i++){
+		if (strcmp(names[i], name) == 0) return sizes[i];
+	}
+	return 0;
+}
+
+void BackOneToken(Lexer* lexer){
+
+	LexerTracker* previous = &lexer->previousTrackers[lexer->previousTrackerSpot];
+
+	lexer->previousTrackerSpot--;
+	if (lexer->previousTrackerSpot < 0) {
+		lexer->previousTrackerSpot = lexer->totalTrackers - 1;
+	}
+	
+	lexer->tracker.col = previous->col;
+	lexer->tracker.currentTokenPosition = previous->currentTokenPosition;
+	lexer->tracker.row = previous->row;
+	lexer->tracker.tokenEnd = previous->tokenEnd;
+	lexer->tracker.tokenStart = previous->tokenStart;
+
+	char* token = GetTokenString(lexer);
+
+	if (lexer->currentTokenString != NULL) {
+		Free(lexer->currentTokenString);
+	}
+
+	lexer->currentTokenString = token;
+}
+
+void ResetLexer(Lexer* lexer){
+	lexer->tracker.tokenStart = 0;
+	lexer->tracker.tokenEnd = 0;
+	lexer->tracker.currentTokenPosition = 0;
+	lexer->currentTokenString = NULL;
+}
+
+/**
+ * The current token as a view into the source, which is not
+ * NUL terminated
+ */
+char* GetCurrentTokenView(Lexer* lexer, int* length){
+	*length = lexer->tracker.tokenEnd - lexer->tracker.tokenStart;
+	return &lexer->rawSourceCode[lexer->tracker.tokenStart];
+}
+
+char* GetCurrentTokenString(Lexer* lexer){
+	return lexer->currentTokenString;
+}
+
+void SetNextTokenRange(Lexer* lexer){
+	CrawlSpaces(lexer); // common
+	if (CrawlIdentifierCharacters(lexer) ||
+		CrawlNumbers(lexer) ||
+		CrawlString(lexer) ||
+		CrawlOperators(lexer)){
+		// Just need to break
+	}
+}
+
+bool CrawlOperators(Lexer* lexer){
+	char currentChar = GetCurrentCharacter(lexer);
+	char nextChar = PeekNextCharacter(lexer);
+	SetTokenStart(lexer);
+	switch (currentChar){
+		case '/': {
+			if (nextChar == '/' || nextChar == '*') {} // TODO: Eat Comments
+			if (nextChar == '=') GetNextCharacter(lexer);
+			break;
+		}
+		case '*': {
+			if (nextChar == '=' || nextChar == '*') GetNextCharacter(lexer);
+			break;
+		}
+		case '=': {
+			if (nextChar == '=') GetNextCharacter(lexer);
+			break;
+		}
+		case '+': {
+			if (nextChar == '+' || nextChar == '=') GetNextCharacter(lexer);
+			break;
+		}
+		case '-': {
+			if (nextChar == '-' || nextChar == '=' || nextChar == '>') GetNextCharacter(lexer);
+			if (isdigit(nextChar) || nextChar == '.') CrawlNumbers(lexer);
+			break;
+		}
+		case '%': {
+			if (nextChar == '=') GetNextCharacter(lexer);
+			break;
+		}
+		case '<': {
+			if (nextChar == '-' || nextChar == '=') GetNextCharacter(lexer);
+			else if (nextChar == '<') {
+				GetNextCharacter(lexer);
+				if (PeekNextCharacter(lexer) == '=') GetNextCharacter(lexer);
+			}
+			break;
+		}
+		case '>': {
+			if (nextChar == '=') GetNextCharacter(lexer);
+			else if (nextChar == '>') {
+				GetNextCharacter(lexer);
+				if (PeekNextCharacter(lexer) == '=') GetNextCharacter(lexer);
+			}
+			break;
+		}
+		case '!': {
+			if (nextChar == '=') GetNextCharacter(lexer);
+			break;
+		}
+		case '&': {
+			if (nextChar == '&' || nextChar == '=') GetNextCharacter(lexer);
+			else if (nextChar == '^') {
+				GetNextCharacter(lexer);
+				if (PeekNextCharacter(lexer) == '=') GetNextCharacter(lexer);
+			}
+			break;
+		}
+		case '|': {
+			if (nextChar == '|' || nextChar == '=') GetNextCharacter(lexer);
+			break;
+		}
+		case '^': {
+			if (nextChar == '=') GetNextCharacter(lexer);
+			break;
+		}
+		case '.': {
+			if (isdigit(nextChar)) CrawlNumbers(lexer);
+			break;
+		}
+		case '`':
+		case '@':
+		case '$':
+		case ';':
+		case ',':
+		case '(':
+		case ')':
+		case '[':
+		case ']':
+		case '{':
+		case '}':
+		case '#':
+		case ':': break;
+		default: {
+			SetTokenEnd(lexer);
+			return false;
+		}
+	}
+	GetNextCharacter(lexer);
+	SetTokenEnd(lexer);
+	return true;
+}
+
+bool CrawlString(Lexer* lexer){
+	char currentChar = GetCurrentCharacter(lexer);
+	if (currentChar != '\'' && currentChar != '"') return false;
+	SetTokenStart(lexer);
+	char nextChar = PeekNextCharacter(lexer);
+	char stringBreak = currentChar == '\'' ? '\'' : '"';
+	while (nextChar != stringBreak){
+		GetNextCharacter(lexer);
+		nextChar = PeekNextCharacter(lexer);
+	}
+	GetNextCharacter(lexer);
+	GetNextCharacter(lexer);
+	SetTokenEnd(lexer);
+	return true;
+}
+
+/**
+ * Permitted number patterns:
+ * 	([.0-9]+)|([0-9]+\.[0-9]+)
+ */
+bool CrawlNumbers(Lexer* lexer){
+	char currentChar = GetCurrentCharacter(lexer);
+	char nextChar = PeekNextCharacter(lexer);
+	bool isTrailingPeriod = currentChar == '.';
+	if (isdigit(currentChar) || isTrailingPeriod){
+		SetTokenStart(lexer);
+		bool inside = false;
+		while (true){
+			if (!isdigit(nextChar) && nextChar != '.') break;
+			nextChar = PeekNextCharacter(lexer);
+			GetNextCharacter(lexer);
+			inside = true;
+		}
+		if (!inside) GetNextCharacter(lexer);
+		SetTokenEnd(lexer);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Permitted identifier patterns:
+ * 	[a-zA-Z_][a-zA-Z0-9_$]+
+ */
+bool CrawlIdentifierCharacters(Lexer* lexer){
+	char currentChar = GetCurrentCharacter(lexer);
+	char nextChar = PeekNextCharacter(lexer);
+	if (isalpha(currentChar) || currentChar == '_'){
+		SetTokenStart(lexer);
+		char* checkCharacters = "$_";
+		bool inside = false;
+		while (true){
+			if (!isalnum(nextChar) && !IsCharacter(nextChar, checkCharacters)) break;
+			nextChar = PeekNextCharacter(lexer);
+			GetNextCharacter(lexer);
+			inside = true;
+		}
+		if (!inside) GetNextCharacter(lexer);
+		SetTokenEnd(lexer);
+		return true;
+	}
+	return false;
+}
+
+bool CrawlSpaces(Lexer* lexer){
+	char currentChar = GetCurrentCharacter(lexer);
+	if (currentChar == ' '){
+		char nextChar = PeekNextCharacter(lexer);
+		char* checkCharacters = " \n\r";
+		while (IsCharacter(nextChar, checkCharacters)){
+			if (nextChar == '\n'){
+				lexer->tracker.row++;
+				lexer->tracker.col = 1;
+			}
+
+			nextChar = PeekNextCharacter(lexer);
+			GetNextCharacter(lexer);
+		}
+		GetNextCharacter(lexer);
+		return true;
+	}
+	return false;
+}
+
+char GetCurrentCharacter(Lexer* lexer){
+	if (lexer->length > lexer->tracker.currentTokenPosition){
+		return lexer->rawSourceCode[lexer->tracker.currentTokenPosition];
+	}
+	return -1; // End of File
+}
+
+char GetNextCharacter(Lexer* lexer){
+	lexer->tracker.currentTokenPosition++;
+	return GetCurrentCharacter(lexer);
+}
+
+char PeekNextCharacter(Lexer* lexer){
+	lexer->tracker.currentTokenPosition++;
+	char c = GetCurrentCharacter(lexer);
+	lexer->tracker.currentTokenPosition--;
+	return c;
+}
+
+bool IsCharacter(char character, char charactersToCheck[]){
+	int len = strlen(charactersToCheck);
+	for (int i = 0; i < len; i++){
+		if (character == charactersToCheck[i]) return true;
+	}
+	return false;
+}
+
+char* GetTokenString(Lexer* lexer){
+	LexerTracker tracker = lexer->tracker;
+	int len = tracker.tokenEnd - tracker.tokenStart;
+	char* placeholder = (char*) Allocate((sizeof(char) * len) + sizeof(char));
+	int charSpot = 0;
+	for (int i = tracker.tokenStart; i < tracker.tokenEnd; i++){
+		placeholder[charSpot++] = lexer->rawSourceCode[i];
+	}
+	placeholder[len] = '\0';
+	return placeholder;
+}
+
+void SetTokenStart(Lexer* lexer){
+	lexer->tracker.tokenStart = lexer->tracker.currentTokenPosition;
+}
+
+void SetTokenEnd(Lexer* lexer){
+	lexer->tracker.tokenEnd = lexer->tracker.currentTokenPosition;
 }
\ No newline at end of file
@@ -1,11 +1,17 @@
-#include "allocate.h"
-
-void* Allocate(int size){
-	void* ptr = malloc(size);
-	if (!ptr) return NULL;
-	return ptr;
-}
-
-void Free(void* ptr){
-	free(ptr);
+#include "allocate.h"
+
+void* Allocate(int size){
+	void* ptr = malloc(size);
+	if (!ptr) return NULL;
+	return ptr;
+}
+
+void* Reallocate(void* ptr, int size){
+	ptr = realloc(ptr, size);
+	if (!ptr) return NULL;
+	return ptr;
+}
+
+void Free(void* ptr){
+	free(ptr);
 }
\ No newline at end of file
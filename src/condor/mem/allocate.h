@@ -1,13 +1,14 @@
-// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
-// Use of this source code is governed by a BSD-style
-// license that can be found in the LICENSE file.
-
-#ifndef ALLOCATE_H_
-#define ALLOCATE_H_
-
-#include <stdlib.h>
-
-void* Allocate(int size);
-void Free(void* ptr);
-
-#endif // ALLOCATE_H_
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef ALLOCATE_H_
+#define ALLOCATE_H_
+
+#include <stdlib.h>
+
+void* Allocate(int size);
+void* Reallocate(void* ptr, int size);
+void Free(void* ptr);
+
+#endif // ALLOCATE_H_
@@ -0,0 +1,75 @@
+#include "arena.h"
+
+// Allocations keep this alignment
+#define ARENA_ALIGN 8
+
+void InitArena(Arena* arena){
+	arena->blocks = NULL;
+	arena->last = NULL;
+}
+
+void DestroyArena(Arena* arena){
+	ArenaBlock* block = arena->blocks;
+	while (block != NULL){
+		ArenaBlock* next = block->next;
+		Free(block);
+		block = next;
+	}
+	arena->blocks = NULL;
+	arena->last = NULL;
+}
+
+/**
+ * Returns NULL when out of memory, like Allocate
+ */
+void* ArenaAllocate(Arena* arena, int size){
+	size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	ArenaBlock* block = arena->blocks;
+	if (block == NULL || block->capacity - block->used < size){
+		int capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+		block = Allocate(sizeof(ArenaBlock) + capacity);
+		if (block == NULL) return NULL;
+		block->used = 0;
+		block->capacity = capacity;
+
+		// A block for one big allocation goes behind the current
+		// one, so the current one's free space is still used
+		if (size > ARENA_BLOCK_SIZE && arena->blocks != NULL){
+			block->next = arena->blocks->next;
+			arena->blocks->next = block;
+			block->used = size;
+			return block->data;
+		}
+		block->next = arena->blocks;
+		arena->blocks = block;
+	}
+
+	void* ptr = &block->data[block->used];
+	block->used += size;
+	arena->last = ptr;
+	return ptr;
+}
+
+/**
+ * The latest allocation grows in place while its block has
+ * room, anything else is copied to a new allocation and the
+ * old space stays until the arena is destroyed
+ */
+void* ArenaReallocate(Arena* arena, void* ptr, int oldSize, int size){
+	if (ptr == NULL) return ArenaAllocate(arena, size);
+
+	ArenaBlock* block = arena->blocks;
+	if (ptr == arena->last){
+		int start = (int) ((char*) ptr - block->data);
+		if (start + size <= block->capacity){
+			block->used = start + ((size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1));
+			if (block->used > block->capacity) block->used = block->capacity;
+			return ptr;
+		}
+	}
+
+	void* copy = ArenaAllocate(arena, size);
+	if (copy == NULL) return NULL;
+	memcpy(copy, ptr, oldSize < size ? oldSize : size);
+	return copy;
+}
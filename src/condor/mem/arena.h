@@ -0,0 +1,38 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * A bump allocator for memory that lives as long as one
+ * compile. Allocations are carved from large blocks and are
+ * never freed one by one: DestroyArena releases them all.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <string.h>
+#include "allocate.h"
+
+#ifndef ARENA_BLOCK_SIZE
+#define ARENA_BLOCK_SIZE 65536
+#endif
+
+typedef struct ArenaBlock {
+	struct ArenaBlock* next;
+	int used;
+	int capacity;
+	char data[];
+} ArenaBlock;
+
+typedef struct Arena {
+	ArenaBlock* blocks; // The newest first, the one allocated from
+	void* last; // The latest allocation, which can grow in place
+} Arena;
+
+void InitArena(Arena* arena);
+void DestroyArena(Arena* arena);
+void* ArenaAllocate(Arena* arena, int size);
+void* ArenaReallocate(Arena* arena, void* ptr, int oldSize, int size);
+
+#endif // ARENA_H_
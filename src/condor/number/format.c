@@ -0,0 +1,370 @@
+#include <math.h>
+#include <stdlib.h>
+#include "format.h"
+
+/**
+ * "00" to "99", indexed by twice the pair's value
+ */
+const char DigitPairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+const uint64_t PowersOfTen64[] = {
+	1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL,
+	100000000UL, 1000000000UL, 10000000000UL, 100000000000UL,
+	1000000000000UL, 10000000000000UL, 100000000000000UL,
+	1000000000000000UL, 10000000000000000UL, 100000000000000000UL,
+	1000000000000000000UL, 10000000000000000000UL
+};
+
+/**
+ * 10^k for k from -348 to 340 in steps of 8, as normalized
+ * 64 bit significands and binary exponents
+ */
+const uint64_t CachedPowersF[] = {
+	0xfa8fd5a0081c0288UL, 0xbaaee17fa23ebf76UL, 0x8b16fb203055ac76UL,
+	0xcf42894a5dce35eaUL, 0x9a6bb0aa55653b2dUL, 0xe61acf033d1a45dfUL,
+	0xab70fe17c79ac6caUL, 0xff77b1fcbebcdc4fUL, 0xbe5691ef416bd60cUL,
+	0x8dd01fad907ffc3cUL, 0xd3515c2831559a83UL, 0x9d71ac8fada6c9b5UL,
+	0xea9c227723ee8bcbUL, 0xaecc49914078536dUL, 0x823c12795db6ce57UL,
+	0xc21094364dfb5637UL, 0x9096ea6f3848984fUL, 0xd77485cb25823ac7UL,
+	0xa086cfcd97bf97f4UL, 0xef340a98172aace5UL, 0xb23867fb2a35b28eUL,
+	0x84c8d4dfd2c63f3bUL, 0xc5dd44271ad3cdbaUL, 0x936b9fcebb25c996UL,
+	0xdbac6c247d62a584UL, 0xa3ab66580d5fdaf6UL, 0xf3e2f893dec3f126UL,
+	0xb5b5ada8aaff80b8UL, 0x87625f056c7c4a8bUL, 0xc9bcff6034c13053UL,
+	0x964e858c91ba2655UL, 0xdff9772470297ebdUL, 0xa6dfbd9fb8e5b88fUL,
+	0xf8a95fcf88747d94UL, 0xb94470938fa89bcfUL, 0x8a08f0f8bf0f156bUL,
+	0xcdb02555653131b6UL, 0x993fe2c6d07b7facUL, 0xe45c10c42a2b3b06UL,
+	0xaa242499697392d3UL, 0xfd87b5f28300ca0eUL, 0xbce5086492111aebUL,
+	0x8cbccc096f5088ccUL, 0xd1b71758e219652cUL, 0x9c40000000000000UL,
+	0xe8d4a51000000000UL, 0xad78ebc5ac620000UL, 0x813f3978f8940984UL,
+	0xc097ce7bc90715b3UL, 0x8f7e32ce7bea5c70UL, 0xd5d238a4abe98068UL,
+	0x9f4f2726179a2245UL, 0xed63a231d4c4fb27UL, 0xb0de65388cc8ada8UL,
+	0x83c7088e1aab65dbUL, 0xc45d1df942711d9aUL, 0x924d692ca61be758UL,
+	0xda01ee641a708deaUL, 0xa26da3999aef774aUL, 0xf209787bb47d6b85UL,
+	0xb454e4a179dd1877UL, 0x865b86925b9bc5c2UL, 0xc83553c5c8965d3dUL,
+	0x952ab45cfa97a0b3UL, 0xde469fbd99a05fe3UL, 0xa59bc234db398c25UL,
+	0xf6c69a72a3989f5cUL, 0xb7dcbf5354e9beceUL, 0x88fcf317f22241e2UL,
+	0xcc20ce9bd35c78a5UL, 0x98165af37b2153dfUL, 0xe2a0b5dc971f303aUL,
+	0xa8d9d1535ce3b396UL, 0xfb9b7cd9a4a7443cUL, 0xbb764c4ca7a44410UL,
+	0x8bab8eefb6409c1aUL, 0xd01fef10a657842cUL, 0x9b10a4e5e9913129UL,
+	0xe7109bfba19c0c9dUL, 0xac2820d9623bf429UL, 0x80444b5e7aa7cf85UL,
+	0xbf21e44003acdd2dUL, 0x8e679c2f5e44ff8fUL, 0xd433179d9c8cb841UL,
+	0x9e19db92b4e31ba9UL, 0xeb96bf6ebadf77d9UL, 0xaf87023b9bf0ee6bUL
+};
+
+const short CachedPowersE[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+	-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+	-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+	-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+	-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+	109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+	641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066
+};
+
+int FormatLong(long value, char* buffer){
+	unsigned long magnitude = value < 0 ? 0UL - (unsigned long) value : (unsigned long) value;
+	char digits[FORMAT_BUFFER_SIZE];
+	int spot = FORMAT_BUFFER_SIZE;
+	while (magnitude >= 100){
+		int pair = (int) (magnitude % 100) * 2;
+		magnitude /= 100;
+		digits[--spot] = DigitPairs[pair + 1];
+		digits[--spot] = DigitPairs[pair];
+	}
+	if (magnitude >= 10){
+		int pair = (int) magnitude * 2;
+		digits[--spot] = DigitPairs[pair + 1];
+		digits[--spot] = DigitPairs[pair];
+	}
+	else {
+		digits[--spot] = (char) ('0' + magnitude);
+	}
+	if (value < 0) digits[--spot] = '-';
+
+	int length = FORMAT_BUFFER_SIZE - spot;
+	memcpy(buffer, &digits[spot], length);
+	buffer[length] = '\0';
+	return length;
+}
+
+int FormatDouble(double value, char* buffer){
+	if (value != value || value - value != 0) return FormatSpecial(value, buffer);
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	int biased = (int) ((bits >> 52) & 0x7FF);
+	DiyFp v = {bits & ((1UL << 52) - 1), -1074};
+	if (biased != 0){
+		v.f |= 1UL << 52;
+		v.e = biased - 1075;
+	}
+	return FormatShortest(v, 52, (bits >> 63) != 0, buffer);
+}
+
+/**
+ * The digits are the fewest that read back as the same float,
+ * which are often fewer than for the same value as a double
+ */
+int FormatFloat(float value, char* buffer){
+	if (value != value || value - value != 0) return FormatSpecial(value, buffer);
+
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	int biased = (int) ((bits >> 23) & 0xFF);
+	DiyFp v = {bits & ((1U << 23) - 1), -149};
+	if (biased != 0){
+		v.f |= 1UL << 23;
+		v.e = biased - 150;
+	}
+	return FormatShortest(v, 23, (bits >> 31) != 0, buffer);
+}
+
+/**
+ * Grisu3 on a value with significandBits stored bits, falling
+ * back to ShortenDigits when it cannot vouch for its digits.
+ * Zero is written as 0.0, and a number with no fraction keeps
+ * a .0 so it still reads as floating point.
+ */
+int FormatShortest(DiyFp v, int significandBits, bool negative, char* buffer){
+	char* digits = buffer + negative;
+	if (negative) buffer[0] = '-';
+	if (v.f == 0){
+		strcpy(digits, "0.0");
+		return negative + 3;
+	}
+
+	// The values halfway to the neighbouring ones bound what
+	// reads back as v. Below a power of two the neighbour is
+	// half as far.
+	DiyFp upper = NormalizeDiyFp((DiyFp) {(v.f << 1) + 1, v.e - 1});
+	DiyFp lower = v.f == (1UL << significandBits) ?
+		(DiyFp) {(v.f << 2) - 1, v.e - 2} :
+		(DiyFp) {(v.f << 1) - 1, v.e - 1};
+	lower.f <<= lower.e - upper.e;
+	lower.e = upper.e;
+
+	int k;
+	DiyFp power = GetCachedPower(upper.e, &k);
+	DiyFp w = MultiplyDiyFp(NormalizeDiyFp(v), power);
+	DiyFp high = MultiplyDiyFp(upper, power);
+	DiyFp low = MultiplyDiyFp(lower, power);
+
+	// The products may be off by one unit, so the digits are
+	// found in the interval widened by it, and kept only when
+	// they hold whichever way the error goes
+	int length;
+	int exponent = k;
+	high.f++;
+	low.f--;
+	if (!GenerateDigits(w, high, high.f - low.f, 1, digits, &length, &exponent)){
+		// Else the interval narrowed by it holds only what
+		// surely reads back, which is shortened from there
+		high.f -= 2;
+		low.f += 2;
+		exponent = k;
+		GenerateDigits(w, high, high.f - low.f, 0, digits, &length, &exponent);
+		length = ShortenDigits(digits, length, &exponent, ldexp((double) v.f, v.e), significandBits);
+	}
+	return negative + PlaceDecimalPoint(digits, length, exponent);
+}
+
+int FormatSpecial(double value, char* buffer){
+	if (value != value) strcpy(buffer, "nan");
+	else strcpy(buffer, value < 0 ? "-inf" : "inf");
+	return (int) strlen(buffer);
+}
+
+/**
+ * The upper 64 bits of the product, rounded
+ */
+DiyFp MultiplyDiyFp(DiyFp a, DiyFp b){
+	unsigned __int128 product = (unsigned __int128) a.f * b.f;
+	uint64_t high = (uint64_t) (product >> 64);
+	uint64_t low = (uint64_t) product;
+	return (DiyFp) {high + (low >> 63), a.e + b.e + 64};
+}
+
+DiyFp NormalizeDiyFp(DiyFp value){
+	int shift = __builtin_clzl(value.f);
+	return (DiyFp) {value.f << shift, value.e - shift};
+}
+
+/**
+ * The cached power c = 10^-k that brings a value with binary
+ * exponent e into [2^-60, 2^-32] times 2^64 once multiplied
+ */
+DiyFp GetCachedPower(int e, int* k){
+	double dk = (-61 - e) * 0.30102999566398114 + 347;
+	int power = (int) dk;
+	if (dk - power > 0.0) power++;
+
+	int index = (power >> 3) + 1;
+	*k = -(-348 + index * 8);
+	return (DiyFp) {CachedPowersF[index], CachedPowersE[index]};
+}
+
+/**
+ * Write the digits of upper, from the most significant, until
+ * what is left is within delta of it: the digits then name a
+ * value in the interval. k is raised by the digits not
+ * written. upper, delta and w may each be off by unit, and
+ * the result is whether the digits are surely the shortest
+ * in the interval and the closest of those to w.
+ */
+bool GenerateDigits(DiyFp w, DiyFp upper, uint64_t delta, uint64_t unit, char* buffer, int* length, int* k){
+	DiyFp one = {1UL << -upper.e, upper.e};
+	uint64_t distance = upper.f - w.f;
+	uint32_t integral = (uint32_t) (upper.f >> -one.e);
+	uint64_t fraction = upper.f & (one.f - 1);
+	*length = 0;
+
+	int kappa = 1;
+	while (kappa < 10 && integral >= PowersOfTen64[kappa]) kappa++;
+	while (kappa > 0){
+		uint32_t divisor = (uint32_t) PowersOfTen64[kappa - 1];
+		uint32_t digit = integral / divisor;
+		integral %= divisor;
+		if (digit != 0 || *length != 0) buffer[(*length)++] = (char) ('0' + digit);
+		kappa--;
+
+		uint64_t rest = ((uint64_t) integral << -one.e) + fraction;
+		if (rest < delta){
+			*k += kappa;
+			return RoundDigits(buffer, *length, delta, rest, (uint64_t) divisor << -one.e, distance, unit);
+		}
+	}
+
+	while (true){
+		fraction *= 10;
+		delta *= 10;
+		distance *= 10;
+		unit *= 10;
+		char digit = (char) (fraction >> -one.e);
+		if (digit != 0 || *length != 0) buffer[(*length)++] = (char) ('0' + digit);
+		fraction &= one.f - 1;
+		kappa--;
+		if (fraction < delta){
+			*k += kappa;
+			return RoundDigits(buffer, *length, delta, fraction, one.f, distance, unit);
+		}
+	}
+}
+
+/**
+ * Lower the last digit while that stays in the interval and
+ * moves closer to the value itself, distance below upper. The
+ * digits are vouched for when, with distance off by unit
+ * either way, no other choice would be closer, and they are
+ * clear of the interval's ends by the error.
+ */
+bool RoundDigits(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance, uint64_t unit){
+	uint64_t nearest = distance - unit;
+	uint64_t farthest = distance + unit;
+	while (rest < nearest && delta - rest >= tenKappa &&
+		(rest + tenKappa < nearest || nearest - rest >= rest + tenKappa - nearest)){
+		buffer[length - 1]--;
+		rest += tenKappa;
+	}
+	if (rest < farthest && delta - rest >= tenKappa &&
+		(rest + tenKappa < farthest || farthest - rest > rest + tenKappa - farthest)) return false;
+	return 2 * unit <= rest && rest <= delta - 4 * unit;
+}
+
+/**
+ * The exact way, for the few values Grisu3 cannot vouch for:
+ * digits * 10^k read back as value, and are cut a digit at a
+ * time, rounded down or up, while that still reads back. One
+ * of the two does whenever any shorter digits would, so what
+ * is left is the shortest. Returns the length.
+ */
+int ShortenDigits(char* digits, int length, int* k, double value, int significandBits){
+	while (length > 1){
+		char up[FORMAT_BUFFER_SIZE];
+		int spot = length - 2;
+		while (spot >= 0 && digits[spot] == '9') spot--;
+		if (spot >= 0) memcpy(up, digits, spot + 1);
+		up[spot < 0 ? 0 : spot] = spot < 0 ? '1' : (char) (digits[spot] + 1);
+		int upLength = spot < 0 ? 1 : spot + 1;
+		int upK = *k + length - 1 - spot;
+
+		bool downReads = ReadDigits(digits, length - 1, *k + 1, significandBits) == value;
+		bool upReads = ReadDigits(up, upLength, upK, significandBits) == value;
+		if (!downReads && !upReads) break;
+
+		// When both do, the closer is on value's side of halfway
+		digits[length - 1] = '5';
+		if (upReads && (!downReads || ReadDigits(digits, length, *k, significandBits) < value)){
+			memcpy(digits, up, upLength);
+			length = upLength;
+			*k = upK;
+		}
+		else {
+			length--;
+			(*k)++;
+		}
+	}
+	return length;
+}
+
+/**
+ * digits * 10^k read as a double, or as a float when there
+ * are its 23 significand bits, rounded correctly by libc
+ */
+double ReadDigits(char* digits, int length, int k, int significandBits){
+	char text[FORMAT_BUFFER_SIZE];
+	memcpy(text, digits, length);
+	text[length] = 'e';
+	FormatLong(k, &text[length + 1]);
+	if (significandBits == 23) return strtof(text, NULL);
+	return strtod(text, NULL);
+}
+
+/**
+ * Turn the digits, which stand for digits * 10^k, into plain
+ * decimal notation when the point is at most 21 places left
+ * and 6 places right of them, and into 1.5e30 style otherwise
+ */
+int PlaceDecimalPoint(char* buffer, int length, int k){
+	int point = length + k;
+	if (k >= 0 && point <= 21){
+		for (int i = length; i < point; i++) buffer[i] = '0';
+		buffer[point] = '.';
+		buffer[point + 1] = '0';
+		buffer[point + 2] = '\0';
+		return point + 2;
+	}
+	if (point > 0 && point <= 21){
+		memmove(&buffer[point + 1], &buffer[point], length - point);
+		buffer[point] = '.';
+		buffer[length + 1] = '\0';
+		return length + 1;
+	}
+	if (point > -6 && point <= 0){
+		int offset = 2 - point;
+		memmove(&buffer[offset], &buffer[0], length);
+		buffer[0] = '0';
+		buffer[1] = '.';
+		for (int i = 2; i < offset; i++) buffer[i] = '0';
+		buffer[length + offset] = '\0';
+		return length + offset;
+	}
+	if (length == 1){
+		buffer[1] = 'e';
+		return 2 + WriteExponent(point - 1, &buffer[2]);
+	}
+	memmove(&buffer[2], &buffer[1], length - 1);
+	buffer[1] = '.';
+	buffer[length + 1] = 'e';
+	return length + 2 + WriteExponent(point - 1, &buffer[length + 2]);
+}
+
+int WriteExponent(int exponent, char* buffer){
+	return FormatLong(exponent, buffer);
+}
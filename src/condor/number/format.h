@@ -0,0 +1,60 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Number formatting without printf. Integers are written two
+ * digits at a time. Doubles and floats are written with the
+ * fewest digits that read back as the same value, found with
+ * Grisu3 (Loitsch, "Printing Floating-Point Numbers Quickly
+ * and Accurately with Integers"): the value and the bounds of
+ * the interval that rounds to it are scaled by a cached power
+ * of ten in 64 bit fixed point, and digits are produced until
+ * the result is inside the interval. For the one value in a
+ * few hundred where the fixed point error leaves that in
+ * doubt, the digits are shortened one at a time and checked
+ * by reading them back.
+ *
+ * Every routine writes into a caller's buffer of at least
+ * FORMAT_BUFFER_SIZE characters, ends it with a NUL and
+ * returns the length.
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define FORMAT_BUFFER_SIZE 32
+
+/**
+ * A floating point value as an integer significand and a
+ * binary exponent, f * 2^e
+ */
+typedef struct DiyFp {
+	uint64_t f;
+	int e;
+} DiyFp;
+
+int FormatLong(long value, char* buffer);
+int FormatDouble(double value, char* buffer);
+int FormatFloat(float value, char* buffer);
+
+/**
+ * Private Functions
+ */
+int FormatShortest(DiyFp value, int significandBits, bool negative, char* buffer);
+int FormatSpecial(double value, char* buffer);
+DiyFp MultiplyDiyFp(DiyFp a, DiyFp b);
+DiyFp NormalizeDiyFp(DiyFp value);
+DiyFp GetCachedPower(int e, int* k);
+bool GenerateDigits(DiyFp w, DiyFp upper, uint64_t delta, uint64_t unit, char* buffer, int* length, int* k);
+bool RoundDigits(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance, uint64_t unit);
+int ShortenDigits(char* digits, int length, int* k, double value, int significandBits);
+double ReadDigits(char* digits, int length, int k, int significandBits);
+int PlaceDecimalPoint(char* buffer, int length, int k);
+int WriteExponent(int exponent, char* buffer);
+
+#endif // FORMAT_H_
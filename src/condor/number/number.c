@@ -1,54 +1,123 @@
-#include "number.h"
-
-void SetNumberType(ASTNode* node, char* value){
-	if (node == NULL) return;
-	
-	double val = atof(value);
-
-	bool hasDecimal = false;
-	int len = strlen(value);
-
-	for (int i = 0; i < len; i++){
-		if (value[i] == '.') {
-			hasDecimal = true;
-			break;
-		}
-	}
-
-	// Check for decimal
-	if (val == 0 || val == 1) {
-		node->meta.booleanExpr.value = (bool) val;
-		node->type = BOOLEAN;
-	}
-	else if (!hasDecimal){
-		if (val < CHAR_MAX && val > CHAR_MIN) {
-			node->meta.byteExpr.value = (signed char) val;
-			node->type = BYTE;
-		}
-		else if (val < SHRT_MAX && val > SHRT_MIN) {
-			node->meta.shortExpr.value = (short) val;
-			node->type = SHORT;
-		}
-		else if (val < INT_MAX && val > INT_MIN) {
-			node->meta.intExpr.value = (int) val;
-			node->type = INT;
-		}
-		else if (val < LONG_MAX && val > LONG_MIN) {
-			node->meta.longExpr.value = (long) val;
-			node->type = LONG;
-		}
-	}
-	else{
-		if (val < FLT_MAX && val > -FLT_MAX){
-			node->meta.floatExpr.value = (float) val;
-			node->type = FLOAT;
-		}
-		else if (val < DBL_MAX && val > -DBL_MAX){
-			node->meta.doubleExpr.value = (double) val;
-			node->type = DOUBLE;
-		}
-		else{
-			NOT_IMPLEMENTED("Other Numer Type");
-		}
-	}
-}
\ No newline at end of file
+#include "number.h"
+
+/**
+ * Literals take the default widths, a long for an integer and
+ * a double for a decimal, whatever their value. A declaration
+ * with a narrower type converts them. An integer too large
+ * for a long is held as a double. value is a view of length
+ * characters into the source, it need not end in a NUL.
+ */
+void SetNumberType(ASTNode* node, char* value, int length){
+	if (node == NULL) return;
+
+	long integer;
+	if (ParseLongLiteral(value, length, &integer)){
+		node->meta.longExpr.value = integer;
+		node->type = LONG;
+		return;
+	}
+
+	node->meta.doubleExpr.value = ParseDoubleLiteral(value, length);
+	node->type = DOUBLE;
+}
+
+/**
+ * Read the digits of an integer literal, false when it has a
+ * decimal point or does not fit a long
+ */
+bool ParseLongLiteral(char* value, int length, long* result){
+	long total = 0;
+	for (int i = 0; i < length; i++){
+		int digit = value[i] - '0';
+		if (digit < 0 || digit > 9) return false;
+		if (__builtin_mul_overflow(total, 10, &total)) return false;
+		if (__builtin_add_overflow(total, digit, &total)) return false;
+	}
+	*result = total;
+	return length > 0;
+}
+
+/**
+ * Powers of ten a double holds exactly
+ */
+const double ExactPowersOfTen[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Read a decimal literal, correctly rounded. When the digits
+ * fit in 53 bits and there are at most 22 after the point,
+ * both the digits and the power of ten are exact doubles, so
+ * one division rounds the same way the exact quotient would
+ * (Clinger's fast path). Longer literals are left to strtod.
+ * Reading stops at a second decimal point, as strtod's does.
+ */
+double ParseDoubleLiteral(char* value, int length){
+	unsigned long digits = 0;
+	int significant = 0;
+	int scale = 0;
+	bool point = false;
+	int end = 0;
+	for (; end < length; end++){
+		char c = value[end];
+		if (c == '.'){
+			if (point) break;
+			point = true;
+			continue;
+		}
+		if (c < '0' || c > '9') break;
+		if (digits != 0 || c != '0') significant++;
+		if (significant > 19) continue;
+		digits = digits * 10 + (unsigned long) (c - '0');
+		if (point) scale++;
+	}
+
+	if (significant <= 19 && digits <= (1UL << 53) && scale <= 22){
+		return (double) digits / ExactPowersOfTen[scale];
+	}
+
+	char buffer[64];
+	char* copy = end < (int) sizeof(buffer) ? buffer : Allocate(end + 1);
+	memcpy(copy, value, end);
+	copy[end] = '\0';
+	double result = strtod(copy, NULL);
+	if (copy != buffer) Free(copy);
+	return result;
+}
+
+bool IsIntegerType(Token type){
+	return type == BOOLEAN ||
+		type == BYTE ||
+		type == SHORT ||
+		type == INT ||
+		type == LONG;
+}
+
+/**
+ * Bits in an integer type, 0 for the other types
+ */
+int GetIntegerWidth(Token type){
+	int t = (int) type;
+	switch (t){
+		case BOOLEAN: return 1;
+		case BYTE: return 8;
+		case SHORT: return 16;
+		case INT: return 32;
+		case LONG: return 64;
+	}
+	return 0;
+}
+
+/**
+ * The type both operands of a math operator are widened to.
+ * Follows the usual C promotions: anything smaller than int
+ * becomes int, long dominates the integers, and any floating
+ * point operand makes the result floating point.
+ */
+Token GetPromotedType(Token left, Token right){
+	if (left == DOUBLE || right == DOUBLE) return DOUBLE;
+	if (left == FLOAT || right == FLOAT) return FLOAT;
+	if (left == LONG || right == LONG) return LONG;
+	return INT;
+}
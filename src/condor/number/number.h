@@ -1,22 +1,26 @@
-// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
-// Use of this source code is governed by a BSD-style
-// license that can be found in the LICENSE file.
-
-#ifndef NUMBER_H_
-#define NUMBER_H_
-
-#include <stdbool.h>
-#include <math.h>
-#include <string.h>
-#include <stdlib.h>
-#include <stdio.h> // for not_implemented function
-#include <limits.h>
-#include <float.h>
-
-#include "condor/token/token.h"
-#include "utils/assert.h"
-#include "condor/ast/ast.h"
-
-void SetNumberType(ASTNode* node, char* value);
-
-#endif // NUMBER_H_
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef NUMBER_H_
+#define NUMBER_H_
+
+#include <stdbool.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h> // for not_implemented function
+
+#include "condor/token/token.h"
+#include "utils/assert.h"
+#include "condor/ast/ast.h"
+#include "condor/mem/allocate.h"
+
+void SetNumberType(ASTNode* node, char* value, int length);
+bool ParseLongLiteral(char* value, int length, long* result);
+double ParseDoubleLiteral(char* value, int length);
+bool IsIntegerType(Token type);
+int GetIntegerWidth(Token type);
+Token GetPromotedType(Token left, Token right);
+
+#endif // NUMBER_H_
@@ -0,0 +1,430 @@
+#include "optimizer-cse.h"
+
+#define NODE_INDEX(table, node) ((int) ((node) - (table)->scope->nodes))
+
+/**
+ * Share identical expressions, returning how many nodes were
+ * dropped. Each body's statements are walked in source order,
+ * the order the runner uses, and a block ends at every
+ * statement that loops, branches, calls or returns.
+ */
+int EliminateCommonSubexpressions(Scope* scope){
+	HashConsTable table;
+	InitHashConsTable(&table, scope);
+
+	int totalScopes = scope->scopeLength + 2;
+	int* scopeStarts = Allocate(sizeof(int) * (totalScopes + 1));
+	ASTNode** statements = Allocate(sizeof(ASTNode*) * scope->nodeLength);
+	for (int i = 0; i <= totalScopes; i++){
+		scopeStarts[i] = 0;
+	}
+
+	// Group the statements by scope id, keeping source order
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->isStmt && node->scopeId > 0) scopeStarts[node->scopeId + 1]++;
+	}
+	for (int i = 1; i <= totalScopes; i++){
+		scopeStarts[i] += scopeStarts[i - 1];
+	}
+	int spot[totalScopes];
+	for (int i = 0; i < totalScopes; i++){
+		spot[i] = scopeStarts[i];
+	}
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->isStmt && node->scopeId > 0) statements[spot[node->scopeId]++] = node;
+	}
+
+	for (int scopeId = 1; scopeId < totalScopes; scopeId++){
+		EndBlock(&table);
+		for (int i = scopeStarts[scopeId]; i < scopeStarts[scopeId + 1]; i++){
+			HashConsStatement(&table, statements[i]);
+		}
+	}
+
+	int removed = table.removed;
+	Free(scopeStarts);
+	Free(statements);
+	DestroyHashConsTable(&table);
+	return removed;
+}
+
+void InitHashConsTable(HashConsTable* table, Scope* scope){
+	table->scope = scope;
+	table->capacity = 16;
+	while (table->capacity < scope->nodeLength * 2) table->capacity *= 2;
+	table->entries = Allocate(sizeof(HashConsEntry) * table->capacity);
+	table->lastWrite = Allocate(sizeof(int) * scope->nodeLength);
+	table->pinned = Allocate(sizeof(bool) * scope->nodeLength);
+	table->latestWrite = Allocate(sizeof(int) * scope->nodeLength);
+	table->latestAt = Allocate(sizeof(int) * scope->nodeLength);
+	table->block = 0;
+	table->statementCount = 0;
+	table->statement = NULL;
+	table->removed = 0;
+	InitWorkStack(&table->stack);
+	InitWorkStack(&table->walk);
+	InitWorkStack(&table->writes);
+
+	for (int i = 0; i < table->capacity; i++){
+		table->entries[i].node = NULL;
+	}
+	for (int i = 0; i < scope->nodeLength; i++){
+		table->lastWrite[i] = -1;
+		table->pinned[i] = false;
+		table->latestAt[i] = -1;
+	}
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->type == VAR && GET_VAR_VALUE(node) != NULL){
+			table->pinned[NODE_INDEX(table, GET_VAR_VALUE(node))] = true;
+		}
+	}
+}
+
+void DestroyHashConsTable(HashConsTable* table){
+	DestroyWorkStack(&table->stack);
+	DestroyWorkStack(&table->walk);
+	DestroyWorkStack(&table->writes);
+	Free(table->entries);
+	Free(table->lastWrite);
+	Free(table->pinned);
+	Free(table->latestWrite);
+	Free(table->latestAt);
+}
+
+/**
+ * Share the statement's expressions with the earlier ones in
+ * its block, then record what it writes
+ */
+void HashConsStatement(HashConsTable* table, ASTNode* node){
+	table->statement = node;
+	table->statementCount++;
+
+	int type = (int) node->type;
+	switch (type){
+		case FUNC: return; // Nothing runs until it is called
+		case FOR:
+		case WHILE:
+		case CASE:
+		case BREAK:
+		case FUNC_CALL: {
+			EndBlock(table);
+			return;
+		}
+		case INC:
+		case DEC: {
+			table->lastWrite[NODE_INDEX(table, GET_ASSIGN_VAR(node))] = table->statementCount;
+			return;
+		}
+		case VAR: {
+			if (HasSideEffects(table, GET_VAR_VALUE(node))) break;
+			SET_VAR_VALUE(node, HashConsExpression(table, GET_VAR_VALUE(node)));
+			table->lastWrite[NODE_INDEX(table, node)] = table->statementCount;
+			return;
+		}
+		case BINARY: {
+			if (HasSideEffects(table, node)) break;
+			HashConsExpression(table, node);
+			return;
+		}
+
+		// The block ends once these have read their value
+		case RETURN: {
+			if (!HasSideEffects(table, GET_RETURN_VALUE(node))){
+				SET_RETURN_VALUE(node, HashConsExpression(table, GET_RETURN_VALUE(node)));
+			}
+			break;
+		}
+		case IF: {
+			if (!HasSideEffects(table, GET_IF_CONDITION(node))){
+				SET_IF_CONDITION(node, HashConsExpression(table, GET_IF_CONDITION(node)));
+			}
+			break;
+		}
+		case SWITCH: {
+			if (!HasSideEffects(table, GET_SWITCH_CONDITION(node))){
+				SET_SWITCH_CONDITION(node, HashConsExpression(table, GET_SWITCH_CONDITION(node)));
+			}
+			break;
+		}
+		default: {
+			if (!IsAssignment(node->type) || HasSideEffects(table, GET_ASSIGN_VALUE(node))) break;
+			SET_ASSIGN_VALUE(node, HashConsExpression(table, GET_ASSIGN_VALUE(node)));
+			table->lastWrite[NODE_INDEX(table, GET_ASSIGN_VAR(node))] = table->statementCount;
+			return;
+		}
+	}
+	EndBlock(table);
+}
+
+/**
+ * Bottom up on the table's work stack: a binary's operands
+ * are interned once their own operands have been. An operand
+ * that may be skipped by && or || is shared but never added,
+ * so a value is only reused after it has surely been computed.
+ */
+ASTNode* HashConsExpression(HashConsTable* table, ASTNode* node){
+	if (node == NULL) return NULL;
+
+	WorkStack* stack = &table->stack;
+	if (node->type == BINARY) PushWork(stack, node, 0, 0);
+	while (!IS_WORK_STACK_EMPTY(stack)){
+		WorkItem work = PopWork(stack);
+		ASTNode* binary = work.node;
+		ASTList* operands = GET_BIN_OPERANDS(binary);
+		bool shortCircuit = GET_BIN_OP(binary) == LAND || GET_BIN_OP(binary) == LOR;
+		bool conditional = work.value;
+
+		if (work.state == 0){
+			PushWork(stack, binary, 1, conditional);
+			if (operands != NULL){
+				FOREACH_AST(operands){
+					bool skipped = conditional || (shortCircuit && item->prev != NULL);
+					if (item->node->type == BINARY) PushWork(stack, item->node, 0, skipped);
+				}
+				continue;
+			}
+			if (GET_BIN_LEFT(binary)->type == BINARY) PushWork(stack, GET_BIN_LEFT(binary), 0, conditional);
+			if (GET_BIN_RIGHT(binary)->type == BINARY) PushWork(stack, GET_BIN_RIGHT(binary), 0, conditional || shortCircuit);
+			continue;
+		}
+
+		if (operands != NULL){
+			FOREACH_AST(operands){
+				item->node = InternNode(table, item->node, conditional || (shortCircuit && item->prev != NULL));
+			}
+			continue;
+		}
+		SET_BINARY_LEFT(binary, InternNode(table, GET_BIN_LEFT(binary), conditional));
+		SET_BINARY_RIGHT(binary, InternNode(table, GET_BIN_RIGHT(binary), conditional || shortCircuit));
+	}
+
+	// A statement keeps its own node
+	if (node->isStmt) return node;
+	return InternNode(table, node, false);
+}
+
+/**
+ * The node the block already has for this expression, or the
+ * node itself, which is added unless it may not run. A copy
+ * that is replaced is dropped.
+ */
+ASTNode* InternNode(HashConsTable* table, ASTNode* node, bool conditional){
+	if (node->type != BINARY && !IsNumber(node->type)) return node;
+
+	int mask = table->capacity - 1;
+	int slot = -1;
+	int i = HashNode(table, node) & mask;
+	for (; table->entries[i].node != NULL; i = (i + 1) & mask){
+		HashConsEntry* entry = &table->entries[i];
+		if (entry->block != table->block){
+			if (slot < 0) slot = i;
+			continue;
+		}
+		if (!IsSameNode(entry->node, node)) continue;
+		if (entry->node == node) return node;
+
+		// Something it reads was written since, start over
+		if (!IsEntryValid(table, entry)){
+			slot = i;
+			break;
+		}
+
+		ASTNode* shared = entry->node;
+		DEBUG_PRINT2("Shared", TokenToString(shared->type == BINARY ? GET_BIN_OP(shared) : shared->type));
+		if (shared->type == BINARY && entry->statement != table->statement){
+			SET_BINARY_OWNER(shared, entry->statement);
+		}
+		if (!table->pinned[NODE_INDEX(table, node)]){
+			RemoveNode(node);
+			table->removed++;
+		}
+		return shared;
+	}
+
+	if (conditional) return node;
+	if (slot < 0) slot = i;
+	HashConsEntry* entry = &table->entries[slot];
+	entry->node = node;
+	entry->statement = table->statement;
+	entry->block = table->block;
+	entry->since = table->statementCount;
+	return node;
+}
+
+/**
+ * Operands are already interned, so a binary hashes on their
+ * node indexes rather than on their contents
+ */
+unsigned int HashNode(HashConsTable* table, ASTNode* node){
+	unsigned int hash = (unsigned int) node->type * 2654435761u;
+	if (node->type != BINARY){
+		unsigned long bits = (unsigned long) GetLiteralBits(node);
+		return hash ^ (unsigned int) (bits * 11400714819323198485ul >> 32);
+	}
+
+	hash = hash * 31 + GET_BIN_OP(node);
+	if (GET_BIN_OPERANDS(node) != NULL){
+		FOREACH_AST(GET_BIN_OPERANDS(node)){
+			hash = hash * 31 + NODE_INDEX(table, item->node);
+		}
+		return hash * 2654435761u;
+	}
+	hash = hash * 31 + NODE_INDEX(table, GET_BIN_LEFT(node));
+	hash = hash * 31 + NODE_INDEX(table, GET_BIN_RIGHT(node));
+	return hash * 2654435761u;
+}
+
+bool IsSameNode(ASTNode* a, ASTNode* b){
+	if (a->type != b->type) return false;
+	if (a->type != BINARY) return GetLiteralBits(a) == GetLiteralBits(b);
+	if (GET_BIN_OP(a) != GET_BIN_OP(b) || GET_BIN_SHIFT(a) != GET_BIN_SHIFT(b)) return false;
+
+	ASTList* left = GET_BIN_OPERANDS(a);
+	ASTList* right = GET_BIN_OPERANDS(b);
+	if (left == NULL || right == NULL){
+		if (left != right) return false;
+		return GET_BIN_LEFT(a) == GET_BIN_LEFT(b) && GET_BIN_RIGHT(a) == GET_BIN_RIGHT(b);
+	}
+
+	ASTListItem* other = right->first;
+	FOREACH_AST(left){
+		if (other == NULL || other->node != item->node) return false;
+		other = other->next;
+	}
+	return other == NULL;
+}
+
+/**
+ * A literal's value as raw bits, so floating point values
+ * compare exactly: 0.0 and -0.0 stay apart
+ */
+long GetLiteralBits(ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case BOOLEAN: return GET_BOOLEAN_VALUE(node);
+		case BYTE: return GET_BYTE_VALUE(node);
+		case SHORT: return GET_SHORT_VALUE(node);
+		case INT: return GET_INT_VALUE(node);
+		case LONG: return GET_LONG_VALUE(node);
+		case FLOAT: {
+			int bits;
+			float value = GET_FLOAT_VALUE(node);
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+		case DOUBLE: {
+			long bits;
+			double value = GET_DOUBLE_VALUE(node);
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Whether no variable the node reads was written since it
+ * was added
+ */
+bool IsEntryValid(HashConsTable* table, HashConsEntry* entry){
+	return GetLatestWrite(table, entry->node) < entry->since;
+}
+
+/**
+ * The statement count of the last write to a variable the
+ * node reads, -1 when none was written. Writes only happen
+ * between statements, so each binary keeps its answer for the
+ * rest of the statement: looking up every level of a long
+ * expression walks it once, not once per level.
+ */
+int GetLatestWrite(HashConsTable* table, ASTNode* node){
+	WorkStack* walk = &table->walk;
+	WorkStack* writes = &table->writes;
+	PushWork(walk, node, 0, 0);
+	while (!IS_WORK_STACK_EMPTY(walk)){
+		WorkItem work = PopWork(walk);
+		node = work.node;
+		int index = NODE_INDEX(table, node);
+		if (node->type == VAR){
+			PushWork(writes, NULL, 0, table->lastWrite[index]);
+			continue;
+		}
+		if (node->type != BINARY){
+			PushWork(writes, NULL, 0, -1);
+			continue;
+		}
+		if (work.state == 0 && table->latestAt[index] == table->statementCount){
+			PushWork(writes, NULL, 0, table->latestWrite[index]);
+			continue;
+		}
+
+		if (work.state == 0){
+			ASTList* operands = GET_BIN_OPERANDS(node);
+			int count = 2;
+			if (operands != NULL){
+				count = 0;
+				FOREACH_AST(operands) count++;
+			}
+			PushWork(walk, node, 1, count);
+			if (operands != NULL){
+				FOREACH_AST(operands){
+					PushWork(walk, item->node, 0, 0);
+				}
+			}
+			else {
+				PushWork(walk, GET_BIN_LEFT(node), 0, 0);
+				PushWork(walk, GET_BIN_RIGHT(node), 0, 0);
+			}
+			continue;
+		}
+
+		int latest = -1;
+		for (int i = writes->length - work.value; i < writes->length; i++){
+			if (writes->items[i].value > latest) latest = writes->items[i].value;
+		}
+		writes->length -= work.value;
+		table->latestWrite[index] = latest;
+		table->latestAt[index] = table->statementCount;
+		PushWork(writes, NULL, 0, latest);
+	}
+	return PopWork(writes).value;
+}
+
+/**
+ * Calls and increments inside an expression end the block,
+ * they may write what other expressions read
+ */
+bool HasSideEffects(HashConsTable* table, ASTNode* node){
+	if (node == NULL) return false;
+	WorkStack* stack = &table->stack;
+	PushWork(stack, node, 0, 0);
+	while (!IS_WORK_STACK_EMPTY(stack)){
+		node = PopWork(stack).node;
+		if (node->type == FUNC_CALL || node->type == INC || node->type == DEC){
+			stack->length = 0;
+			return true;
+		}
+		if (node->type != BINARY) continue;
+
+		if (GET_BIN_OPERANDS(node) != NULL){
+			FOREACH_AST(GET_BIN_OPERANDS(node)){
+				PushWork(stack, item->node, 0, 0);
+			}
+		}
+		else {
+			PushWork(stack, GET_BIN_LEFT(node), 0, 0);
+			PushWork(stack, GET_BIN_RIGHT(node), 0, 0);
+		}
+	}
+	return false;
+}
+
+/**
+ * Nothing added so far can be shared past this point
+ */
+void EndBlock(HashConsTable* table){
+	table->block++;
+}
@@ -0,0 +1,69 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Common subexpression elimination. Within a basic block, a
+ * run of statements with no control flow or calls between
+ * them, expressions are hash-consed by (type, op, operands):
+ * identical binaries and literals share one node. A binary
+ * shared by several statements is computed once, by the first
+ * of them, as long as nothing it reads is written in between.
+ */
+
+#ifndef OPTIMIZER_CSE_H_
+#define OPTIMIZER_CSE_H_
+
+#include <string.h>
+#include "utils/assert.h"
+#include "utils/debug.h"
+#include "condor/ast/scope.h"
+#include "condor/ast/ast.h"
+#include "condor/ast/astlist.h"
+#include "condor/ast/workstack.h"
+#include "condor/mem/allocate.h"
+#include "condor/token/token.h"
+#include "condor/optimizer/optimizer-dead.h"
+
+/**
+ * A node in the table, and where it was first seen
+ */
+typedef struct HashConsEntry {
+	ASTNode* node;
+	ASTNode* statement;
+	int block; // Entries from an earlier block are stale
+	int since; // Statement count when the node was added
+} HashConsEntry;
+
+typedef struct HashConsTable {
+	Scope* scope;
+	HashConsEntry* entries;
+	int capacity; // A power of two, at least twice the nodes
+	int* lastWrite; // By node index, statement count of a variable's last write
+	bool* pinned; // By node index, values of variables, never removed
+	int* latestWrite; // By node index, see GetLatestWrite
+	int* latestAt; // By node index, the statement count latestWrite is for
+	int block;
+	int statementCount;
+	ASTNode* statement;
+	int removed;
+	WorkStack stack;
+	WorkStack walk;
+	WorkStack writes;
+} HashConsTable;
+
+int EliminateCommonSubexpressions(Scope* scope);
+void InitHashConsTable(HashConsTable* table, Scope* scope);
+void DestroyHashConsTable(HashConsTable* table);
+void HashConsStatement(HashConsTable* table, ASTNode* node);
+ASTNode* HashConsExpression(HashConsTable* table, ASTNode* node);
+ASTNode* InternNode(HashConsTable* table, ASTNode* node, bool conditional);
+unsigned int HashNode(HashConsTable* table, ASTNode* node);
+bool IsSameNode(ASTNode* a, ASTNode* b);
+long GetLiteralBits(ASTNode* node);
+bool IsEntryValid(HashConsTable* table, HashConsEntry* entry);
+int GetLatestWrite(HashConsTable* table, ASTNode* node);
+bool HasSideEffects(HashConsTable* table, ASTNode* node);
+void EndBlock(HashConsTable* table);
+
+#endif // OPTIMIZER_CSE_H_
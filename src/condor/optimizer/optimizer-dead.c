@@ -0,0 +1,438 @@
+#include "optimizer-dead.h"
+
+#define NODE_INDEX(dce, node) ((int) ((node) - (dce)->scope->nodes))
+
+// WalkStatement item states, a variable is either read or declared
+#define WALK_REFERENCE 0
+#define WALK_ROOT 1
+
+/**
+ * Run the pass and add what it dropped to the report
+ */
+void EliminateDeadCode(Scope* scope, DeadCodeReport* report){
+	DeadCodeEliminator dce;
+	InitDeadCodeEliminator(&dce, scope);
+	FindReachableStatements(&dce);
+	FindLiveCode(&dce);
+	RemoveUnreadVars(&dce, report);
+	SweepDeadCode(&dce, report);
+	DestroyDeadCodeEliminator(&dce);
+}
+
+void InitDeadCodeEliminator(DeadCodeEliminator* dce, Scope* scope){
+	int length = scope->nodeLength;
+	dce->scope = scope;
+	dce->totalScopes = scope->scopeLength + 2;
+	dce->marking = false;
+	dce->reachable = Allocate(sizeof(bool) * length);
+	dce->live = Allocate(sizeof(bool) * length);
+	dce->removed = Allocate(sizeof(bool) * length);
+	dce->marked = Allocate(sizeof(bool) * length);
+	dce->reads = Allocate(sizeof(int) * length);
+	dce->nextAssign = Allocate(sizeof(int) * length);
+	dce->firstAssign = Allocate(sizeof(int) * length);
+	dce->statements = Allocate(sizeof(ASTNode*) * length);
+	dce->liveScopes = Allocate(sizeof(bool) * dce->totalScopes);
+	dce->owners = Allocate(sizeof(ASTNode*) * dce->totalScopes);
+	dce->scopeStarts = Allocate(sizeof(int) * (dce->totalScopes + 1));
+	InitWorkStack(&dce->stack);
+	InitWorkStack(&dce->scopeQueue);
+
+	for (int i = 0; i < length; i++){
+		dce->reachable[i] = false;
+		dce->live[i] = false;
+		dce->removed[i] = false;
+		dce->marked[i] = false;
+		dce->reads[i] = 0;
+		dce->nextAssign[i] = -1;
+		dce->firstAssign[i] = -1;
+	}
+	for (int i = 0; i < dce->totalScopes; i++){
+		dce->liveScopes[i] = false;
+		dce->owners[i] = NULL;
+	}
+
+	// Which statement each body belongs to
+	for (int i = 0; i < length; i++){
+		ASTNode* node = &scope->nodes[i];
+		int type = (int) node->type;
+		switch (type){
+			case FOR: dce->owners[GET_FOR_BODY(node)] = node; break;
+			case WHILE: dce->owners[GET_WHILE_BODY(node)] = node; break;
+			case IF: dce->owners[GET_IF_BODY(node)] = node; break;
+			case SWITCH: dce->owners[GET_SWITCH_BODY(node)] = node; break;
+			case CASE: dce->owners[GET_CASE_BODY(node)] = node; break;
+			case FUNC: dce->owners[GET_FUNC_BODY(node)] = node; break;
+		}
+	}
+
+	GroupStatements(scope, dce->statements, dce->scopeStarts, dce->totalScopes);
+}
+
+void DestroyDeadCodeEliminator(DeadCodeEliminator* dce){
+	DestroyWorkStack(&dce->stack);
+	DestroyWorkStack(&dce->scopeQueue);
+	Free(dce->reachable);
+	Free(dce->live);
+	Free(dce->removed);
+	Free(dce->marked);
+	Free(dce->reads);
+	Free(dce->nextAssign);
+	Free(dce->firstAssign);
+	Free(dce->statements);
+	Free(dce->liveScopes);
+	Free(dce->owners);
+	Free(dce->scopeStarts);
+}
+
+/**
+ * A statement after a return, or after a break outside of a
+ * switch body, can never run. Neither can an if or while
+ * whose condition folded to false.
+ */
+void FindReachableStatements(DeadCodeEliminator* dce){
+	for (int scopeId = 1; scopeId < dce->totalScopes; scopeId++){
+		ASTNode* owner = dce->owners[scopeId];
+		bool ended = false;
+		for (int i = dce->scopeStarts[scopeId]; i < dce->scopeStarts[scopeId + 1]; i++){
+			ASTNode* node = dce->statements[i];
+			if (ended) continue;
+			dce->reachable[NODE_INDEX(dce, node)] = true;
+
+			int type = (int) node->type;
+			switch (type){
+				case RETURN: ended = true; break;
+				case BREAK: ended = owner == NULL || owner->type != SWITCH; break;
+				case IF: case WHILE: {
+					ASTNode* condition = type == IF ? GET_IF_CONDITION(node) : GET_WHILE_CONDITION(node);
+					if (condition->type == BOOLEAN && !GET_BOOLEAN_VALUE(condition)){
+						dce->reachable[NODE_INDEX(dce, node)] = false;
+					}
+					break;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Walk outward from the global scope. A body is live when
+ * its statement is, and a function only once a live call
+ * reaches it.
+ */
+void FindLiveCode(DeadCodeEliminator* dce){
+	dce->liveScopes[1] = true;
+	PushWork(&dce->scopeQueue, NULL, 1, 0);
+
+	while (!IS_WORK_STACK_EMPTY(&dce->scopeQueue)){
+		int scopeId = PopWork(&dce->scopeQueue).state;
+		for (int i = dce->scopeStarts[scopeId]; i < dce->scopeStarts[scopeId + 1]; i++){
+			ASTNode* node = dce->statements[i];
+			if (!dce->reachable[NODE_INDEX(dce, node)] || node->type == FUNC) continue;
+			dce->live[NODE_INDEX(dce, node)] = true;
+			WalkStatement(dce, node);
+
+			int body = -1;
+			int type = (int) node->type;
+			switch (type){
+				case FOR: body = GET_FOR_BODY(node); break;
+				case WHILE: body = GET_WHILE_BODY(node); break;
+				case IF: body = GET_IF_BODY(node); break;
+				case SWITCH: body = GET_SWITCH_BODY(node); break;
+				case CASE: body = GET_CASE_BODY(node); break;
+			}
+			if (body > 0 && !dce->liveScopes[body]){
+				dce->liveScopes[body] = true;
+				PushWork(&dce->scopeQueue, NULL, body, 0);
+			}
+		}
+	}
+}
+
+/**
+ * Visit a statement's expressions. While finding live code
+ * this counts variable reads and follows calls; while
+ * sweeping it marks every node that is still referenced.
+ */
+void WalkStatement(DeadCodeEliminator* dce, ASTNode* node){
+	WorkStack* stack = &dce->stack;
+	PushWork(stack, node, WALK_ROOT, 0);
+
+	while (!IS_WORK_STACK_EMPTY(stack)){
+		WorkItem work = PopWork(stack);
+		node = work.node;
+		if (node == NULL) continue;
+
+		int index = NODE_INDEX(dce, node);
+		if (dce->marking){
+			if (dce->marked[index]) continue;
+			dce->marked[index] = true;
+		}
+
+		int type = (int) node->type;
+		switch (type){
+			case VAR: {
+				if (work.state == WALK_REFERENCE && !dce->marking){
+					dce->reads[index]++;
+					break;
+				}
+				PushWork(stack, GET_VAR_VALUE(node), WALK_REFERENCE, 0);
+				break;
+			}
+			case BINARY: {
+				if (GET_BIN_OPERANDS(node) != NULL){
+					FOREACH_AST(GET_BIN_OPERANDS(node)){
+						PushWork(stack, item->node, WALK_REFERENCE, 0);
+					}
+					break;
+				}
+				PushWork(stack, GET_BIN_LEFT(node), WALK_REFERENCE, 0);
+				PushWork(stack, GET_BIN_RIGHT(node), WALK_REFERENCE, 0);
+				break;
+			}
+			case FUNC_CALL: {
+				FOREACH_AST(GET_FUNC_CALL_PARAMS(node)){
+					PushWork(stack, item->node, WALK_REFERENCE, 0);
+				}
+
+				ASTNode* func = GET_FUNC_CALL_FUNC(node);
+				if (func == NULL) break;
+				if (dce->marking){
+					dce->marked[NODE_INDEX(dce, func)] = true;
+					break;
+				}
+				if (dce->live[NODE_INDEX(dce, func)]) break;
+				dce->live[NODE_INDEX(dce, func)] = true;
+				if (!dce->liveScopes[GET_FUNC_BODY(func)]){
+					dce->liveScopes[GET_FUNC_BODY(func)] = true;
+					PushWork(&dce->scopeQueue, NULL, GET_FUNC_BODY(func), 0);
+				}
+				break;
+			}
+			case INC:
+			case DEC: {
+				PushWork(stack, GET_ASSIGN_VAR(node), WALK_REFERENCE, 0);
+				break;
+			}
+			case RETURN: PushWork(stack, GET_RETURN_VALUE(node), WALK_REFERENCE, 0); break;
+			case FOR: {
+				PushWork(stack, GET_FOR_VAR(node), WALK_ROOT, 0);
+				PushWork(stack, GET_FOR_CONDITION(node), WALK_REFERENCE, 0);
+				PushWork(stack, GET_FOR_INC(node), WALK_ROOT, 0);
+				break;
+			}
+			case WHILE: PushWork(stack, GET_WHILE_CONDITION(node), WALK_REFERENCE, 0); break;
+			case IF: PushWork(stack, GET_IF_CONDITION(node), WALK_REFERENCE, 0); break;
+			case SWITCH: PushWork(stack, GET_SWITCH_CONDITION(node), WALK_REFERENCE, 0); break;
+			case CASE: PushWork(stack, GET_CASE_CONDITION(node), WALK_REFERENCE, 0); break;
+			default: {
+				if (!IsAssignment(node->type)) break;
+				ASTNode* var = GET_ASSIGN_VAR(node);
+				PushWork(stack, GET_ASSIGN_VALUE(node), WALK_REFERENCE, 0);
+				if (dce->marking){
+					// Walked like a read, so a declaration reached
+					// here first still keeps its value
+					PushWork(stack, var, WALK_REFERENCE, 0);
+					break;
+				}
+
+				// A plain assignment of a pure value in a statement
+				// list goes when its variable does; any other write
+				// keeps the variable
+				int varIndex = NODE_INDEX(dce, var);
+				if (node->type == ASSIGN && node->scopeId > 0 && IsPureStore(dce, var, GET_ASSIGN_VALUE(node))){
+					dce->nextAssign[index] = dce->firstAssign[varIndex];
+					dce->firstAssign[varIndex] = index;
+				}
+				else {
+					dce->reads[varIndex]++;
+				}
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Remove live variable declarations that are never read and
+ * whose value is pure, along with their plain assignments.
+ * Removing one can leave the variables it read unread too.
+ */
+void RemoveUnreadVars(DeadCodeEliminator* dce, DeadCodeReport* report){
+	WorkStack unread;
+	InitWorkStack(&unread);
+
+	for (int i = 0; i < dce->scope->nodeLength; i++){
+		ASTNode* node = &dce->scope->nodes[i];
+		if (node->type == VAR && dce->live[i] && dce->reads[i] == 0) PushWork(&unread, node, 0, 0);
+	}
+
+	while (!IS_WORK_STACK_EMPTY(&unread)){
+		ASTNode* var = PopWork(&unread).node;
+		int index = NODE_INDEX(dce, var);
+		if (dce->removed[index] || !IsPureStore(dce, var, GET_VAR_VALUE(var))) continue;
+
+		dce->removed[index] = true;
+		report->vars++;
+		DEBUG_PRINT2("Unread variable", GET_VAR_NAME(var));
+
+		// Collect the variables that just lost a read
+		ForgetReads(dce, GET_VAR_VALUE(var));
+		for (int assign = dce->firstAssign[index]; assign >= 0; assign = dce->nextAssign[assign]){
+			dce->removed[assign] = true;
+			ForgetReads(dce, GET_ASSIGN_VALUE((&dce->scope->nodes[assign])));
+		}
+		for (int i = 0; i < dce->stack.length; i++){
+			ASTNode* node = dce->stack.items[i].node;
+			if (dce->live[NODE_INDEX(dce, node)] && dce->reads[NODE_INDEX(dce, node)] == 0){
+				PushWork(&unread, node, 0, 0);
+			}
+		}
+		dce->stack.length = 0;
+	}
+
+	DestroyWorkStack(&unread);
+}
+
+/**
+ * Drop the reads a removed pure expression made. The
+ * variables read are left on the work stack for the caller.
+ */
+void ForgetReads(DeadCodeEliminator* dce, ASTNode* node){
+	if (node == NULL) return;
+	WorkStack pending;
+	InitWorkStack(&pending);
+	PushWork(&pending, node, 0, 0);
+
+	while (!IS_WORK_STACK_EMPTY(&pending)){
+		node = PopWork(&pending).node;
+		if (node->type == VAR){
+			dce->reads[NODE_INDEX(dce, node)]--;
+			PushWork(&dce->stack, node, 0, 0);
+		}
+		else if (node->type == BINARY && GET_BIN_OPERANDS(node) != NULL){
+			FOREACH_AST(GET_BIN_OPERANDS(node)){
+				PushWork(&pending, item->node, 0, 0);
+			}
+		}
+		else if (node->type == BINARY){
+			PushWork(&pending, GET_BIN_LEFT(node), 0, 0);
+			PushWork(&pending, GET_BIN_RIGHT(node), 0, 0);
+		}
+	}
+
+	DestroyWorkStack(&pending);
+}
+
+/**
+ * Keep what live statements and called functions reference,
+ * everything else is removed.
+ */
+void SweepDeadCode(DeadCodeEliminator* dce, DeadCodeReport* report){
+	Scope* scope = dce->scope;
+	dce->marking = true;
+
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (!dce->live[i] || dce->removed[i]) continue;
+		WalkStatement(dce, node);
+
+		if (node->type == FUNC){
+			FOREACH_AST(GET_FUNC_PARAMS(node)){
+				dce->marked[NODE_INDEX(dce, item->node)] = true;
+			}
+		}
+	}
+
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (dce->marked[i] || node->type == UNDEFINED) continue;
+
+		if (node->isStmt && node->scopeId > 0) report->statements++;
+		if (node->type == FUNC) report->funcs++;
+		report->nodes++;
+		RemoveNode(node);
+	}
+}
+
+/**
+ * Whether dropping an expression unevaluated changes nothing:
+ * no calls or writes, and nothing that can raise a runtime
+ * error. Integer math may overflow or divide by zero, so only
+ * math that is floating point from its first operand counts.
+ */
+bool IsPureExpression(DeadCodeEliminator* dce, ASTNode* node){
+	if (node == NULL) return true;
+	WorkStack pending;
+	InitWorkStack(&pending);
+	PushWork(&pending, node, 0, 0);
+
+	bool pure = true;
+	while (pure && !IS_WORK_STACK_EMPTY(&pending)){
+		node = PopWork(&pending).node;
+		if (node->type == VAR || IsNumber(node->type) || IsString(node->type)) continue;
+		if (node->type != BINARY){
+			pure = false;
+			break;
+		}
+
+		Token op = GET_BIN_OP(node);
+		ASTList* operands = GET_BIN_OPERANDS(node);
+		ASTNode* first = operands != NULL ? operands->first->node : GET_BIN_LEFT(node);
+		if (op == POW || op == SHL || op == SHR){
+			pure = false;
+		}
+		else if (IsBinaryOperator(op) && !IsBitwiseOperator(op)){
+			Token left = first->type == VAR ? GET_VAR_TYPE(first) : first->type;
+			Token right = UNDEFINED;
+			if (operands == NULL){
+				right = GET_BIN_RIGHT(node)->type == VAR ? GET_VAR_TYPE(GET_BIN_RIGHT(node)) : GET_BIN_RIGHT(node)->type;
+			}
+			if (left != FLOAT && left != DOUBLE && right != FLOAT && right != DOUBLE) pure = false;
+		}
+
+		if (operands != NULL){
+			FOREACH_AST(operands){
+				PushWork(&pending, item->node, 0, 0);
+			}
+		}
+		else {
+			PushWork(&pending, GET_BIN_LEFT(node), 0, 0);
+			PushWork(&pending, GET_BIN_RIGHT(node), 0, 0);
+		}
+	}
+
+	DestroyWorkStack(&pending);
+	return pure;
+}
+
+/**
+ * Whether writing value to var has no effect but the write:
+ * the value is pure, and narrowing it to the variable's type
+ * can not overflow
+ */
+bool IsPureStore(DeadCodeEliminator* dce, ASTNode* var, ASTNode* value){
+	if (!IsPureExpression(dce, value)) return false;
+	Token type = GET_VAR_TYPE(var);
+	if (value == NULL || !IsIntegerType(type)) return true;
+	if (IsLiteral(value)) return CastFits(GetLiteralValue(value), type);
+
+	// Pure integer math is only ever a variable, other
+	// values are floating point
+	if (value->type != VAR) return false;
+	int width = GetIntegerWidth(GET_VAR_TYPE(value));
+	return width > 0 && width <= GetIntegerWidth(type);
+}
+
+/**
+ * Turn a node into an UNDEFINED one, freeing what it owns
+ */
+void RemoveNode(ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case VAR: Free(GET_VAR_NAME(node)); break;
+		case STRING: Free(GET_STRING_VALUE(node)); break;
+	}
+	SET_NODE_TYPE(node, UNDEFINED);
+	node->isStmt = false;
+}
@@ -0,0 +1,68 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Dead code elimination. Removes statements that can never
+ * run, functions that are never called from code that runs,
+ * and variables that are never read whose values have no
+ * effect. Removed nodes become UNDEFINED, so the runner
+ * neither schedules nor allocates a context for them.
+ */
+
+#ifndef OPTIMIZER_DEAD_H_
+#define OPTIMIZER_DEAD_H_
+
+#include "utils/assert.h"
+#include "utils/debug.h"
+#include "condor/ast/scope.h"
+#include "condor/ast/ast.h"
+#include "condor/ast/workstack.h"
+#include "condor/mem/allocate.h"
+#include "condor/token/token.h"
+#include "condor/number/number.h"
+#include "condor/optimizer/optimizer-fold.h"
+
+/**
+ * How much the pass dropped
+ */
+typedef struct DeadCodeReport {
+	int nodes;
+	int statements;
+	int funcs;
+	int vars;
+} DeadCodeReport;
+
+typedef struct DeadCodeEliminator {
+	Scope* scope;
+	int totalScopes;
+	bool* reachable; // By node index, statements not after a return
+	bool* live; // By node index, statements that run and functions called
+	bool* removed; // By node index, unread variables and their assignments
+	bool* marked; // By node index, nodes kept by the sweep
+	bool marking; // Whether WalkStatement marks nodes or counts reads
+	int* reads; // By node index, reads of each variable from live code
+	int* nextAssign; // By node index, the variable's next plain assignment
+	int* firstAssign; // By node index, a variable's first plain assignment
+	bool* liveScopes; // By scope id
+	ASTNode** owners; // By scope id, the statement owning the body
+	int* scopeStarts; // By scope id, see InitRunner
+	ASTNode** statements;
+	WorkStack stack;
+	WorkStack scopeQueue;
+} DeadCodeEliminator;
+
+void EliminateDeadCode(Scope* scope, DeadCodeReport* report);
+void InitDeadCodeEliminator(DeadCodeEliminator* dce, Scope* scope);
+void DestroyDeadCodeEliminator(DeadCodeEliminator* dce);
+void FindReachableStatements(DeadCodeEliminator* dce);
+void FindLiveCode(DeadCodeEliminator* dce);
+void WalkStatement(DeadCodeEliminator* dce, ASTNode* node);
+void RemoveUnreadVars(DeadCodeEliminator* dce, DeadCodeReport* report);
+void ForgetReads(DeadCodeEliminator* dce, ASTNode* node);
+void SweepDeadCode(DeadCodeEliminator* dce, DeadCodeReport* report);
+bool IsPureExpression(DeadCodeEliminator* dce, ASTNode* node);
+bool IsPureStore(DeadCodeEliminator* dce, ASTNode* var, ASTNode* value);
+void RemoveNode(ASTNode* node);
+
+#endif // OPTIMIZER_DEAD_H_
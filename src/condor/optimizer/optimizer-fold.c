@@ -0,0 +1,278 @@
+#include "optimizer-fold.h"
+
+#define NODE_INDEX(folder, node) ((int) ((node) - (folder)->scope->nodes))
+
+/**
+ * Fold every expression in the tree. Nodes are visited in
+ * the order they were parsed, so a variable's value is
+ * folded before any of its uses.
+ */
+void FoldConstants(Scope* scope){
+	ConstantFolder folder;
+	folder.scope = scope;
+	folder.assigned = Allocate(sizeof(bool) * scope->nodeLength);
+	folder.pinned = Allocate(sizeof(bool) * scope->nodeLength);
+	InitWorkStack(&folder.stack);
+
+	for (int i = 0; i < scope->nodeLength; i++){
+		folder.assigned[i] = false;
+		folder.pinned[i] = false;
+	}
+
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (IsAssignment(node->type) || node->type == INC || node->type == DEC){
+			folder.assigned[NODE_INDEX(&folder, GET_ASSIGN_VAR(node))] = true;
+		}
+		else if (node->type == VAR && GET_VAR_VALUE(node) != NULL){
+			folder.pinned[NODE_INDEX(&folder, GET_VAR_VALUE(node))] = true;
+		}
+	}
+
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		int type = (int) node->type;
+		switch (type){
+			case VAR: {
+				ASTNode* value = FoldExpression(&folder, GET_VAR_VALUE(node));
+
+				// A shared literal must already have this variable's type,
+				// it is never cast in place for a second owner
+				if (value == NULL || value == GET_VAR_VALUE(node) || value->type == GET_VAR_TYPE(node)){
+					SET_VAR_VALUE(node, value);
+				}
+				break;
+			}
+			case RETURN: SET_RETURN_VALUE(node, FoldExpression(&folder, GET_RETURN_VALUE(node))); break;
+			case FOR: SET_FOR_CONDITION(node, FoldExpression(&folder, GET_FOR_CONDITION(node))); break;
+			case WHILE: SET_WHILE_CONDITION(node, FoldExpression(&folder, GET_WHILE_CONDITION(node))); break;
+			case IF: SET_IF_CONDITION(node, FoldExpression(&folder, GET_IF_CONDITION(node))); break;
+			case SWITCH: SET_SWITCH_CONDITION(node, FoldExpression(&folder, GET_SWITCH_CONDITION(node))); break;
+			case CASE: SET_CASE_CONDITION(node, FoldExpression(&folder, GET_CASE_CONDITION(node))); break;
+			case FUNC_CALL: {
+				FOREACH_AST(GET_FUNC_CALL_PARAMS(node)){
+					item->node = FoldExpression(&folder, item->node);
+				}
+				break;
+			}
+			case BINARY: {
+				if (node->isStmt) FoldExpression(&folder, node);
+				break;
+			}
+			default: {
+				if (IsAssignment(node->type)){
+					SET_ASSIGN_VALUE(node, FoldExpression(&folder, GET_ASSIGN_VALUE(node)));
+				}
+				break;
+			}
+		}
+	}
+
+	DestroyWorkStack(&folder.stack);
+	Free(folder.assigned);
+	Free(folder.pinned);
+}
+
+/**
+ * Fold an expression bottom up on the folder's work stack,
+ * without C recursion. Returns the node to use in its place,
+ * which differs when a variable was propagated.
+ */
+ASTNode* FoldExpression(ConstantFolder* folder, ASTNode* node){
+	if (node == NULL) return NULL;
+	node = PropagateConstant(folder, node);
+	if (node->type != BINARY) return node;
+
+	WorkStack* stack = &folder->stack;
+	PushWork(stack, node, 0, 0);
+	while (!IS_WORK_STACK_EMPTY(stack)){
+		WorkItem work = PopWork(stack);
+		ASTNode* binary = work.node;
+		if (work.state == 1){
+			FoldBinary(folder, binary);
+			continue;
+		}
+
+		PushWork(stack, binary, 1, 0);
+		if (GET_BIN_OPERANDS(binary) != NULL){
+			FOREACH_AST(GET_BIN_OPERANDS(binary)){
+				if (item->node->type == BINARY) PushWork(stack, item->node, 0, 0);
+			}
+			continue;
+		}
+		if (GET_BIN_LEFT(binary)->type == BINARY) PushWork(stack, GET_BIN_LEFT(binary), 0, 0);
+		if (GET_BIN_RIGHT(binary)->type == BINARY) PushWork(stack, GET_BIN_RIGHT(binary), 0, 0);
+	}
+	return node;
+}
+
+/**
+ * Both operands have been folded. && and || are folded as
+ * soon as the left operand decides them.
+ */
+void FoldBinary(ConstantFolder* folder, ASTNode* node){
+	if (GET_BIN_OPERANDS(node) != NULL){
+		FoldChain(folder, node);
+		return;
+	}
+
+	SET_BINARY_LEFT(node, PropagateConstant(folder, GET_BIN_LEFT(node)));
+	SET_BINARY_RIGHT(node, PropagateConstant(folder, GET_BIN_RIGHT(node)));
+	if (!IsLiteral(GET_BIN_LEFT(node))) return;
+
+	Token op = GET_BIN_OP(node);
+	Value left = GetLiteralValue(GET_BIN_LEFT(node));
+	if ((op == LAND || op == LOR) && IsValueTrue(left) == (op == LOR)){
+		SetLiteralValue(node, BooleanValue(op == LOR));
+		return;
+	}
+
+	Value result;
+	if (!IsLiteral(GET_BIN_RIGHT(node))) return;
+	if (!FoldValues(left, GetLiteralValue(GET_BIN_RIGHT(node)), op, &result)) return;
+	SetLiteralValue(node, result);
+	DEBUG_PRINT2("Folded", TokenToString(op));
+}
+
+/**
+ * A chain is folded left to right, the same order the runner
+ * uses, so only its leading literals can be combined:
+ * 1 + 1 + a becomes 2 + a, but a + 1 + 1 is left alone.
+ */
+void FoldChain(ConstantFolder* folder, ASTNode* node){
+	ASTList* list = GET_BIN_OPERANDS(node);
+	FOREACH_AST(list){
+		item->node = PropagateConstant(folder, item->node);
+	}
+
+	Token op = GET_BIN_OP(node);
+	ASTListItem* rest = list->first;
+	while (rest != NULL && IsLiteral(rest->node)) rest = rest->next;
+	if (rest == list->first) return;
+
+	if (op == LAND || op == LOR){
+		for (ASTListItem* item = list->first; item != rest; item = item->next){
+			if (IsValueTrue(GetLiteralValue(item->node)) == (op == LOR)){
+				SetLiteralValue(node, BooleanValue(op == LOR));
+				return;
+			}
+		}
+
+		// Every leading literal is true for && (false for ||)
+		if (rest == NULL){
+			SetLiteralValue(node, BooleanValue(op == LAND));
+			return;
+		}
+		list->first = rest;
+		rest->prev = NULL;
+		return;
+	}
+
+	Value result = GetLiteralValue(list->first->node);
+	ASTListItem* stop = list->first->next;
+	for (; stop != rest; stop = stop->next){
+		if (!FoldValues(result, GetLiteralValue(stop->node), op, &result)) break;
+	}
+	if (stop == list->first->next) return;
+
+	if (stop == NULL){
+		SetLiteralValue(node, result);
+		DEBUG_PRINT2("Folded chain", TokenToString(op));
+		return;
+	}
+
+	// The combined literal needs a node of its own, one that
+	// is not also a variable's value
+	ASTNode* target = NULL;
+	for (ASTListItem* item = list->first; item != stop; item = item->next){
+		if (!folder->pinned[NODE_INDEX(folder, item->node)]) target = item->node;
+	}
+	if (target == NULL) return;
+
+	SetLiteralValue(target, result);
+	list->first->node = target;
+	list->first->next = stop;
+	stop->prev = list->first;
+	DEBUG_PRINT2("Folded leading operands", TokenToString(op));
+}
+
+/**
+ * left op right for two literals, false when it must be left
+ * to the runner, e.g. a division by zero.
+ */
+bool FoldValues(Value left, Value right, Token op, Value* result){
+	if (op == LAND){
+		*result = BooleanValue(IsValueTrue(left) && IsValueTrue(right));
+		return true;
+	}
+	if (op == LOR){
+		*result = BooleanValue(IsValueTrue(left) || IsValueTrue(right));
+		return true;
+	}
+	if (IsBooleanOperator(op)){
+		*result = BooleanValue(RunCompare(left, right, op));
+		return true;
+	}
+	if (!CanRunMath(left, right, op)) return false;
+	*result = RunMath(left, right, op);
+	return true;
+}
+
+/**
+ * A variable's literal value when the variable is never
+ * written after its declaration, otherwise the node itself.
+ * The literal is cast to the variable's type once, in place.
+ */
+ASTNode* PropagateConstant(ConstantFolder* folder, ASTNode* node){
+	if (node->type != VAR) return node;
+	if (folder->assigned[NODE_INDEX(folder, node)]) return node;
+
+	ASTNode* value = GET_VAR_VALUE(node);
+	if (value == NULL || !IsLiteral(value)) return node;
+	if (!IsNumber(GET_VAR_TYPE(node))) return node;
+
+	// Left for the runner to report, if it ever runs
+	if (!CastFits(GetLiteralValue(value), GET_VAR_TYPE(node))) return node;
+
+	if (value->type != GET_VAR_TYPE(node)){
+		SetLiteralValue(value, CastValue(GetLiteralValue(value), GET_VAR_TYPE(node)));
+	}
+	DEBUG_PRINT2("Propagated", GET_VAR_NAME(node));
+	return value;
+}
+
+bool IsLiteral(ASTNode* node){
+	return IsNumber(node->type);
+}
+
+Value GetLiteralValue(ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case BOOLEAN: return BooleanValue(GET_BOOLEAN_VALUE(node));
+		case BYTE: return ByteValue(GET_BYTE_VALUE(node));
+		case SHORT: return ShortValue(GET_SHORT_VALUE(node));
+		case INT: return IntValue(GET_INT_VALUE(node));
+		case FLOAT: return FloatValue(GET_FLOAT_VALUE(node));
+		case DOUBLE: return DoubleValue(GET_DOUBLE_VALUE(node));
+		case LONG: return LongValue(GET_LONG_VALUE(node));
+	}
+	return EmptyValue(UNDEFINED);
+}
+
+/**
+ * Rewrite a node in place into a literal
+ */
+void SetLiteralValue(ASTNode* node, Value value){
+	Token type = VALUE_TYPE(value);
+	SET_NODE_TYPE(node, type);
+	int t = (int) type;
+	switch (t){
+		case BOOLEAN: node->meta.booleanExpr.value = VALUE_BOOLEAN(value); break;
+		case BYTE: node->meta.byteExpr.value = (signed char) VALUE_BYTE(value); break;
+		case SHORT: node->meta.shortExpr.value = VALUE_SHORT(value); break;
+		case INT: node->meta.intExpr.value = VALUE_INT(value); break;
+		case FLOAT: node->meta.floatExpr.value = VALUE_FLOAT(value); break;
+		case DOUBLE: node->meta.doubleExpr.value = VALUE_DOUBLE(value); break;
+		case LONG: node->meta.longExpr.value = VALUE_LONG(value); break;
+	}
+}
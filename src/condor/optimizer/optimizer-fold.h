@@ -0,0 +1,43 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Constant folding and propagation. Literal subtrees are
+ * computed once, ahead of time, and the nodes rewritten in
+ * place into literals. Variables that are never assigned
+ * after their declaration, and const variables, are replaced
+ * by their literal value where they are used.
+ */
+
+#ifndef OPTIMIZER_FOLD_H_
+#define OPTIMIZER_FOLD_H_
+
+#include "utils/assert.h"
+#include "utils/debug.h"
+#include "condor/ast/scope.h"
+#include "condor/ast/ast.h"
+#include "condor/ast/workstack.h"
+#include "condor/mem/allocate.h"
+#include "condor/token/token.h"
+#include "condor/runner/runner-math.h"
+
+typedef struct ConstantFolder {
+	Scope* scope;
+	bool* assigned; // By node index, variables written after declaration
+	bool* pinned; // By node index, values of variables, shared once propagated
+	WorkStack stack;
+} ConstantFolder;
+
+void FoldConstants(Scope* scope);
+ASTNode* FoldExpression(ConstantFolder* folder, ASTNode* node);
+void FoldBinary(ConstantFolder* folder, ASTNode* node);
+void FoldChain(ConstantFolder* folder, ASTNode* node);
+bool FoldValues(Value left, Value right, Token op, Value* result);
+ASTNode* PropagateConstant(ConstantFolder* folder, ASTNode* node);
+
+bool IsLiteral(ASTNode* node);
+Value GetLiteralValue(ASTNode* node);
+void SetLiteralValue(ASTNode* node, Value value);
+
+#endif // OPTIMIZER_FOLD_H_
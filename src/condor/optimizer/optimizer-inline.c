@@ -0,0 +1,292 @@
+#include "optimizer-inline.h"
+
+/**
+ * Inline every call that can be, returning how many were.
+ * Calls are visited last to first, so a call passed as an
+ * argument is inlined before the call it is passed to.
+ * Copies use the nodes the lexer reserved after the parsed
+ * ones; a call is skipped once they run out.
+ */
+int InlineCalls(Scope* scope){
+	Inliner inliner;
+	inliner.scope = scope;
+	inliner.totalScopes = scope->scopeLength + 2;
+	inliner.statementCounts = Allocate(sizeof(int) * inliner.totalScopes);
+	inliner.statements = Allocate(sizeof(ASTNode*) * inliner.totalScopes);
+	InitWorkStack(&inliner.stack);
+	InitWorkStack(&inliner.results);
+
+	for (int i = 0; i < inliner.totalScopes; i++){
+		inliner.statementCounts[i] = 0;
+		inliner.statements[i] = NULL;
+	}
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (!node->isStmt || node->scopeId <= 0 || node->scopeId >= inliner.totalScopes) continue;
+		if (inliner.statements[node->scopeId] == NULL) inliner.statements[node->scopeId] = node;
+		inliner.statementCounts[node->scopeId]++;
+	}
+
+	int inlined = 0;
+	for (int i = scope->nodeLength - 1; i >= 0; i--){
+		ASTNode* node = &scope->nodes[i];
+		if (node->type != FUNC_CALL) continue;
+
+		ASTNode* body = GetInlineBody(&inliner, GET_FUNC_CALL_FUNC(node));
+		if (body == NULL || !CanInlineCall(&inliner, node, body)) continue;
+		if (InlineCall(&inliner, node, body)) inlined++;
+	}
+
+	DestroyWorkStack(&inliner.stack);
+	DestroyWorkStack(&inliner.results);
+	Free(inliner.statementCounts);
+	Free(inliner.statements);
+	return inlined;
+}
+
+/**
+ * The expression a function returns, when its body is only
+ * that return and the expression is small arithmetic on
+ * numbers. Such a body has no calls, so it is never recursive.
+ */
+ASTNode* GetInlineBody(Inliner* inliner, ASTNode* func){
+	if (func == NULL || func->type != FUNC) return NULL;
+	char* entry = inliner->scope->entry;
+	if (entry != NULL && GET_FUNC_NAME(func) != NULL && strcmp(GET_FUNC_NAME(func), entry) == 0) return NULL;
+
+	int body = GET_FUNC_BODY(func);
+	if (body <= 0 || body >= inliner->totalScopes) return NULL;
+	if (inliner->statementCounts[body] != 1) return NULL;
+
+	ASTNode* stmt = inliner->statements[body];
+	if (stmt->type != RETURN || GET_RETURN_VALUE(stmt) == NULL) return NULL;
+
+	FOREACH_AST(GET_FUNC_PARAMS(func)){
+		if (!IsNumber(GET_VAR_TYPE(item->node))) return NULL;
+	}
+
+	int size = MeasureExpression(inliner, GET_RETURN_VALUE(stmt));
+	if (size < 0 || size > INLINE_THRESHOLD) return NULL;
+	return GET_RETURN_VALUE(stmt);
+}
+
+/**
+ * Every argument must keep its meaning when moved into the
+ * body: literals are copied per use, variables are shared when
+ * they already have the param's type, and a computed argument
+ * is moved to its one use.
+ */
+bool CanInlineCall(Inliner* inliner, ASTNode* call, ASTNode* body){
+	ASTListItem* param = GET_FUNC_CALL_FUNC_PARAMS(call)->first;
+	FOREACH_AST(GET_FUNC_CALL_PARAMS(call)){
+		if (param == NULL) return false;
+		ASTNode* arg = item->node;
+		Token type = GET_VAR_TYPE(param->node);
+
+		if (arg->type == VAR){
+			if (GET_VAR_TYPE(arg) != type) return false;
+		}
+		else if (arg->type == BINARY){
+			if (MeasureExpression(inliner, arg) < 0) return false;
+			if (GetExpressionType(arg) != type) return false;
+			if (CountParamUses(inliner, body, param->node) != 1) return false;
+		}
+		else if (!IsNumber(arg->type)){
+			return false;
+		}
+		else if (!CastFits(GetLiteralValue(arg), type)){
+			return false;
+		}
+		param = param->next;
+	}
+	if (param != NULL) return false;
+
+	// The call node takes the body's place, so a body that is
+	// only a variable, or a param given a variable, has nothing
+	// to write into it
+	if (body->type == VAR){
+		ASTNode* arg = GetArgument(call, body);
+		if (arg == NULL || arg->type == VAR) return false;
+	}
+
+	Scope* scope = inliner->scope;
+	return scope->nodeLength - scope->nodeSpot >= MeasureExpression(inliner, body);
+}
+
+/**
+ * Copy the body into the call. Chains are copied as left deep
+ * binaries, which run in the same order, so no lists are
+ * needed. The body's root is written into the call node
+ * itself, keeping the call's place in the tree.
+ */
+bool InlineCall(Inliner* inliner, ASTNode* call, ASTNode* body){
+	ASTList* args = GET_FUNC_CALL_PARAMS(call);
+	DEBUG_PRINT2("Inlined", GET_FUNC_CALL_NAME(call));
+
+	if (body->type != BINARY){
+		ASTNode* value = CloneOperand(inliner, call, body);
+		CopyNode(call, value);
+		SET_NODE_TYPE(value, UNDEFINED);
+	}
+	else {
+		WorkStack* stack = &inliner->stack;
+		WorkStack* results = &inliner->results;
+		PushWork(stack, body, 0, 0);
+		while (!IS_WORK_STACK_EMPTY(stack)){
+			WorkItem work = PopWork(stack);
+			ASTNode* node = work.node;
+			if (node->type != BINARY){
+				PushWork(results, CloneOperand(inliner, call, node), 0, 0);
+				continue;
+			}
+
+			// Operands are pushed right to left so their copies
+			// come out left to right
+			ASTList* operands = GET_BIN_OPERANDS(node);
+			if (work.state == 0){
+				int count = 0;
+				if (operands != NULL){
+					for (ASTListItem* item = operands->last; item != NULL; item = item->prev) count++;
+				}
+				PushWork(stack, node, 1, operands != NULL ? count : 2);
+				if (operands != NULL){
+					for (ASTListItem* item = operands->last; item != NULL; item = item->prev){
+						PushWork(stack, item->node, 0, 0);
+					}
+				}
+				else {
+					PushWork(stack, GET_BIN_RIGHT(node), 0, 0);
+					PushWork(stack, GET_BIN_LEFT(node), 0, 0);
+				}
+				continue;
+			}
+
+			WorkItem* copies = &results->items[results->length - work.value];
+			ASTNode* left = copies[0].node;
+			for (int i = 1; i < work.value; i++){
+				ASTNode* binary = node == body && i == work.value - 1 ? call : GetNextNode(inliner->scope);
+				SET_NODE_TYPE(binary, BINARY);
+				SET_BINARY_OP(binary, GET_BIN_OP(node));
+				SET_BINARY_LEFT(binary, left);
+				SET_BINARY_RIGHT(binary, copies[i].node);
+				SET_BINARY_SHIFT(binary, operands != NULL ? -1 : GET_BIN_SHIFT(node));
+				SET_BINARY_OPERANDS(binary, NULL);
+				SET_BINARY_OWNER(binary, NULL);
+				binary->valueType = UNDEFINED;
+				left = binary;
+			}
+			results->length -= work.value;
+			PushWork(results, left, 0, 0);
+		}
+		PopWork(results);
+	}
+
+	// Literal arguments were copied to each use
+	FOREACH_AST(args){
+		if (IsNumber(item->node->type)) SET_NODE_TYPE(item->node, UNDEFINED);
+	}
+
+	// A call used as a value is no longer run on its own
+	if (call->scopeId <= 0) call->isStmt = false;
+	return true;
+}
+
+/**
+ * The argument passed for a param of the called function,
+ * NULL when node is not one of its params
+ */
+ASTNode* GetArgument(ASTNode* call, ASTNode* param){
+	ASTListItem* arg = GET_FUNC_CALL_PARAMS(call)->first;
+	FOREACH_AST(GET_FUNC_CALL_FUNC_PARAMS(call)){
+		if (arg == NULL) return NULL;
+		if (item->node == param) return arg->node;
+		arg = arg->next;
+	}
+	return NULL;
+}
+
+/**
+ * How often the body reads a param. A read on the right of
+ * && or || may not happen, so it counts twice: an argument
+ * moved there would only be evaluated when reached.
+ */
+int CountParamUses(Inliner* inliner, ASTNode* body, ASTNode* param){
+	int uses = 0;
+	WorkStack* stack = &inliner->stack;
+	PushWork(stack, body, 0, 0);
+	while (!IS_WORK_STACK_EMPTY(stack)){
+		WorkItem work = PopWork(stack);
+		ASTNode* node = work.node;
+		if (node == param) uses += work.state == 1 ? 2 : 1;
+		if (node->type != BINARY) continue;
+
+		Token op = GET_BIN_OP(node);
+		int state = op == LAND || op == LOR ? 1 : work.state;
+		if (GET_BIN_OPERANDS(node) != NULL){
+			FOREACH_AST(GET_BIN_OPERANDS(node)){
+				PushWork(stack, item->node, item->prev == NULL ? work.state : state, 0);
+			}
+		}
+		else {
+			PushWork(stack, GET_BIN_LEFT(node), work.state, 0);
+			PushWork(stack, GET_BIN_RIGHT(node), state, 0);
+		}
+	}
+	return uses;
+}
+
+/**
+ * The number of nodes in an expression of binaries, variables
+ * and number literals, -1 when it has anything else. Copying
+ * it needs at most this many nodes.
+ */
+int MeasureExpression(Inliner* inliner, ASTNode* node){
+	int size = 0;
+	WorkStack* stack = &inliner->stack;
+	PushWork(stack, node, 0, 0);
+	while (!IS_WORK_STACK_EMPTY(stack)){
+		node = PopWork(stack).node;
+		size++;
+		if (node->type == VAR || IsNumber(node->type)) continue;
+		if (node->type != BINARY){
+			stack->length = 0;
+			return -1;
+		}
+
+		if (GET_BIN_OPERANDS(node) != NULL){
+			FOREACH_AST(GET_BIN_OPERANDS(node)){
+				PushWork(stack, item->node, 0, 0);
+			}
+		}
+		else {
+			PushWork(stack, GET_BIN_LEFT(node), 0, 0);
+			PushWork(stack, GET_BIN_RIGHT(node), 0, 0);
+		}
+	}
+	return size;
+}
+
+/**
+ * The copy of a leaf of the body: a param becomes its
+ * argument, a literal is copied, and any other variable is
+ * shared since it names the same declaration.
+ */
+ASTNode* CloneOperand(Inliner* inliner, ASTNode* call, ASTNode* node){
+	ASTNode* arg = GetArgument(call, node);
+	if (arg != NULL && !IsNumber(arg->type)) return arg;
+	if (arg == NULL && node->type == VAR) return node;
+
+	ASTNode* clone = CopyNode(GetNextNode(inliner->scope), arg != NULL ? arg : node);
+	if (arg != NULL) SetLiteralValue(clone, CastValue(GetLiteralValue(clone), GET_VAR_TYPE(node)));
+	return clone;
+}
+
+/**
+ * Give target the source's type and value, it keeps its own
+ * id and place
+ */
+ASTNode* CopyNode(ASTNode* target, ASTNode* source){
+	SET_NODE_TYPE(target, source->type);
+	target->meta = source->meta;
+	return target;
+}
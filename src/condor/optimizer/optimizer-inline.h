@@ -0,0 +1,57 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Inlining. A call to a small function whose body is a single
+ * return of arithmetic on its params is replaced by a copy of
+ * that expression, with the arguments in place of the params.
+ * Runs before constant folding, so a call with literal
+ * arguments folds down to a literal.
+ */
+
+#ifndef OPTIMIZER_INLINE_H_
+#define OPTIMIZER_INLINE_H_
+
+#include "utils/assert.h"
+#include "utils/debug.h"
+#include "condor/ast/scope.h"
+#include "condor/ast/ast.h"
+#include "condor/ast/astlist.h"
+#include "condor/ast/workstack.h"
+#include "condor/mem/allocate.h"
+#include "condor/token/token.h"
+#include "condor/syntax/syntax.h"
+#include "condor/semantic/typechecker.h"
+#include "condor/runner/runner-math.h"
+#include "condor/optimizer/optimizer-fold.h"
+
+/**
+ * The most nodes a function's return expression may have to
+ * be inlined. The lexer counts tokens against the same limit
+ * to reserve nodes for the copies, see CountInlineNodes.
+ */
+#ifndef INLINE_THRESHOLD
+#define INLINE_THRESHOLD 16
+#endif
+
+typedef struct Inliner {
+	Scope* scope;
+	int totalScopes;
+	int* statementCounts; // By scope id
+	ASTNode** statements; // By scope id, the scope's first statement
+	WorkStack stack;
+	WorkStack results;
+} Inliner;
+
+int InlineCalls(Scope* scope);
+ASTNode* GetInlineBody(Inliner* inliner, ASTNode* func);
+bool CanInlineCall(Inliner* inliner, ASTNode* call, ASTNode* body);
+bool InlineCall(Inliner* inliner, ASTNode* call, ASTNode* body);
+ASTNode* GetArgument(ASTNode* call, ASTNode* param);
+int CountParamUses(Inliner* inliner, ASTNode* body, ASTNode* param);
+int MeasureExpression(Inliner* inliner, ASTNode* node);
+ASTNode* CloneOperand(Inliner* inliner, ASTNode* call, ASTNode* node);
+ASTNode* CopyNode(ASTNode* target, ASTNode* source);
+
+#endif // OPTIMIZER_INLINE_H_
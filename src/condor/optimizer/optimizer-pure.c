@@ -0,0 +1,247 @@
+#include "optimizer-pure.h"
+
+#define NODE_INDEX(purity, node) ((int) ((node) - (purity)->scope->nodes))
+
+/**
+ * Mark the pure functions and number the ones worth a memo
+ * table, returning how many are. A function whose body is
+ * only a return was inlined where it could be, and costs less
+ * to run than to look up, so only functions that loop or call
+ * are memoized.
+ */
+int FindPureFunctions(Scope* scope){
+	PurityAnalysis purity;
+	InitPurityAnalysis(&purity, scope);
+
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (!node->isStmt || node->scopeId <= 0 || node->scopeId >= purity.totalScopes) continue;
+		ASTNode* func = purity.funcs[node->scopeId];
+		if (func != NULL) CheckStatementPurity(&purity, func, node);
+	}
+
+	// A call to an impure function makes the caller impure
+	bool changed = true;
+	while (changed){
+		changed = false;
+		for (int i = 0; i < purity.calls.length; i++){
+			WorkItem call = purity.calls.items[i];
+			int caller = NODE_INDEX(&purity, call.node);
+			if (!purity.impure[caller] && purity.impure[call.value]){
+				purity.impure[caller] = true;
+				changed = true;
+			}
+		}
+	}
+
+	int memos = 0;
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->type != FUNC) continue;
+		SET_FUNC_PURE(node, !purity.impure[i]);
+		if (!CanMemoize(&purity, node)) continue;
+		SET_FUNC_MEMO(node, memos++);
+		DEBUG_PRINT2("Memoized", GET_FUNC_NAME(node));
+	}
+
+	DestroyPurityAnalysis(&purity);
+	return memos;
+}
+
+void InitPurityAnalysis(PurityAnalysis* purity, Scope* scope){
+	int length = scope->nodeLength;
+	purity->scope = scope;
+	purity->totalScopes = scope->scopeLength + 2;
+	purity->owners = Allocate(sizeof(ASTNode*) * purity->totalScopes);
+	purity->funcs = Allocate(sizeof(ASTNode*) * purity->totalScopes);
+	purity->locals = Allocate(sizeof(ASTNode*) * length);
+	purity->impure = Allocate(sizeof(bool) * length);
+	purity->worth = Allocate(sizeof(bool) * length);
+	InitWorkStack(&purity->calls);
+	InitWorkStack(&purity->stack);
+
+	for (int i = 0; i < purity->totalScopes; i++){
+		purity->owners[i] = NULL;
+		purity->funcs[i] = NULL;
+	}
+	for (int i = 0; i < length; i++){
+		purity->locals[i] = NULL;
+		purity->impure[i] = false;
+		purity->worth[i] = false;
+	}
+
+	for (int i = 0; i < length; i++){
+		ASTNode* node = &scope->nodes[i];
+		int type = (int) node->type;
+		switch (type){
+			case FOR: purity->owners[GET_FOR_BODY(node)] = node; break;
+			case WHILE: purity->owners[GET_WHILE_BODY(node)] = node; break;
+			case IF: purity->owners[GET_IF_BODY(node)] = node; break;
+			case SWITCH: purity->owners[GET_SWITCH_BODY(node)] = node; break;
+			case CASE: purity->owners[GET_CASE_BODY(node)] = node; break;
+			case FUNC: purity->owners[GET_FUNC_BODY(node)] = node; break;
+		}
+	}
+	for (int i = 1; i < purity->totalScopes; i++){
+		purity->funcs[i] = FindEnclosingFunc(purity, i);
+	}
+
+	// Statement variables belong to their scope's function,
+	// params to theirs, loop variables to the loop's
+	for (int i = 0; i < length; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->type == FUNC){
+			FOREACH_AST(GET_FUNC_PARAMS(node)){
+				purity->locals[NODE_INDEX(purity, item->node)] = node;
+			}
+		}
+		if (!node->isStmt || node->scopeId <= 0 || node->scopeId >= purity->totalScopes) continue;
+		ASTNode* func = purity->funcs[node->scopeId];
+		if (node->type == VAR) purity->locals[i] = func;
+		if (node->type == FOR && GET_FOR_VAR(node) != NULL && GET_FOR_VAR(node)->type == VAR){
+			purity->locals[NODE_INDEX(purity, GET_FOR_VAR(node))] = func;
+		}
+	}
+}
+
+void DestroyPurityAnalysis(PurityAnalysis* purity){
+	DestroyWorkStack(&purity->calls);
+	DestroyWorkStack(&purity->stack);
+	Free(purity->owners);
+	Free(purity->funcs);
+	Free(purity->locals);
+	Free(purity->impure);
+	Free(purity->worth);
+}
+
+/**
+ * The innermost function around a scope, NULL at the top level
+ */
+ASTNode* FindEnclosingFunc(PurityAnalysis* purity, int scopeId){
+	for (int depth = 0; depth < purity->totalScopes; depth++){
+		if (scopeId <= 0 || scopeId >= purity->totalScopes) return NULL;
+		ASTNode* owner = purity->owners[scopeId];
+		if (owner == NULL || owner->type == FUNC) return owner;
+		scopeId = owner->scopeId;
+	}
+	return NULL;
+}
+
+/**
+ * Walk what a statement of the function runs, marking the
+ * function impure on the first outside read or write or call
+ * to something other than a function. Calls are kept for
+ * FindPureFunctions to settle once every function is walked.
+ */
+void CheckStatementPurity(PurityAnalysis* purity, ASTNode* func, ASTNode* node){
+	int funcIndex = NODE_INDEX(purity, func);
+	if (node->type == FUNC) return; // Checked as its own function
+	if (purity->impure[funcIndex]) return;
+
+	WorkStack* stack = &purity->stack;
+	PushWork(stack, node, 1, 0);
+	while (!IS_WORK_STACK_EMPTY(stack)){
+		WorkItem work = PopWork(stack);
+		node = work.node;
+		if (node == NULL) continue;
+
+		bool pure = true;
+		int type = (int) node->type;
+		switch (type){
+			case VAR: {
+				// A declaration runs its value, anything else reads it
+				if (work.state == 1) PushWork(stack, GET_VAR_VALUE(node), 0, 0);
+				else pure = IsLocalVar(purity, func, node);
+				break;
+			}
+			case BINARY: {
+				if (GET_BIN_OPERANDS(node) != NULL){
+					FOREACH_AST(GET_BIN_OPERANDS(node)){
+						PushWork(stack, item->node, 0, 0);
+					}
+					break;
+				}
+				PushWork(stack, GET_BIN_LEFT(node), 0, 0);
+				PushWork(stack, GET_BIN_RIGHT(node), 0, 0);
+				break;
+			}
+			case FUNC_CALL: {
+				ASTNode* callee = GET_FUNC_CALL_FUNC(node);
+				if (callee == NULL || callee->type != FUNC){
+					pure = false;
+					break;
+				}
+				PushWork(&purity->calls, func, 0, NODE_INDEX(purity, callee));
+				purity->worth[funcIndex] = true;
+				FOREACH_AST(GET_FUNC_CALL_PARAMS(node)){
+					PushWork(stack, item->node, 0, 0);
+				}
+				break;
+			}
+			case RETURN: {
+				ASTNode* value = GET_RETURN_VALUE(node);
+				if (value != NULL && !IsNumber(GetExpressionType(value))) pure = false;
+				PushWork(stack, value, 0, 0);
+				break;
+			}
+			case FOR: {
+				purity->worth[funcIndex] = true;
+				PushWork(stack, GET_FOR_VAR(node), 1, 0);
+				PushWork(stack, GET_FOR_CONDITION(node), 0, 0);
+				PushWork(stack, GET_FOR_INC(node), 1, 0);
+				break;
+			}
+			case WHILE: {
+				purity->worth[funcIndex] = true;
+				PushWork(stack, GET_WHILE_CONDITION(node), 0, 0);
+				break;
+			}
+			case IF: PushWork(stack, GET_IF_CONDITION(node), 0, 0); break;
+			case SWITCH: PushWork(stack, GET_SWITCH_CONDITION(node), 0, 0); break;
+			case CASE: PushWork(stack, GET_CASE_CONDITION(node), 0, 0); break;
+			case BREAK:
+			case UNDEFINED: break;
+			case INC:
+			case DEC: {
+				pure = IsLocalVar(purity, func, GET_ASSIGN_VAR(node));
+				break;
+			}
+			default: {
+				if (IsAssignment(node->type)){
+					pure = IsLocalVar(purity, func, GET_ASSIGN_VAR(node));
+					PushWork(stack, GET_ASSIGN_VALUE(node), 0, 0);
+				}
+				else if (!IsNumber(node->type)){
+					pure = false;
+				}
+				break;
+			}
+		}
+
+		if (!pure){
+			purity->impure[funcIndex] = true;
+			stack->length = 0;
+		}
+	}
+}
+
+bool IsLocalVar(PurityAnalysis* purity, ASTNode* func, ASTNode* var){
+	if (var == NULL || var->type != VAR) return false;
+	return purity->locals[NODE_INDEX(purity, var)] == func;
+}
+
+/**
+ * Pure, worth the lookup, and keyed on numbers only: a string
+ * argument would be compared by its pointer
+ */
+bool CanMemoize(PurityAnalysis* purity, ASTNode* func){
+	if (MEMO_TABLE_SIZE <= 0) return false;
+	int index = NODE_INDEX(purity, func);
+	if (purity->impure[index] || !purity->worth[index]) return false;
+	if (GET_FUNC_PARAMS(func)->first == NULL) return false;
+
+	FOREACH_AST(GET_FUNC_PARAMS(func)){
+		if (!IsNumber(GET_VAR_TYPE(item->node))) return false;
+	}
+	return true;
+}
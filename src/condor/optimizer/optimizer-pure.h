@@ -0,0 +1,47 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Purity analysis. A function is pure when it only reads its
+ * params and its own variables, writes only its own
+ * variables, and calls only pure functions: its result then
+ * depends on nothing but its arguments. Pure functions that
+ * loop or call are given a memo table, see RunFuncWithArgs.
+ */
+
+#ifndef OPTIMIZER_PURE_H_
+#define OPTIMIZER_PURE_H_
+
+#include "utils/assert.h"
+#include "utils/debug.h"
+#include "condor/ast/scope.h"
+#include "condor/ast/ast.h"
+#include "condor/ast/astlist.h"
+#include "condor/ast/workstack.h"
+#include "condor/mem/allocate.h"
+#include "condor/token/token.h"
+#include "condor/semantic/typechecker.h"
+#include "condor/runner/runner-types.h"
+
+typedef struct PurityAnalysis {
+	Scope* scope;
+	int totalScopes;
+	ASTNode** owners; // By scope id, the statement owning the body
+	ASTNode** funcs; // By scope id, the function the scope is in
+	ASTNode** locals; // By node index, the function declaring a variable
+	bool* impure; // By node index of a function
+	bool* worth; // By node index of a function, it loops or calls
+	WorkStack calls; // A caller and its callee per item
+	WorkStack stack;
+} PurityAnalysis;
+
+int FindPureFunctions(Scope* scope);
+void InitPurityAnalysis(PurityAnalysis* purity, Scope* scope);
+void DestroyPurityAnalysis(PurityAnalysis* purity);
+ASTNode* FindEnclosingFunc(PurityAnalysis* purity, int scopeId);
+void CheckStatementPurity(PurityAnalysis* purity, ASTNode* func, ASTNode* node);
+bool IsLocalVar(PurityAnalysis* purity, ASTNode* func, ASTNode* var);
+bool CanMemoize(PurityAnalysis* purity, ASTNode* func);
+
+#endif // OPTIMIZER_PURE_H_
@@ -0,0 +1,89 @@
+#include "optimizer.h"
+
+/**
+ * Run every optimization over the checked tree, but the ones
+ * switched off, see GetOptimizerPasses
+ */
+void Optimize(Scope* scope, OptimizerStats* stats){
+	int passes = GetOptimizerPasses();
+	stats->deadCode = (DeadCodeReport) {0};
+	stats->inlinedCalls = 0;
+	stats->sharedNodes = 0;
+	stats->memoizedFuncs = 0;
+	if (passes & PASS_INLINE) stats->inlinedCalls = InlineCalls(scope);
+	if (passes & PASS_FOLD) FoldConstants(scope);
+	if (passes & PASS_DEAD) EliminateDeadCode(scope, &stats->deadCode);
+	if (passes & PASS_CSE) stats->sharedNodes = EliminateCommonSubexpressions(scope);
+	if (passes & PASS_MEMO) stats->memoizedFuncs = FindPureFunctions(scope);
+	if (!(passes & PASS_REDUCE)) return;
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->type == BINARY) ReduceStrength(node);
+	}
+}
+
+/**
+ * The passes to run, all of them less the ones named in
+ * CONDOR_NO_OPTIMIZE. Unknown names are ignored.
+ */
+int GetOptimizerPasses(void){
+	static const char* names[] = {"inline", "fold", "dead", "cse", "memo", "reduce"};
+	char* skip = getenv(NO_OPTIMIZE_ENV);
+	if (skip == NULL) return ALL_PASSES;
+	if (strcmp(skip, "all") == 0) return 0;
+
+	int passes = ALL_PASSES;
+	while (*skip != '\0'){
+		int length = (int) strcspn(skip, ",");
+		for (int i = 0; i < 6; i++){
+			if ((int) strlen(names[i]) == length && strncmp(skip, names[i], length) == 0) passes &= ~(1 << i);
+		}
+		skip += length;
+		if (*skip == ',') skip++;
+	}
+	return passes;
+}
+
+void ReduceStrength(ASTNode* node){
+	Token op = GET_BIN_OP(node);
+	if (op != MUL && op != DIV && op != MOD && op != SHL && op != SHR) return;
+	if (GET_BIN_OPERANDS(node) != NULL) return;
+
+	long constant;
+	if (!GetIntegerLiteral(GET_BIN_RIGHT(node), &constant)) return;
+
+	// The constant must not widen the result, the reduced
+	// math keeps the left operand's width
+	Token left = GetExpressionType(GET_BIN_LEFT(node));
+	Token right = GET_BIN_RIGHT(node)->type;
+	if (!IsIntegerType(left)) return;
+	if (GetPromotedType(left, right) != GetPromotedType(left, left)) return;
+
+	if (op == SHL || op == SHR){
+		// Left to the runner to report, if it ever runs
+		if (constant < 0) return;
+		SET_BINARY_SHIFT(node, constant > 64 ? 64 : (int) constant);
+		DEBUG_PRINT2("Constant shift", TokenToString(op));
+		return;
+	}
+
+	// Powers of two above 1
+	if (constant < 2 || (constant & (constant - 1)) != 0) return;
+	SET_BINARY_SHIFT(node, __builtin_ctzl(constant));
+	DEBUG_PRINT2("Strength reduced", TokenToString(op));
+}
+
+/**
+ * Read an integer literal node
+ */
+bool GetIntegerLiteral(ASTNode* node, long* value){
+	int type = (int) node->type;
+	switch (type){
+		case BOOLEAN: *value = GET_BOOLEAN_VALUE(node); return true;
+		case BYTE: *value = GET_BYTE_VALUE(node); return true;
+		case SHORT: *value = GET_SHORT_VALUE(node); return true;
+		case INT: *value = GET_INT_VALUE(node); return true;
+		case LONG: *value = GET_LONG_VALUE(node); return true;
+	}
+	return false;
+}
@@ -0,0 +1,73 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * The end user will not interact with this library.
+ * Passes that rewrite the checked AST in place before
+ * it is run.
+ *
+ * User:
+ * 	Semantic Analysis Only
+ * 
+ * Usage:
+ * 	EnsureSemantics(&scope, 1);
+ * 	Optimize(&scope, &stats);
+ */
+
+#ifndef OPTIMIZER_H_
+#define OPTIMIZER_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/assert.h"
+#include "utils/debug.h"
+#include "condor/ast/scope.h"
+#include "condor/ast/ast.h"
+#include "condor/token/token.h"
+#include "condor/number/number.h"
+#include "condor/semantic/typechecker.h"
+#include "condor/optimizer/optimizer-inline.h"
+#include "condor/optimizer/optimizer-fold.h"
+#include "condor/optimizer/optimizer-dead.h"
+#include "condor/optimizer/optimizer-cse.h"
+#include "condor/optimizer/optimizer-pure.h"
+
+/**
+ * Passes named in CONDOR_NO_OPTIMIZE, comma separated, are
+ * skipped, and all of them with "all". Meant for comparing a
+ * program's output with and without a pass.
+ */
+#define NO_OPTIMIZE_ENV "CONDOR_NO_OPTIMIZE"
+#define PASS_INLINE 1
+#define PASS_FOLD 2
+#define PASS_DEAD 4
+#define PASS_CSE 8
+#define PASS_MEMO 16
+#define PASS_REDUCE 32
+#define ALL_PASSES 63
+
+/**
+ * What the passes changed, printed with the program stats
+ */
+typedef struct OptimizerStats {
+	int clonedFuncs; // Set before the passes, see Monomorphize
+	int inlinedCalls;
+	int sharedNodes;
+	int memoizedFuncs;
+	DeadCodeReport deadCode;
+} OptimizerStats;
+
+void Optimize(Scope* scope, OptimizerStats* stats);
+int GetOptimizerPasses(void);
+
+/**
+ * Mark integer math against a constant power of two, and
+ * shifts by a constant, so the runner can use shifts and
+ * masks. See RunReducedMath.
+ */
+void ReduceStrength(ASTNode* node);
+
+bool GetIntegerLiteral(ASTNode* node, long* value);
+
+#endif // OPTIMIZER_H_
@@ -0,0 +1,205 @@
+#include "runner.h"
+
+void InitActivations(Runner* runner){
+  int length = runner->scope->nodeLength;
+  runner->activations = Allocate(sizeof(RunnerActivation) * (length > 0 ? length : 1));
+  for (int i = 0; i < length; i++){
+    runner->activations[i].depth = 0;
+    runner->activations[i].start = -1;
+    runner->activations[i].length = 0;
+  }
+  runner->owned = NULL;
+  runner->ownedSpot = 0;
+  runner->totalOwned = 0;
+  runner->saved = NULL;
+  runner->savedSpot = 0;
+  runner->totalSaved = 0;
+}
+
+void DestroyActivations(Runner* runner){
+  Free(runner->activations);
+  Free(runner->owned);
+  Free(runner->saved);
+  runner->activations = NULL;
+  runner->owned = NULL;
+  runner->saved = NULL;
+}
+
+/**
+ * Count a call into func, saving the function's contexts if
+ * it is already running. Returns whether it was.
+ */
+bool EnterActivation(Runner* runner, ASTNode* func){
+  RunnerActivation* activation = GetActivation(runner, func);
+  if (activation->depth++ == 0) return false;
+  if (activation->start < 0) FindOwnedNodes(runner, func, activation);
+  SaveActivation(runner, activation);
+  return true;
+}
+
+void LeaveActivation(Runner* runner, ASTNode* func, bool reentered){
+  RunnerActivation* activation = GetActivation(runner, func);
+  activation->depth--;
+  if (reentered) RestoreActivation(runner, activation);
+}
+
+RunnerActivation* GetActivation(Runner* runner, ASTNode* func){
+  return &runner->activations[func->id - runner->firstNodeId];
+}
+
+/**
+ * Keep each owned node's context and value. The call goes on
+ * to use the same contexts, and may release them.
+ */
+void SaveActivation(Runner* runner, RunnerActivation* activation){
+  if (runner->savedSpot + activation->length > runner->totalSaved) {
+    runner->totalSaved = (runner->savedSpot + activation->length) * 2;
+    runner->saved = Reallocate(runner->saved, sizeof(RunnerSavedContext) * runner->totalSaved);
+    if (runner->saved == NULL) RUNTIME_ERROR("Out of memory");
+  }
+
+  for (int i = 0; i < activation->length; i++){
+    ASTNode* node = runner->owned[activation->start + i];
+    RunnerContext* context = runner->nodeContexts[node->id - runner->firstNodeId];
+    RunnerSavedContext* saved = &runner->saved[runner->savedSpot++];
+    saved->context = context;
+    saved->value = context != NULL ? context->value : EmptyValue(UNDEFINED);
+  }
+}
+
+/**
+ * Put back what the call changed. Contexts the call took for
+ * nodes that had none are released, and the saved ones are
+ * taken back, even if the call released them.
+ */
+void RestoreActivation(Runner* runner, RunnerActivation* activation){
+  runner->savedSpot -= activation->length;
+  for (int i = 0; i < activation->length; i++){
+    ASTNode* node = runner->owned[activation->start + i];
+    RunnerSavedContext* saved = &runner->saved[runner->savedSpot + i];
+    RunnerContext* current = runner->nodeContexts[node->id - runner->firstNodeId];
+    if (current != NULL && current != saved->context) GCContext(runner, current);
+    if (saved->context == NULL) continue;
+
+    runner->contextUsed[saved->context - runner->contexts] = true;
+    BindContext(runner, saved->context, node);
+    saved->context->value = saved->value;
+  }
+}
+
+/**
+ * The nodes whose contexts belong to one call of func: its
+ * params and everything its statements run, in nested bodies
+ * too. Variables read from outside and the functions it calls
+ * are not its own.
+ */
+void FindOwnedNodes(Runner* runner, ASTNode* func, RunnerActivation* activation){
+  activation->start = runner->ownedSpot;
+  FOREACH_AST(GET_FUNC_PARAMS(func)){
+    AddOwnedNode(runner, item->node);
+  }
+
+  WorkStack scopes;
+  WorkStack nodes;
+  InitWorkStack(&scopes);
+  InitWorkStack(&nodes);
+  PushWork(&scopes, NULL, GET_FUNC_BODY(func), 0);
+  while (!IS_WORK_STACK_EMPTY(&scopes)){
+    int scopeId = PopWork(&scopes).state;
+    ASTNode** statement = &runner->statements[runner->scopeStarts[scopeId]];
+    ASTNode** end = &runner->statements[runner->scopeStarts[scopeId + 1]];
+    for (; statement < end; statement++){
+      PushWork(&nodes, *statement, OWNED_DECLARATION, 0);
+      while (!IS_WORK_STACK_EMPTY(&nodes)){
+        FindOwnedNode(runner, &nodes, &scopes);
+      }
+    }
+  }
+  DestroyWorkStack(&scopes);
+  DestroyWorkStack(&nodes);
+
+  activation->length = runner->ownedSpot - activation->start;
+}
+
+/**
+ * Take the next node of a statement's walk. Bodies it runs
+ * are pushed onto scopes.
+ */
+void FindOwnedNode(Runner* runner, WorkStack* nodes, WorkStack* scopes){
+  WorkItem work = PopWork(nodes);
+  ASTNode* node = work.node;
+  if (node == NULL || node->type == FUNC) return;
+  if (node->type == VAR && work.state == OWNED_READ) return;
+  AddOwnedNode(runner, node);
+
+  int type = (int) node->type;
+  switch (type) {
+    case VAR: {
+      PushWork(nodes, GET_VAR_VALUE(node), OWNED_READ, 0);
+      break;
+    }
+    case BINARY: {
+      if (GET_BIN_OPERANDS(node) != NULL) {
+        FOREACH_AST(GET_BIN_OPERANDS(node)){
+          PushWork(nodes, item->node, OWNED_READ, 0);
+        }
+        break;
+      }
+      PushWork(nodes, GET_BIN_LEFT(node), OWNED_READ, 0);
+      PushWork(nodes, GET_BIN_RIGHT(node), OWNED_READ, 0);
+      break;
+    }
+    case FUNC_CALL: {
+      FOREACH_AST(GET_FUNC_CALL_PARAMS(node)){
+        PushWork(nodes, item->node, OWNED_READ, 0);
+      }
+      break;
+    }
+    case RETURN: {
+      PushWork(nodes, GET_RETURN_VALUE(node), OWNED_READ, 0);
+      break;
+    }
+    case FOR: {
+      PushWork(nodes, GET_FOR_VAR(node), OWNED_DECLARATION, 0);
+      PushWork(nodes, GET_FOR_CONDITION(node), OWNED_READ, 0);
+      PushWork(nodes, GET_FOR_INC(node), OWNED_DECLARATION, 0);
+      PushWork(scopes, NULL, GET_FOR_BODY(node), 0);
+      break;
+    }
+    case WHILE: {
+      PushWork(nodes, GET_WHILE_CONDITION(node), OWNED_READ, 0);
+      PushWork(scopes, NULL, GET_WHILE_BODY(node), 0);
+      break;
+    }
+    case IF: {
+      PushWork(nodes, GET_IF_CONDITION(node), OWNED_READ, 0);
+      PushWork(scopes, NULL, GET_IF_BODY(node), 0);
+      break;
+    }
+    case SWITCH: {
+      PushWork(nodes, GET_SWITCH_CONDITION(node), OWNED_READ, 0);
+      PushWork(scopes, NULL, GET_SWITCH_BODY(node), 0);
+      break;
+    }
+    case CASE: {
+      PushWork(nodes, GET_CASE_CONDITION(node), OWNED_READ, 0);
+      PushWork(scopes, NULL, GET_CASE_BODY(node), 0);
+      break;
+    }
+    case INC:
+    case DEC: break;
+    default: {
+      if (IsAssignment(node->type)) PushWork(nodes, GET_ASSIGN_VALUE(node), OWNED_READ, 0);
+      break;
+    }
+  }
+}
+
+void AddOwnedNode(Runner* runner, ASTNode* node){
+  if (runner->ownedSpot == runner->totalOwned) {
+    runner->totalOwned = runner->totalOwned > 0 ? runner->totalOwned * 2 : 64;
+    runner->owned = Reallocate(runner->owned, sizeof(ASTNode*) * runner->totalOwned);
+    if (runner->owned == NULL) RUNTIME_ERROR("Out of memory");
+  }
+  runner->owned[runner->ownedSpot++] = node;
+}
@@ -0,0 +1,42 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Activations of functions that are called again while they
+ * run, directly or through other functions. A node has one
+ * context at a time, so a call into a running function saves
+ * the contexts of every node the function owns, lets the call
+ * use them, and puts them back once it returns. A function
+ * that is not reentered only has its depth counted.
+ */
+#ifndef RUNNER_ACTIVATION_H_
+#define RUNNER_ACTIVATION_H_
+
+#include "../ast/ast.h"
+#include "../ast/astlist.h"
+#include "../ast/workstack.h"
+#include "../mem/allocate.h"
+#include "utils/assert.h"
+#include "./runner-types.h"
+
+// How FindOwnedNode treats a node it is given
+#define OWNED_DECLARATION 0 // Runs in the function, a VAR declares
+#define OWNED_READ 1 // Read by an expression, a VAR is a reference
+
+void InitActivations(Runner* runner);
+void DestroyActivations(Runner* runner);
+bool EnterActivation(Runner* runner, ASTNode* func);
+void LeaveActivation(Runner* runner, ASTNode* func, bool reentered);
+
+/**
+ * Private Functions
+ */
+RunnerActivation* GetActivation(Runner* runner, ASTNode* func);
+void SaveActivation(Runner* runner, RunnerActivation* activation);
+void RestoreActivation(Runner* runner, RunnerActivation* activation);
+void FindOwnedNodes(Runner* runner, ASTNode* func, RunnerActivation* activation);
+void FindOwnedNode(Runner* runner, WorkStack* nodes, WorkStack* scopes);
+void AddOwnedNode(Runner* runner, ASTNode* node);
+
+#endif // RUNNER_ACTIVATION_H_
@@ -1,65 +1,464 @@
 #include "runner-math.h"
 #include <stdint.h>
 
-double ContextToDouble(RunnerContext* context){
-  int type = (int) context->dataType;
+int ValueToInt(Value value){
+  int type = (int) VALUE_TYPE(value);
   switch (type) {
-    case BOOLEAN: return (double) context->value.vBoolean;
-    case BYTE: return (double) context->value.vByte;
-    case SHORT: return (double) context->value.vShort;
-    case INT: return (double) context->value.vInt;
-    case FLOAT: return (double) context->value.vFloat;
-    case DOUBLE: return (double) context->value.vDouble;
-    case LONG: return (double) context->value.vLong;
+    case BOOLEAN: return (int) VALUE_BOOLEAN(value);
+    case BYTE: return (int) (signed char) VALUE_BYTE(value);
+    case SHORT: return (int) VALUE_SHORT(value);
+    case INT: return VALUE_INT(value);
   }
 
-  RUNTIME_ERROR("Invalid operator")
+  RUNTIME_ERROR("Invalid int operand")
 }
 
-double RunMath(double left, double right, Token op){
+long ValueToLong(Value value){
+  int type = (int) VALUE_TYPE(value);
+  switch (type) {
+    case LONG: return VALUE_LONG(value);
+    case FLOAT: return (long) VALUE_FLOAT(value);
+    case DOUBLE: return (long) VALUE_DOUBLE(value);
+  }
+
+  return (long) ValueToInt(value);
+}
+
+double ValueToDouble(Value value){
+  int type = (int) VALUE_TYPE(value);
+  switch (type) {
+    case FLOAT: return (double) VALUE_FLOAT(value);
+    case DOUBLE: return VALUE_DOUBLE(value);
+    case LONG: return (double) VALUE_LONG(value);
+  }
+
+  return (double) ValueToInt(value);
+}
+
+/**
+ * int/int operations. Computed in 32 bits with an overflow
+ * check. The result type is always int, matching the type the
+ * typechecker predicted, so an overflow is a runtime error
+ * rather than a silently wrapped or widened value.
+ */
+Value RunIntMath(int left, int right, Token op){
+  int value;
+  bool overflow = false;
   int type = (int) op;
   switch (type) {
-    case ADD: return left + right;
-    case SUB: return left - right;
-    case MUL: return left * right;
-    case DIV: return left * right;
+    case ADD: overflow = __builtin_add_overflow(left, right, &value); break;
+    case SUB: overflow = __builtin_sub_overflow(left, right, &value); break;
+    case MUL: overflow = __builtin_mul_overflow(left, right, &value); break;
+    case DIV: {
+      if (right == 0) RUNTIME_ERROR("Division by zero")
+      overflow = left == INT32_MIN && right == -1;
+      if (!overflow) value = left / right;
+      break;
+    }
+    case MOD: {
+      if (right == 0) RUNTIME_ERROR("Division by zero")
+      value = right == -1 ? 0 : left % right;
+      break;
+    }
+    case AND: value = left & right; break;
+    case OR: value = left | right; break;
+    case XOR: value = left ^ right; break;
+    case AND_NOT: value = left & ~right; break;
+    case SHL: {
+      if (right < 0) RUNTIME_ERROR("Negative shift count")
+      value = right >= 32 ? 0 : (int) ((unsigned int) left << right);
+      break;
+    }
+    case SHR: {
+      if (right < 0) RUNTIME_ERROR("Negative shift count")
+      value = left >> (right >= 32 ? 31 : right);
+      break;
+    }
+    case POW: {
+      if (left == 0 && right < 0) RUNTIME_ERROR("Division by zero")
+      long power;
+      overflow = !RunPower(left, right, &power) || power < INT32_MIN || power > INT32_MAX;
+      value = (int) power;
+      break;
+    }
+    default: RUNTIME_ERROR("Invalid operator for math")
   }
 
-  RUNTIME_ERROR("Invalid operator for math")
+  if (overflow) RUNTIME_ERROR("Integer overflow")
+
+  return IntValue(value);
 }
 
-void CastToType(RunnerContext* context){
-  double num = context->value.vDouble;
+/**
+ * long/long operations. Exact 64 bit math, overflow checked
+ * the same way as int.
+ */
+Value RunLongMath(long left, long right, Token op){
+  long value;
+  bool overflow = false;
+  int type = (int) op;
+  switch (type) {
+    case ADD: overflow = __builtin_add_overflow(left, right, &value); break;
+    case SUB: overflow = __builtin_sub_overflow(left, right, &value); break;
+    case MUL: overflow = __builtin_mul_overflow(left, right, &value); break;
+    case DIV: {
+      if (right == 0) RUNTIME_ERROR("Division by zero")
+      overflow = left == INT64_MIN && right == -1;
+      if (!overflow) value = left / right;
+      break;
+    }
+    case MOD: {
+      if (right == 0) RUNTIME_ERROR("Division by zero")
+      value = right == -1 ? 0 : left % right;
+      break;
+    }
+    case AND: value = left & right; break;
+    case OR: value = left | right; break;
+    case XOR: value = left ^ right; break;
+    case AND_NOT: value = left & ~right; break;
+    case SHL: {
+      if (right < 0) RUNTIME_ERROR("Negative shift count")
+      value = right >= 64 ? 0 : (long) ((unsigned long) left << right);
+      break;
+    }
+    case SHR: {
+      if (right < 0) RUNTIME_ERROR("Negative shift count")
+      value = left >> (right >= 64 ? 63 : right);
+      break;
+    }
+    case POW: {
+      if (left == 0 && right < 0) RUNTIME_ERROR("Division by zero")
+      overflow = !RunPower(left, right, &value);
+      break;
+    }
+    default: RUNTIME_ERROR("Invalid operator for math")
+  }
+
+  if (overflow) RUNTIME_ERROR("Integer overflow")
 
-  if (num == 0 || num == 1) {
-    context->value.vBoolean = (bool) num;
-    context->dataType = BOOLEAN;
+  return LongValue(value);
+}
+
+/**
+ * base ** exponent by squaring, false when it overflows a
+ * long. A negative exponent truncates the way division does,
+ * 1 / base ** -exponent, so only 1 and -1 keep a magnitude;
+ * a zero base must be reported before.
+ */
+bool RunPower(long base, long exponent, long* result){
+  if (exponent < 0) {
+    *result = base == 1 ? 1 : base == -1 ? (exponent % 2 == 0 ? 1 : -1) : 0;
+    return true;
   }
-  else if (INT8_MIN <= num && INT8_MAX >= num) {
-    context->value.vByte = (unsigned char) num;
-    context->dataType = BYTE;
+
+  long value = 1;
+  while (exponent > 0) {
+    if ((exponent & 1) && __builtin_mul_overflow(value, base, &value)) return false;
+    exponent >>= 1;
+    if (exponent > 0 && __builtin_mul_overflow(base, base, &base)) return false;
   }
-  else if (INT16_MIN <= num && INT16_MAX >= num) {
-    context->value.vShort = (short) num;
-    context->dataType = SHORT;
+  *result = value;
+  return true;
+}
+
+/**
+ * float/float and double/double operations. A float result is
+ * computed in double and rounded once, which gives the same
+ * answer as native float math for + - * /.
+ */
+Value RunDoubleMath(double left, double right, Token op, Token resultType){
+  double value;
+  int type = (int) op;
+  switch (type) {
+    case ADD: value = left + right; break;
+    case SUB: value = left - right; break;
+    case MUL: value = left * right; break;
+    case DIV: value = left / right; break;
+    case MOD: value = fmod(left, right); break;
+    case POW: value = pow(left, right); break;
+    default: RUNTIME_ERROR("Invalid operator for math")
+  }
+
+  if (resultType == FLOAT) return FloatValue((float) value);
+  return DoubleValue(value);
+}
+
+/**
+ * Dispatch on the operand type pair. Matching pairs are found
+ * with a type test and read directly, longs and doubles first
+ * since literals have those types; mixed pairs are widened
+ * to the promoted type first. Integer pairs never touch
+ * floating point.
+ */
+Value RunMath(Value left, Value right, Token op){
+  if (VALUE_IS_LONG(left) && VALUE_IS_LONG(right)) {
+    return RunLongMath(VALUE_LONG(left), VALUE_LONG(right), op);
   }
-  else if (INT32_MIN <= num && INT32_MAX >= num) {
-    context->value.vShort = (int) num;
-    context->dataType = INT;
+  if (VALUE_IS_DOUBLE(left) && VALUE_IS_DOUBLE(right)) {
+    return RunDoubleMath(VALUE_DOUBLE(left), VALUE_DOUBLE(right), op, DOUBLE);
   }
-  else if (INT64_MIN <= num && INT64_MAX >= num) {
-    context->value.vLong = (long) num;
-    context->dataType = LONG;
+  if (VALUE_IS_INT(left) && VALUE_IS_INT(right)) {
+    return RunIntMath(VALUE_INT(left), VALUE_INT(right), op);
   }
-  else if (FLT_MIN <= num && FLT_MAX >= num) {
-    context->value.vFloat = (float) num;
-    context->dataType = FLOAT;
+
+  int type = (int) GetPromotedType(VALUE_TYPE(left), VALUE_TYPE(right));
+  switch (type) {
+    case INT: return RunIntMath(ValueToInt(left), ValueToInt(right), op);
+    case LONG: return RunLongMath(ValueToLong(left), ValueToLong(right), op);
+    case FLOAT: return RunDoubleMath(ValueToDouble(left), ValueToDouble(right), op, FLOAT);
+    case DOUBLE: return RunDoubleMath(ValueToDouble(left), ValueToDouble(right), op, DOUBLE);
   }
-  else if (DBL_MIN <= num && DBL_MAX >= num) {
-    context->value.vFloat = (double) num;
-    context->dataType = DOUBLE;
+
+  RUNTIME_ERROR("Invalid operand types for math")
+}
+
+/**
+ * Whether RunMath would finish without a runtime error, so a
+ * constant expression can be computed ahead of time. Division
+ * by zero, negative shifts and integer overflow are left for
+ * the runner to report when the expression actually runs.
+ */
+bool CanRunMath(Value left, Value right, Token op){
+  if (!IsNumber(VALUE_TYPE(left)) || !IsNumber(VALUE_TYPE(right))) return false;
+
+  Token type = GetPromotedType(VALUE_TYPE(left), VALUE_TYPE(right));
+  if (type == FLOAT || type == DOUBLE) {
+    return op == ADD || op == SUB || op == MUL || op == DIV || op == MOD || op == POW;
+  }
+
+  long l = ValueToLong(left);
+  long r = ValueToLong(right);
+  long value;
+  int operator = (int) op;
+  switch (operator) {
+    case ADD: if (__builtin_add_overflow(l, r, &value)) return false; break;
+    case SUB: if (__builtin_sub_overflow(l, r, &value)) return false; break;
+    case MUL: if (__builtin_mul_overflow(l, r, &value)) return false; break;
+    case DIV:
+    case MOD: {
+      if (r == 0) return false;
+      if (r == -1 && l == (type == INT ? INT32_MIN : INT64_MIN)) return op == MOD;
+      value = op == DIV ? l / r : (r == -1 ? 0 : l % r);
+      break;
+    }
+    case AND: case OR: case XOR: case AND_NOT: return true;
+    case SHL: {
+      if (r < 0) return false;
+      if (type == INT) return true;
+      value = r >= 64 ? 0 : (long) ((unsigned long) l << r);
+      break;
+    }
+    case SHR: return r >= 0;
+    case POW: {
+      if (l == 0 && r < 0) return false;
+      if (!RunPower(l, r, &value)) return false;
+      break;
+    }
+    default: return false;
+  }
+
+  if (type == INT) return value >= INT32_MIN && value <= INT32_MAX;
+#if NAN_BOXING
+  return value >= NB_LONG_MIN && value <= NB_LONG_MAX;
+#else
+  return true;
+#endif
+}
+
+/**
+ * Integer math against a constant power of two, 2^shift, or
+ * a constant shift count, as marked by ReduceStrength. No
+ * multiply or divide is issued:
+ *  - x * 2^k is a shift, checked for overflow by shifting back
+ *  - x / 2^k and x % 2^k add a bias to negative values so the
+ *    shift and mask round toward zero like C division
+ *  - shifts by a constant skip the count checks
+ * Values are handled in 64 bits and truncated for int results,
+ * which gives the same bits as 32 bit math for all of these.
+ */
+Value RunReducedMath(Value left, int shift, Token op){
+  Token type = VALUE_IS_LONG(left) ? LONG : INT;
+  long value = ValueToLong(left);
+  long mask = shift < 63 ? (1L << shift) - 1 : INT64_MAX;
+  long bias = (value >> 63) & mask;
+
+  int t = (int) op;
+  switch (t) {
+    case MUL: {
+      long shifted = (long) ((unsigned long) value << shift);
+      if ((shifted >> shift) != value) RUNTIME_ERROR("Integer overflow")
+      if (type == INT && (shifted < INT32_MIN || shifted > INT32_MAX)) RUNTIME_ERROR("Integer overflow")
+      value = shifted;
+      break;
+    }
+    case DIV: value = (value + bias) >> shift; break;
+    case MOD: value = ((value + bias) & mask) - bias; break;
+    case SHL: {
+      int width = type == LONG ? 64 : 32;
+      value = shift >= width ? 0 : (long) ((unsigned long) value << shift);
+      break;
+    }
+    case SHR: value = value >> (shift > 63 ? 63 : shift); break;
+    default: RUNTIME_ERROR("Invalid reduced operator")
+  }
+
+  if (type == LONG) return LongValue(value);
+  return IntValue((int) value);
+}
+
+/**
+ * A value converted to the given type. Used when a value is
+ * assigned to a declared variable. Non numeric types keep
+ * the value as is. An integer type too small for the value
+ * is an overflow, see CastFits.
+ */
+Value CastValue(Value from, Token type){
+  if (!CastFits(from, type)) RUNTIME_ERROR("Integer overflow")
+  int t = (int) type;
+  switch (t) {
+    case BOOLEAN: return BooleanValue(ValueToLong(from) != 0);
+    case BYTE: return ByteValue((unsigned char) ValueToLong(from));
+    case SHORT: return ShortValue((short) ValueToLong(from));
+    case INT: return IntValue((int) ValueToLong(from));
+    case LONG: return LongValue(ValueToLong(from));
+    case FLOAT: return FloatValue((float) ValueToDouble(from));
+    case DOUBLE: return DoubleValue(ValueToDouble(from));
+  }
+
+  return from;
+}
+
+/**
+ * Whether a number keeps its value, less any fraction, once
+ * cast to an integer type. Always true for the other types.
+ */
+bool CastFits(Value from, Token type){
+  long min, max;
+  int t = (int) type;
+  switch (t) {
+    case BYTE: min = SCHAR_MIN; max = SCHAR_MAX; break;
+    case SHORT: min = SHRT_MIN; max = SHRT_MAX; break;
+    case INT: min = INT_MIN; max = INT_MAX; break;
+    case LONG: min = LONG_MIN; max = LONG_MAX; break;
+    default: return true;
+  }
+
+  Token fromType = VALUE_TYPE(from);
+  if (IsIntegerType(fromType)) {
+    long value = ValueToLong(from);
+    return value >= min && value <= max;
+  }
+  if (!IsNumber(fromType)) return true;
+
+  // NaN fails both
+  double value = ValueToDouble(from);
+  return value > (double) min - 1 && value < (double) max + 1;
+}
+
+/**
+ * The outcomes accepted by each comparison operator. NaN is
+ * unordered, so it only satisfies !=.
+ */
+int CompareMask(Token op){
+  int type = (int) op;
+  switch (type) {
+    case LESS: return COMPARE_LESS;
+    case LEQ: return COMPARE_LESS | COMPARE_EQUAL;
+    case EQL: return COMPARE_EQUAL;
+    case GEQ: return COMPARE_GREATER | COMPARE_EQUAL;
+    case GREATER: return COMPARE_GREATER;
+    case NEQ: return COMPARE_LESS | COMPARE_GREATER | COMPARE_UNORDERED;
+  }
+
+  RUNTIME_ERROR("Invalid comparison operator")
+}
+
+/**
+ * The operands are reduced to outcome bits with flag-setting
+ * compares and tested against the operator's mask, so no
+ * branch depends on the values themselves.
+ */
+bool RunCompare(Value left, Value right, Token op){
+  int outcome;
+
+  if (VALUE_IS_LONG(left) && VALUE_IS_LONG(right)) {
+    outcome = COMPARE_INTS(VALUE_LONG(left), VALUE_LONG(right));
+  }
+  else if (VALUE_IS_DOUBLE(left) && VALUE_IS_DOUBLE(right)) {
+    outcome = COMPARE_DOUBLES(VALUE_DOUBLE(left), VALUE_DOUBLE(right));
+  }
+  else if (VALUE_IS_INT(left) && VALUE_IS_INT(right)) {
+    outcome = COMPARE_INTS(VALUE_INT(left), VALUE_INT(right));
+  }
+  else if (VALUE_IS_STRING(left) || VALUE_IS_STRING(right)) {
+    if (!VALUE_IS_STRING(left) || !VALUE_IS_STRING(right)) RUNTIME_ERROR("Invalid comparison against string")
+    int order = strcmp(VALUE_STRING(left), VALUE_STRING(right));
+    outcome = COMPARE_INTS(order, 0);
   }
   else {
-    RUNTIME_ERROR("Unknown data type")
+    Token type = GetPromotedType(VALUE_TYPE(left), VALUE_TYPE(right));
+    if (type == FLOAT || type == DOUBLE) {
+      double l = ValueToDouble(left);
+      double r = ValueToDouble(right);
+      outcome = COMPARE_DOUBLES(l, r);
+    }
+    else {
+      long l = ValueToLong(left);
+      long r = ValueToLong(right);
+      outcome = COMPARE_INTS(l, r);
+    }
   }
-}
\ No newline at end of file
+
+  return (outcome & CompareMask(op)) != 0;
+}
+
+bool ValuesEqual(Value left, Value right){
+  return RunCompare(left, right, EQL);
+}
+
+bool IsValueTrue(Value value){
+  int type = (int) VALUE_TYPE(value);
+  switch (type) {
+    case BOOLEAN: return VALUE_BOOLEAN(value);
+    case FLOAT: return VALUE_FLOAT(value) != 0;
+    case DOUBLE: return VALUE_DOUBLE(value) != 0;
+    case LONG: return VALUE_LONG(value) != 0;
+    case STRING: return VALUE_STRING(value) != NULL;
+    case UNDEFINED: return false;
+  }
+
+  return ValueToInt(value) != 0;
+}
+
+/**
+ * ++ and -- on a variable's value, keeping its type
+ */
+Value IncrementValue(Value value, int amount){
+  int type = (int) VALUE_TYPE(value);
+  switch (type) {
+    case BYTE: {
+      signed char result;
+      if (__builtin_add_overflow((signed char) VALUE_BYTE(value), amount, &result)) RUNTIME_ERROR("Integer overflow")
+      return ByteValue((unsigned char) result);
+    }
+    case SHORT: {
+      short result;
+      if (__builtin_add_overflow(VALUE_SHORT(value), amount, &result)) RUNTIME_ERROR("Integer overflow")
+      return ShortValue(result);
+    }
+    case INT: {
+      int result;
+      if (__builtin_add_overflow(VALUE_INT(value), amount, &result)) RUNTIME_ERROR("Integer overflow")
+      return IntValue(result);
+    }
+    case LONG: {
+      long result;
+      if (__builtin_add_overflow(VALUE_LONG(value), (long) amount, &result)) RUNTIME_ERROR("Integer overflow")
+      return LongValue(result);
+    }
+    case FLOAT: return FloatValue(VALUE_FLOAT(value) + amount);
+    case DOUBLE: return DoubleValue(VALUE_DOUBLE(value) + amount);
+  }
+
+  RUNTIME_ERROR("Invalid operand for increment")
+}
@@ -7,11 +7,41 @@
 
 #include <limits.h>
 #include <float.h>
+#include <math.h>
 #include "../ast/ast.h"
+#include "../number/number.h"
 #include "./runner-types.h"
 
-double ContextToDouble(RunnerContext* context);
-double RunMath(double left, double right, Token op);
-void CastToType(RunnerContext* context);
+/**
+ * Outcome bits of comparing two values. A comparison
+ * operator is the set of outcomes it accepts, see CompareMask.
+ */
+#define COMPARE_LESS 1
+#define COMPARE_EQUAL 2
+#define COMPARE_GREATER 4
+#define COMPARE_UNORDERED 8
+
+#define COMPARE_INTS(left, right) \
+  (((left) < (right)) | (((left) == (right)) << 1) | (((left) > (right)) << 2))
+#define COMPARE_DOUBLES(left, right) \
+  (COMPARE_INTS(left, right) | (((left) != (left) || (right) != (right)) << 3))
+
+int ValueToInt(Value value);
+long ValueToLong(Value value);
+double ValueToDouble(Value value);
+Value RunIntMath(int left, int right, Token op);
+Value RunLongMath(long left, long right, Token op);
+bool RunPower(long base, long exponent, long* result);
+Value RunDoubleMath(double left, double right, Token op, Token resultType);
+Value RunMath(Value left, Value right, Token op);
+bool CanRunMath(Value left, Value right, Token op);
+Value RunReducedMath(Value left, int shift, Token op);
+Value CastValue(Value from, Token type);
+bool CastFits(Value from, Token type);
+int CompareMask(Token op);
+bool RunCompare(Value left, Value right, Token op);
+bool ValuesEqual(Value left, Value right);
+bool IsValueTrue(Value value);
+Value IncrementValue(Value value, int amount);
 
 #endif // RUNNER_MATH_H_
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "runner-memo.h"
+
+void InitMemoTable(MemoTable* memo, ASTNode* func){
+  memo->func = func;
+  memo->arity = 0;
+  FOREACH_AST(GET_FUNC_PARAMS(func)) {
+    memo->arity++;
+  }
+  memo->keys = Allocate(sizeof(Value) * MEMO_TABLE_SIZE * memo->arity);
+  memo->results = Allocate(sizeof(Value) * MEMO_TABLE_SIZE);
+  memo->used = Allocate(sizeof(bool) * MEMO_TABLE_SIZE);
+  memo->hits = 0;
+  memo->misses = 0;
+  for (int i = 0; i < MEMO_TABLE_SIZE; i++) {
+    memo->used[i] = false;
+  }
+}
+
+void DestroyMemoTable(MemoTable* memo){
+  Free(memo->keys);
+  Free(memo->results);
+  Free(memo->used);
+}
+
+/**
+ * The stored result for these argument values, if any
+ */
+bool LookupMemo(MemoTable* memo, Value* key, Value* result){
+  bool found;
+  int slot = FindMemoSlot(memo, key, &found);
+  if (!found) {
+    memo->misses++;
+    return false;
+  }
+
+  memo->hits++;
+  *result = memo->results[slot];
+  return true;
+}
+
+void StoreMemo(MemoTable* memo, Value* key, Value result){
+  bool found;
+  int slot = FindMemoSlot(memo, key, &found);
+  memcpy(&memo->keys[slot * memo->arity], key, sizeof(Value) * memo->arity);
+  memo->results[slot] = result;
+  memo->used[slot] = true;
+}
+
+/**
+ * The key's slot, or where it would go: the first free slot
+ * among MEMO_PROBES from its home slot, or the home slot
+ * itself when they are all taken.
+ */
+int FindMemoSlot(MemoTable* memo, Value* key, bool* found){
+  uint64_t hash = 1469598103934665603UL;
+  for (int i = 0; i < memo->arity; i++) {
+    hash = (hash ^ GetValueBits(key[i]) ^ (uint64_t) VALUE_TYPE(key[i])) * 1099511628211UL;
+  }
+
+  int home = (int) ((hash ^ (hash >> 32)) & (MEMO_TABLE_SIZE - 1));
+  int free = -1;
+  *found = false;
+  for (int probe = 0; probe < MEMO_PROBES; probe++) {
+    int slot = (home + probe) & (MEMO_TABLE_SIZE - 1);
+    if (!memo->used[slot]) {
+      if (free < 0) free = slot;
+      continue;
+    }
+
+    Value* stored = &memo->keys[slot * memo->arity];
+    int i = 0;
+    while (i < memo->arity && IsSameValue(stored[i], key[i])) i++;
+    if (i == memo->arity) {
+      *found = true;
+      return slot;
+    }
+  }
+  return free >= 0 ? free : home;
+}
+
+/**
+ * Same type and same bits, so 0.0 and -0.0 are different
+ * arguments while a NaN matches itself
+ */
+bool IsSameValue(Value left, Value right){
+  return VALUE_TYPE(left) == VALUE_TYPE(right) && GetValueBits(left) == GetValueBits(right);
+}
+
+uint64_t GetValueBits(Value value){
+#if NAN_BOXING
+  return value;
+#else
+  int type = (int) VALUE_TYPE(value);
+  switch (type) {
+    case BOOLEAN: return VALUE_BOOLEAN(value);
+    case BYTE: return VALUE_BYTE(value);
+    case SHORT: return (uint16_t) VALUE_SHORT(value);
+    case INT: return (uint32_t) VALUE_INT(value);
+    case CHAR: return (unsigned char) VALUE_CHAR(value);
+    case LONG: return (uint64_t) VALUE_LONG(value);
+    case STRING: return (uint64_t) (uintptr_t) VALUE_STRING(value);
+    case FLOAT: {
+      uint32_t bits;
+      float f = VALUE_FLOAT(value);
+      memcpy(&bits, &f, sizeof(bits));
+      return bits;
+    }
+    case DOUBLE: {
+      uint64_t bits;
+      double d = VALUE_DOUBLE(value);
+      memcpy(&bits, &d, sizeof(bits));
+      return bits;
+    }
+  }
+  return 0;
+#endif
+}
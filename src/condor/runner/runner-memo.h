@@ -0,0 +1,28 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Memo tables for pure functions. A call whose argument
+ * values were seen before returns the stored result without
+ * running the body. See RunFuncWithArgs.
+ */
+#ifndef RUNNER_MEMO_H_
+#define RUNNER_MEMO_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "../ast/ast.h"
+#include "../ast/astlist.h"
+#include "../mem/allocate.h"
+#include "./runner-types.h"
+
+void InitMemoTable(MemoTable* memo, ASTNode* func);
+void DestroyMemoTable(MemoTable* memo);
+bool LookupMemo(MemoTable* memo, Value* key, Value* result);
+void StoreMemo(MemoTable* memo, Value* key, Value result);
+int FindMemoSlot(MemoTable* memo, Value* key, bool* found);
+bool IsSameValue(Value left, Value right);
+uint64_t GetValueBits(Value value);
+
+#endif // RUNNER_MEMO_H_
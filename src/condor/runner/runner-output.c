@@ -0,0 +1,131 @@
+#include "runner-output.h"
+
+// The output flushed at exit, the last one initialized
+RunnerOutput* ActiveOutput = NULL;
+bool FlushRegistered = false;
+
+void InitFdOutput(RunnerOutput* output, int fd) {
+  InitOutput(output, OUTPUT_FD);
+  output->fd = fd;
+}
+
+void InitCallbackOutput(RunnerOutput* output, OutputCallback callback, void* user) {
+  InitOutput(output, OUTPUT_CALLBACK);
+  output->callback = callback;
+  output->user = user;
+}
+
+void InitMemoryOutput(RunnerOutput* output) {
+  InitOutput(output, OUTPUT_MEMORY);
+}
+
+void InitOutput(RunnerOutput* output, int destination) {
+  output->destination = destination;
+  output->length = 0;
+  output->capacity = OUTPUT_BUFFER_SIZE;
+  output->buffer = Allocate(output->capacity);
+  output->fd = -1;
+  output->callback = NULL;
+  output->user = NULL;
+  if (output->buffer == NULL) RUNTIME_ERROR("Out of memory for the output");
+
+  ActiveOutput = output;
+  if (!FlushRegistered) {
+    atexit(FlushActiveOutput);
+    FlushRegistered = true;
+  }
+}
+
+void DestroyOutput(RunnerOutput* output) {
+  FlushOutput(output);
+  if (ActiveOutput == output) ActiveOutput = NULL;
+  if (output->buffer != NULL) Free(output->buffer);
+  output->buffer = NULL;
+  output->length = 0;
+}
+
+void WriteOutput(RunnerOutput* output, const char* data, int length) {
+  if (output->length + length > output->capacity) {
+    if (output->destination == OUTPUT_MEMORY) {
+      GrowOutput(output, output->length + length);
+    }
+    else {
+      FlushOutput(output);
+
+      // Too big to gather, pass it on as is
+      if (length > output->capacity) {
+        DeliverOutput(output, data, length);
+        return;
+      }
+    }
+  }
+  memcpy(&output->buffer[output->length], data, length);
+  output->length += length;
+}
+
+/**
+ * Memory has nowhere to go, it stays until taken
+ */
+void FlushOutput(RunnerOutput* output) {
+  if (output->destination == OUTPUT_MEMORY || output->length == 0) return;
+
+  // Anything printf left in stdout's buffer came first
+  if (output->fd == STDOUT_FILENO) fflush(stdout);
+  DeliverOutput(output, output->buffer, output->length);
+  output->length = 0;
+}
+
+/**
+ * The written bytes, which the caller now owns and frees. The
+ * output starts over empty.
+ */
+char* TakeOutputMemory(RunnerOutput* output, int* length) {
+  GrowOutput(output, output->length + 1);
+  char* memory = output->buffer;
+  memory[output->length] = '\0';
+  *length = output->length;
+
+  output->capacity = OUTPUT_BUFFER_SIZE;
+  output->buffer = Allocate(output->capacity);
+  output->length = 0;
+  if (output->buffer == NULL) RUNTIME_ERROR("Out of memory for the output");
+  return memory;
+}
+
+void DeliverOutput(RunnerOutput* output, const char* data, int length) {
+  if (output->destination == OUTPUT_CALLBACK) {
+    output->callback(data, length, output->user);
+    return;
+  }
+
+  while (length > 0) {
+    ssize_t written = write(output->fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    data += written;
+    length -= (int) written;
+  }
+}
+
+void GrowOutput(RunnerOutput* output, int length) {
+  if (length <= output->capacity) return;
+  int capacity = output->capacity;
+  while (capacity < length) capacity *= 2;
+  char* buffer = Reallocate(output->buffer, capacity);
+  if (buffer == NULL) RUNTIME_ERROR("Out of memory for the output");
+  output->buffer = buffer;
+  output->capacity = capacity;
+}
+
+/**
+ * At exit whatever printf left in stdout's buffer is an error
+ * that came after the results, so the results go out first
+ */
+void FlushActiveOutput(void) {
+  RunnerOutput* output = ActiveOutput;
+  if (output == NULL || output->destination == OUTPUT_MEMORY || output->length == 0) return;
+  DeliverOutput(output, output->buffer, output->length);
+  output->length = 0;
+}
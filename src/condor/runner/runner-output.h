@@ -0,0 +1,64 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Where the results of top-level statements go. Writes are
+ * gathered in a buffer and handed to the destination when it
+ * fills and when the output is flushed or destroyed: a file
+ * descriptor, a callback, or memory that grows to hold it all.
+ *
+ * The output being used is flushed when the process exits, so
+ * results printed before a runtime error are not lost.
+ */
+#ifndef RUNNER_OUTPUT_H_
+#define RUNNER_OUTPUT_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "../mem/allocate.h"
+#include "utils/assert.h"
+
+#ifndef OUTPUT_BUFFER_SIZE
+#define OUTPUT_BUFFER_SIZE 65536
+#endif
+
+#define OUTPUT_FD 1
+#define OUTPUT_CALLBACK 2
+#define OUTPUT_MEMORY 3
+
+typedef void (*OutputCallback)(const char* data, int length, void* user);
+
+typedef struct RunnerOutput {
+  int destination;
+  char* buffer;
+  int length;
+  int capacity; // Grows for OUTPUT_MEMORY only
+  int fd;
+  OutputCallback callback;
+  void* user;
+} RunnerOutput;
+
+/**
+ * Public Functions
+ */
+void InitFdOutput(RunnerOutput* output, int fd);
+void InitCallbackOutput(RunnerOutput* output, OutputCallback callback, void* user);
+void InitMemoryOutput(RunnerOutput* output);
+void DestroyOutput(RunnerOutput* output);
+void WriteOutput(RunnerOutput* output, const char* data, int length);
+void FlushOutput(RunnerOutput* output);
+char* TakeOutputMemory(RunnerOutput* output, int* length);
+
+/**
+ * Private Functions
+ */
+void InitOutput(RunnerOutput* output, int destination);
+void DeliverOutput(RunnerOutput* output, const char* data, int length);
+void GrowOutput(RunnerOutput* output, int length);
+void FlushActiveOutput(void);
+
+#endif // RUNNER_OUTPUT_H_
@@ -6,33 +6,169 @@
 #define RUNNER_TYPES_H_
 
 #include "../ast/ast.h"
+#include "./runner-value.h"
+#include "./runner-output.h"
 
+/**
+ * A slot holding the value of one node. The slot's index in
+ * Runner.contexts is its position, so it carries no id.
+ */
 typedef struct RunnerContext {
+  Value value;
   ASTNode* node;
-  Token dataType;
-	int id;
-
-  union {
-		bool vBoolean;
-		unsigned char vByte;
-		short vShort;
-		int vInt;
-		float vFloat;
-		double vDouble;
-		long vLong;
-		char vChar;
-		char* vString;
-	} value;
-
 } RunnerContext;
 
+/**
+ * A binary expression waiting on its operands, see RunBinary
+ */
+#define FRAME_START 0
+#define FRAME_LEFT 1
+#define FRAME_RIGHT 2
+
+// Initial number of frames, doubled when a deeper tree needs more
+#define RUNNER_FRAMES 64
+
+/**
+ * C stack a run may take before a call is refused, so deep
+ * recursion stops with an error well inside the usual 8MB
+ */
+#ifndef RUNNER_STACK_LIMIT
+#define RUNNER_STACK_LIMIT (6 * 1024 * 1024)
+#endif
+
+typedef struct RunnerFrame {
+  ASTNode* node;
+  RunnerContext* left; // The left operand's value once known
+  ASTListItem* item; // The next operand of a flattened chain
+  int state;
+} RunnerFrame;
+
+/**
+ * Slots in each memoized function's table, a power of two.
+ * 0 turns memoization off. See FindPureFunctions.
+ */
+#ifndef MEMO_TABLE_SIZE
+#define MEMO_TABLE_SIZE 256
+#endif
+
+// The home slot is the key's hash masked by the size less one
+#if MEMO_TABLE_SIZE > 0 && (MEMO_TABLE_SIZE & (MEMO_TABLE_SIZE - 1))
+#error "MEMO_TABLE_SIZE must be a power of two"
+#endif
+
+// Slots tried from a key's home slot before one is replaced
+#define MEMO_PROBES 4
+
+/**
+ * Results of a pure function by argument values, an open
+ * addressing table of a fixed size. Slot i holds the
+ * arguments keys[i * arity] up to keys[i * arity + arity].
+ */
+typedef struct MemoTable {
+  ASTNode* func;
+  int arity;
+  Value* keys;
+  Value* results;
+  bool* used;
+  int hits;
+  int misses;
+} MemoTable;
+
+/**
+ * A function's calls that are running, and the nodes it owns,
+ * by the function's node index. See runner-activation.h.
+ */
+typedef struct RunnerActivation {
+  int depth;
+  int start; // In Runner.owned, -1 until the function reenters
+  int length;
+} RunnerActivation;
+
+/**
+ * What one of a function's nodes held when it was reentered
+ */
+typedef struct RunnerSavedContext {
+  RunnerContext* context; // NULL when the node had none
+  Value value;
+} RunnerSavedContext;
+
 typedef struct Runner {
   Scope* scope;
   ASTNode* currentNode;
   RunnerContext* contexts;
 	bool* contextUsed;
 
+  /**
+   * The context holding each node's value, indexed by the
+   * node id minus firstNodeId. Replaces scanning every
+   * context to find a node's value.
+   */
+  RunnerContext** nodeContexts;
+  int firstNodeId;
+
+  /**
+   * Statements grouped by scope id, so running a body does
+   * not walk every node. The statements of scope n are
+   * statements[scopeStarts[n]] up to statements[scopeStarts[n + 1]].
+   */
+  ASTNode** statements;
+  int* scopeStarts;
+  int totalScopes;
+
+  /**
+   * BREAK or RETURN while the enclosing loop or function
+   * is being left, otherwise UNDEFINED. Each body checks it
+   * after every statement and stops early.
+   */
+  Token control;
+
+  /**
+   * Where the running function's RETURN writes its value,
+   * the caller's slot. NULL outside of a call.
+   */
+  RunnerContext* returnSlot;
+
+  /**
+   * The statement being run in the innermost body. Shared
+   * expressions are only computed by their owner statement,
+   * see IsReusedValue.
+   */
+  ASTNode* statement;
+
+  /**
+   * Binary expressions being evaluated, in place of the C
+   * stack. Grows on demand, shared by nested calls.
+   */
+  RunnerFrame* frames;
+  int frameSpot;
+  int totalFrames;
+
+  // The C stack where the run started, see RUNNER_STACK_LIMIT
+  char* stackBase;
+
   int totalContexts;
+
+  // By the function's memo index
+  MemoTable* memos;
+  int totalMemos;
+
+  /**
+   * A call into a function that is already running saves
+   * the contexts of the nodes it owns, see SaveActivation
+   */
+  RunnerActivation* activations;
+  ASTNode** owned;
+  int ownedSpot;
+  int totalOwned;
+  RunnerSavedContext* saved;
+  int savedSpot;
+  int totalSaved;
+
+  // No context below this index is free
+  int firstFreeContext;
+
+  // Takes the results of top-level statements
+  RunnerOutput* output;
 } Runner;
 
 #endif // RUNNER_TYPES_H_
\ No newline at end of file
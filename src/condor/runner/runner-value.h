@@ -0,0 +1,185 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * A runtime value. By default it is a tagged struct: the
+ * type token next to a union, 16 bytes. Building with
+ * NAN_BOXING packs it into one 64 bit word:
+ *
+ *   double  any bit pattern that is not a negative quiet NaN,
+ *           NaNs are stored as the canonical positive NaN
+ *   small   0xFFF9 | 16 bit type token | 32 bit payload, for
+ *           boolean, byte, short, int, float, char and the
+ *           value-less types such as UNDEFINED
+ *   long    0xFFFA | 48 bit signed payload
+ *   string  0xFFFB | 48 bit pointer
+ *
+ * Type checks are bit tests on the top half of the word, and
+ * values are passed to and returned from the math handlers
+ * in a register. A long outside of +/-2^47 does not fit and
+ * is reported as an integer overflow in this mode.
+ */
+#ifndef RUNNER_VALUE_H_
+#define RUNNER_VALUE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "condor/token/token.h"
+#include "utils/assert.h"
+
+#if NAN_BOXING
+
+typedef uint64_t Value;
+
+#define NB_QNAN 0xFFF8000000000000UL
+#define NB_TAG_MASK 0xFFFF000000000000UL
+#define NB_PAYLOAD_MASK 0x0000FFFFFFFFFFFFUL
+#define NB_SMALL 0xFFF9000000000000UL
+#define NB_LONG 0xFFFA000000000000UL
+#define NB_STRING 0xFFFB000000000000UL
+#define NB_CANONICAL_NAN 0x7FF8000000000000UL
+#define NB_LONG_MIN (-(1L << 47))
+#define NB_LONG_MAX ((1L << 47) - 1)
+
+// The top 32 bits of a small value of the given type
+#define NB_SMALL_HIGH(type) ((uint32_t) (NB_SMALL >> 32) | (uint32_t) (type))
+
+#define VALUE_IS_DOUBLE(v) (((v) & NB_QNAN) != NB_QNAN)
+#define VALUE_IS_LONG(v) (((v) & NB_TAG_MASK) == NB_LONG)
+#define VALUE_IS_STRING(v) (((v) & NB_TAG_MASK) == NB_STRING)
+#define VALUE_IS_SMALL(v, type) ((uint32_t) ((v) >> 32) == NB_SMALL_HIGH(type))
+#define VALUE_IS_INT(v) VALUE_IS_SMALL(v, INT)
+
+#define VALUE_BOOLEAN(v) ((bool) ((v) & 1))
+#define VALUE_BYTE(v) ((unsigned char) (v))
+#define VALUE_SHORT(v) ((short) (v))
+#define VALUE_INT(v) ((int) (uint32_t) (v))
+#define VALUE_CHAR(v) ((char) (v))
+#define VALUE_LONG(v) (((long) ((v) << 16)) >> 16)
+#define VALUE_STRING(v) ((char*) (uintptr_t) ((v) & NB_PAYLOAD_MASK))
+
+static inline Token VALUE_TYPE(Value v){
+  if (VALUE_IS_DOUBLE(v)) return DOUBLE;
+  if (VALUE_IS_LONG(v)) return LONG;
+  if (VALUE_IS_STRING(v)) return STRING;
+  return (Token) ((v >> 32) & 0xFFFF);
+}
+
+static inline double VALUE_DOUBLE(Value v){
+  double d;
+  memcpy(&d, &v, sizeof(d));
+  return d;
+}
+
+static inline float VALUE_FLOAT(Value v){
+  uint32_t bits = (uint32_t) v;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static inline Value SmallValue(Token type, uint32_t payload){
+  return ((Value) NB_SMALL_HIGH(type) << 32) | payload;
+}
+
+static inline Value DoubleValue(double d){
+  if (d != d) return NB_CANONICAL_NAN;
+  Value v;
+  memcpy(&v, &d, sizeof(v));
+  return v;
+}
+
+static inline Value FloatValue(float f){
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return SmallValue(FLOAT, bits);
+}
+
+static inline Value LongValue(long l){
+  if (l < NB_LONG_MIN || l > NB_LONG_MAX) RUNTIME_ERROR("Integer overflow")
+  return NB_LONG | ((Value) l & NB_PAYLOAD_MASK);
+}
+
+static inline Value StringValue(char* s){
+  return NB_STRING | ((Value) (uintptr_t) s & NB_PAYLOAD_MASK);
+}
+
+static inline Value BooleanValue(bool b){ return SmallValue(BOOLEAN, b); }
+static inline Value ByteValue(unsigned char b){ return SmallValue(BYTE, b); }
+static inline Value ShortValue(short s){ return SmallValue(SHORT, (uint16_t) s); }
+static inline Value IntValue(int i){ return SmallValue(INT, (uint32_t) i); }
+static inline Value CharValue(char c){ return SmallValue(CHAR, (unsigned char) c); }
+
+#else
+
+typedef struct Value {
+  Token type;
+  union {
+    bool vBoolean;
+    unsigned char vByte;
+    short vShort;
+    int vInt;
+    float vFloat;
+    double vDouble;
+    long vLong;
+    char vChar;
+    char* vString;
+  } as;
+} Value;
+
+#define VALUE_IS_DOUBLE(v) ((v).type == DOUBLE)
+#define VALUE_IS_LONG(v) ((v).type == LONG)
+#define VALUE_IS_STRING(v) ((v).type == STRING)
+#define VALUE_IS_INT(v) ((v).type == INT)
+
+#define VALUE_TYPE(v) ((v).type)
+#define VALUE_BOOLEAN(v) ((v).as.vBoolean)
+#define VALUE_BYTE(v) ((v).as.vByte)
+#define VALUE_SHORT(v) ((v).as.vShort)
+#define VALUE_INT(v) ((v).as.vInt)
+#define VALUE_FLOAT(v) ((v).as.vFloat)
+#define VALUE_DOUBLE(v) ((v).as.vDouble)
+#define VALUE_LONG(v) ((v).as.vLong)
+#define VALUE_CHAR(v) ((v).as.vChar)
+#define VALUE_STRING(v) ((v).as.vString)
+
+static inline Value BooleanValue(bool b){ return (Value) {.type = BOOLEAN, .as.vBoolean = b}; }
+static inline Value ByteValue(unsigned char b){ return (Value) {.type = BYTE, .as.vByte = b}; }
+static inline Value ShortValue(short s){ return (Value) {.type = SHORT, .as.vShort = s}; }
+static inline Value IntValue(int i){ return (Value) {.type = INT, .as.vInt = i}; }
+static inline Value FloatValue(float f){ return (Value) {.type = FLOAT, .as.vFloat = f}; }
+static inline Value DoubleValue(double d){ return (Value) {.type = DOUBLE, .as.vDouble = d}; }
+static inline Value LongValue(long l){ return (Value) {.type = LONG, .as.vLong = l}; }
+static inline Value CharValue(char c){ return (Value) {.type = CHAR, .as.vChar = c}; }
+static inline Value StringValue(char* s){ return (Value) {.type = STRING, .as.vString = s}; }
+
+#endif // NAN_BOXING
+
+/**
+ * The zero value of a type, also used for types that carry
+ * no value such as UNDEFINED.
+ */
+static inline Value EmptyValue(Token type){
+  int t = (int) type;
+  switch (t) {
+    case BOOLEAN: return BooleanValue(false);
+    case BYTE: return ByteValue(0);
+    case SHORT: return ShortValue(0);
+    case INT: return IntValue(0);
+    case FLOAT: return FloatValue(0);
+    case DOUBLE: return DoubleValue(0);
+    case LONG: return LongValue(0);
+    case CHAR: return CharValue(0);
+    case STRING: return StringValue(NULL);
+  }
+
+#if NAN_BOXING
+  return SmallValue(type, 0);
+#else
+  return (Value) {.type = type, .as.vLong = 0};
+#endif
+}
+
+#endif // RUNNER_VALUE_H_
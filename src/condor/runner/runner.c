@@ -1,52 +1,117 @@
 #include "runner.h"
 
-void InitRunner(Runner* runner, Scope* scope) {
+void InitRunner(Runner* runner, Scope* scope, RunnerOutput* output) {
   runner->scope = scope;
+  runner->output = output;
+  runner->control = UNDEFINED;
+  runner->returnSlot = NULL;
+  runner->statement = NULL;
+  runner->frameSpot = 0;
+  runner->firstFreeContext = 0;
+  runner->totalFrames = RUNNER_FRAMES;
+  runner->frames = Allocate(sizeof(RunnerFrame) * RUNNER_FRAMES);
+  runner->stackBase = __builtin_frame_address(0);
+  runner->firstNodeId = scope->nodeLength > 0 ? scope->nodes[0].id : 0;
   for (int i = 0; i < runner->totalContexts; i++){
     RunnerContext* context = &runner->contexts[i];
     context->node = NULL;
-    context->dataType = UNDEFINED;
-    context->id = i + 1;
+    context->value = EmptyValue(UNDEFINED);
+  }
+
+  for (int i = 0; i < scope->nodeLength; i++){
+    runner->nodeContexts[i] = NULL;
+  }
+
+  GroupStatements(scope, runner->statements, runner->scopeStarts, runner->totalScopes + 1);
+
+  // A table per function the optimizer found worth memoizing
+  runner->totalMemos = 0;
+  runner->memos = NULL;
+  for (int i = 0; i < scope->nodeLength; i++){
+    ASTNode* node = &scope->nodes[i];
+    if (node->type == FUNC && GET_FUNC_MEMO(node) >= 0) runner->totalMemos++;
+  }
+  if (runner->totalMemos > 0) runner->memos = Allocate(sizeof(MemoTable) * runner->totalMemos);
+  for (int i = 0; i < scope->nodeLength; i++){
+    ASTNode* node = &scope->nodes[i];
+    if (node->type == FUNC && GET_FUNC_MEMO(node) >= 0) InitMemoTable(&runner->memos[GET_FUNC_MEMO(node)], node);
+  }
+  InitActivations(runner);
+}
+
+void DestroyRunner(Runner* runner) {
+  Free(runner->frames);
+  runner->frames = NULL;
+  for (int i = 0; i < runner->totalMemos; i++){
+    DestroyMemoTable(&runner->memos[i]);
+  }
+  if (runner->memos != NULL) Free(runner->memos);
+  runner->memos = NULL;
+  DestroyActivations(runner);
+}
+
+/**
+ * Lookups answered and missed over every memo table
+ */
+void GetMemoStats(Runner* runner, int* hits, int* misses) {
+  *hits = 0;
+  *misses = 0;
+  for (int i = 0; i < runner->totalMemos; i++){
+    *hits += runner->memos[i].hits;
+    *misses += runner->memos[i].misses;
   }
 }
 
 RunnerContext* Run(Runner* runner, int scopeId) {
+  return RunStatements(runner, scopeId, runner->scopeStarts[scopeId], runner->scopeStarts[scopeId + 1]);
+}
+
+/**
+ * Run part of scopeId's statements, statements[start] up to
+ * statements[end]
+ */
+RunnerContext* RunStatements(Runner* runner, int scopeId, int start, int end) {
   DEBUG_PRINT_RUNNER("Scope")
-  Scope* scope = runner->scope;
-  for (int i = 0; i < scope->nodeLength; i++){
-    ASTNode* node = &scope->nodes[i];
-    if (node->isStmt && node->scopeId == scopeId){
-      runner->currentNode = node;
-      RunnerContext* context = RunStatement(runner);
-      
-      if (node->type == RETURN){
-        // Reset to return node
-        context->node = node;
-        return context;
-      }
+  ASTNode* outer = runner->statement;
+  ASTNode** statement = &runner->statements[start];
+  ASTNode** last = &runner->statements[end];
+  for (; statement < last; statement++){
+    ASTNode* node = *statement;
+    if (node->type == BREAK) {
+      runner->control = BREAK;
+      runner->statement = outer;
+      return NULL;
+    }
 
-      if (node->type != FUNC && scopeId == 1) {
-        PrintContext(context);
-      }
+    runner->currentNode = node;
+    runner->statement = node;
+    RunnerContext* context = RunStatement(runner);
+
+    // A break or return below us, leave the body
+    if (runner->control != UNDEFINED) {
+      runner->statement = outer;
+      return context;
+    }
+
+    if (context != NULL && node->type != FUNC && scopeId == 1) {
+      PrintContext(runner->output, context);
     }
   }
 
+  runner->statement = outer;
   return NULL;
 }
 
 void GCScope(Runner* runner, int scopeId) {
-  Scope* scope = runner->scope;
-
-  for (int i = 0; i < scope->nodeLength; i++){
-    ASTNode* node = &scope->nodes[i];
-    if (node->scopeId == scopeId){
-      // Don't GC return contexts
-      if (node->type == RETURN) {
-        continue;
-      }
-
-      GCContextByNodeId(runner, node->id);
+  ASTNode** statement = &runner->statements[runner->scopeStarts[scopeId]];
+  ASTNode** end = &runner->statements[runner->scopeStarts[scopeId + 1]];
+  for (; statement < end; statement++){
+    // Don't GC return contexts
+    if ((*statement)->type == RETURN) {
+      continue;
     }
+
+    GCContextByNodeId(runner, (*statement)->id);
   }
 }
 
@@ -57,23 +122,34 @@ void GCAstList(Runner* runner, ASTList* list) {
 }
 
 void GCContextByNodeId(Runner* runner, int nodeId) {
-  for (int i = 0; i < runner->totalContexts; i++) {
-    RunnerContext* context = &runner->contexts[i];
-    if (runner->contextUsed[i] && context->node->id == nodeId) {
-      ResetRunnerContext(context);
-      runner->contextUsed[i] = false;
-    }
-  }
+  RunnerContext* context = GetContextByNodeId(runner, nodeId);
+  if (context != NULL) GCContext(runner, context);
 }
 
 void GCContext(Runner* runner, RunnerContext* context){
-  runner->contextUsed[context->id - 1] = false;
-  ResetRunnerContext(context);
+  int index = context - runner->contexts;
+  runner->contextUsed[index] = false;
+  if (index < runner->firstFreeContext) runner->firstFreeContext = index;
+  ResetRunnerContext(runner, context);
 }
 
-void ResetRunnerContext(RunnerContext* context) {
-  context->node = NULL;
-  context->dataType = UNDEFINED;
+void ResetRunnerContext(Runner* runner, RunnerContext* context) {
+  BindContext(runner, context, NULL);
+  context->value = EmptyValue(UNDEFINED);
+}
+
+/**
+ * Point a context at a node, keeping the node to context
+ * index in sync. A NULL node just releases the old one.
+ */
+void BindContext(Runner* runner, RunnerContext* context, ASTNode* node) {
+  if (context->node != NULL) {
+    int old = context->node->id - runner->firstNodeId;
+    if (runner->nodeContexts[old] == context) runner->nodeContexts[old] = NULL;
+  }
+
+  context->node = node;
+  if (node != NULL) runner->nodeContexts[node->id - runner->firstNodeId] = context;
 }
 
 RunnerContext* RunStatement(Runner* runner){
@@ -82,154 +158,533 @@ RunnerContext* RunStatement(Runner* runner){
 
   switch (type) {
     case FUNC_CALL: {
-      return RunFuncCall(runner);
+      return RunFuncCall(runner, GetContextForNode(runner, node));
     }
     case RETURN: {
-      runner->currentNode = GET_RETURN_VALUE(node);
-      return RunStatement(runner);
+      return RunReturn(runner);
     }
     case BINARY: {
       return RunBinary(runner);
     }
+    case VAR: {
+      // Re-run the initializer, loop bodies assign on every pass
+      RunnerContext* context = GetContextForNode(runner, node);
+      RunSetVarType(runner, context, node);
+      return context;
+    }
+    case FOR: {
+      return RunFor(runner);
+    }
+    case WHILE: {
+      return RunWhile(runner);
+    }
+    case IF: {
+      return RunIf(runner);
+    }
+    case SWITCH: {
+      return RunSwitch(runner);
+    }
+    case INC:
+    case DEC: {
+      return RunAssign(runner);
+    }
   }
 
+  if (IsAssignment(node->type)) return RunAssign(runner);
   return SetNodeValue(runner, node);
 }
 
+/**
+ * The return value is written straight into the slot the
+ * caller passed, see RunFuncWithArgs. A return outside of a
+ * call uses the RETURN node's own context.
+ */
+RunnerContext* RunReturn(Runner* runner){
+  ASTNode* node = runner->currentNode;
+  RunnerContext* context = runner->returnSlot;
+  if (context == NULL) context = GetContextForNode(runner, node);
+
+  if (GET_RETURN_VALUE(node) == NULL) {
+    context->value = EmptyValue(UNDEFINED);
+  }
+  else {
+    context->value = SetNodeValue(runner, GET_RETURN_VALUE(node))->value;
+  }
+
+  runner->control = RETURN;
+  return context;
+}
+
+/**
+ * The loop variable, condition and incrementor are evaluated
+ * in place: after the first pass every node involved already
+ * owns its context, so an iteration allocates nothing.
+ */
+RunnerContext* RunFor(Runner* runner){
+  DEBUG_PRINT_RUNNER("For loop")
+  ASTNode* node = runner->currentNode;
+  ASTNode* condition = GET_FOR_CONDITION(node);
+  ASTNode* inc = GET_FOR_INC(node);
+  int body = GET_FOR_BODY(node);
+
+  if (GET_FOR_VAR(node) != NULL) {
+    runner->currentNode = GET_FOR_VAR(node);
+    RunStatement(runner);
+  }
+
+  while (condition == NULL || RunCondition(runner, condition)) {
+    RunnerContext* context = Run(runner, body);
+    if (runner->control == BREAK) {
+      runner->control = UNDEFINED;
+      break;
+    }
+    if (runner->control == RETURN) return context;
+
+    if (inc != NULL) {
+      runner->currentNode = inc;
+      RunStatement(runner);
+    }
+  }
+
+  return NULL;
+}
+
+RunnerContext* RunWhile(Runner* runner){
+  DEBUG_PRINT_RUNNER("While loop")
+  ASTNode* node = runner->currentNode;
+  ASTNode* condition = GET_WHILE_CONDITION(node);
+  int body = GET_WHILE_BODY(node);
+
+  while (RunCondition(runner, condition)) {
+    RunnerContext* context = Run(runner, body);
+    if (runner->control == BREAK) {
+      runner->control = UNDEFINED;
+      break;
+    }
+    if (runner->control == RETURN) return context;
+  }
+
+  return NULL;
+}
+
+RunnerContext* RunIf(Runner* runner){
+  DEBUG_PRINT_RUNNER("If statement")
+  ASTNode* node = runner->currentNode;
+  if (!RunCondition(runner, GET_IF_CONDITION(node))) return NULL;
+  return Run(runner, GET_IF_BODY(node));
+}
+
+/**
+ * Cases are tried in order. Once one matches, it and every
+ * case after it run until a break, like C.
+ */
+RunnerContext* RunSwitch(Runner* runner){
+  DEBUG_PRINT_RUNNER("Switch statement")
+  ASTNode* node = runner->currentNode;
+  RunnerContext* value = SetNodeValue(runner, GET_SWITCH_CONDITION(node));
+  int body = GET_SWITCH_BODY(node);
+
+  bool matched = false;
+  ASTNode** statement = &runner->statements[runner->scopeStarts[body]];
+  ASTNode** end = &runner->statements[runner->scopeStarts[body + 1]];
+  for (; statement < end; statement++){
+    ASTNode* caseStmt = *statement;
+    if (caseStmt->type != CASE) continue;
+
+    if (!matched) {
+      matched = ValuesEqual(value->value, SetNodeValue(runner, GET_CASE_CONDITION(caseStmt))->value);
+      if (!matched) continue;
+    }
+
+    RunnerContext* context = Run(runner, GET_CASE_BODY(caseStmt));
+    if (runner->control == BREAK) {
+      runner->control = UNDEFINED;
+      break;
+    }
+    if (runner->control == RETURN) return context;
+  }
+
+  return NULL;
+}
+
+bool RunCondition(Runner* runner, ASTNode* condition){
+  return IsValueTrue(SetNodeValue(runner, condition)->value);
+}
+
+/**
+ * Assignments write straight into the variable's context.
+ * a op= b computes a op b with a as the result slot and then
+ * casts back to the declared type, so no temporary is used.
+ */
+RunnerContext* RunAssign(Runner* runner){
+  ASTNode* node = runner->currentNode;
+  ASTNode* var = GET_ASSIGN_VAR(node);
+  RunnerContext* context = GetContextForNode(runner, var);
+  Token op = node->type;
+  DEBUG_RUNNER("Runner: Assign %s %s\n", GET_VAR_NAME(var), TokenToString(op));
+
+  if (op == INC || op == DEC) {
+    context->value = IncrementValue(context->value, op == INC ? 1 : -1);
+    return context;
+  }
+
+  RunnerContext* value = SetNodeValue(runner, GET_ASSIGN_VALUE(node));
+  if (op == ASSIGN) {
+    context->value = CastValue(value->value, GET_VAR_TYPE(var));
+    return context;
+  }
+
+  // Narrowing back to the variable's type must not wrap,
+  // CastValue checks
+  RunMathContexts(context, context, value, GetAssignmentOperator(op));
+  context->value = CastValue(context->value, GET_VAR_TYPE(var));
+  return context;
+}
+
+/**
+ * Binary expressions are evaluated with the runner's frame
+ * stack instead of C recursion, so a chain like a + b + c + ...
+ * uses a fixed amount of C stack. A frame waits on its left
+ * operand, then its right; operands that are binaries get
+ * their own frame and leave the result in their node's slot.
+ */
 RunnerContext* RunBinary(Runner* runner){
-  DEBUG_PRINT_RUNNER("Binary expression")
-  ASTNode* binary = runner->currentNode;
-  ASTNode* left = GET_BIN_LEFT(binary);
-  ASTNode* right = GET_BIN_RIGHT(binary);
+  ASTNode* root = runner->currentNode;
+  int base = runner->frameSpot;
+  PushFrame(runner, root);
+
+  while (runner->frameSpot > base) {
+    int spot = runner->frameSpot - 1;
+    RunnerFrame* frame = &runner->frames[spot];
+    ASTNode* binary = frame->node;
+
+    if (GET_BIN_OPERANDS(binary) != NULL) {
+      RunChainStep(runner, spot);
+      continue;
+    }
+
+    if (frame->state == FRAME_START) {
+      frame->state = FRAME_LEFT;
+      PushOperand(runner, GET_BIN_LEFT(binary));
+      continue;
+    }
+
+    if (frame->state == FRAME_LEFT) {
+      // Running an operand may run a function and move the frames
+      RunnerContext* left = GetOperandValue(runner, GET_BIN_LEFT(binary));
+      if (RunBinaryLeft(runner, binary, left)) {
+        runner->frameSpot = spot;
+        continue;
+      }
+
+      frame = &runner->frames[spot];
+      frame->left = left;
+      frame->state = FRAME_RIGHT;
+      PushOperand(runner, GET_BIN_RIGHT(binary));
+      continue;
+    }
+
+    RunnerContext* left = frame->left;
+    RunnerContext* right = GetOperandValue(runner, GET_BIN_RIGHT(binary));
+    runner->frameSpot = spot;
+    RunBinaryRight(runner, binary, left, right);
+  }
+
+  return GetContextByNodeId(runner, root->id);
+}
+
+void PushFrame(Runner* runner, ASTNode* binary){
+  if (runner->frameSpot == runner->totalFrames) {
+    runner->totalFrames *= 2;
+    runner->frames = Reallocate(runner->frames, sizeof(RunnerFrame) * runner->totalFrames);
+    if (runner->frames == NULL) RUNTIME_ERROR("Out of memory");
+  }
+
+  RunnerFrame* frame = &runner->frames[runner->frameSpot++];
+  frame->node = binary;
+  frame->left = NULL;
+  frame->item = NULL;
+  frame->state = FRAME_START;
+}
+
+/**
+ * Operands that are binaries are run by a frame of their own,
+ * unless their value is already known
+ */
+void PushOperand(Runner* runner, ASTNode* node){
+  if (node->type == BINARY && !IsReusedValue(runner, node)) PushFrame(runner, node);
+}
+
+/**
+ * A binary shared by several statements is computed by its
+ * owner statement. The optimizer only shares it where nothing
+ * it reads can change in between, so any other statement
+ * reads the owner's result.
+ */
+bool IsReusedValue(Runner* runner, ASTNode* binary){
+  ASTNode* owner = GET_BIN_OWNER(binary);
+  if (owner == NULL || owner == runner->statement) return false;
+  return GetContextByNodeId(runner, binary->id) != NULL;
+}
+
+/**
+ * One step of a flattened chain such as a + b + c + d. The
+ * operands are folded left to right into the chain's own slot,
+ * and && or || stop at the first operand that decides them.
+ */
+void RunChainStep(Runner* runner, int spot){
+  RunnerFrame* frame = &runner->frames[spot];
+  ASTNode* binary = frame->node;
   Token op = GET_BIN_OP(binary);
 
-  RunnerContext* leftContext = SetNodeValue(runner, left);
-  runner->currentNode = right;
-  RunnerContext* rightContext = RunStatement(runner);
+  if (frame->state == FRAME_START) {
+    frame->item = GET_BIN_OPERANDS(binary)->first;
+    frame->state = FRAME_LEFT;
+    PushOperand(runner, frame->item->node);
+    return;
+  }
+
+  // Running an operand may run a function and move the frames
+  RunnerContext* value = GetOperandValue(runner, frame->item->node);
+  frame = &runner->frames[spot];
+  RunnerContext* result = GetContextForNode(runner, binary);
+  ASTListItem* next = frame->item->next;
+
+  if (op == LAND || op == LOR) {
+    bool truth = IsValueTrue(value->value);
+    if (truth == (op == LOR) || next == NULL) {
+      result->value = BooleanValue(truth);
+      runner->frameSpot = spot;
+      return;
+    }
+  }
+  else if (frame->state == FRAME_LEFT) result->value = value->value;
+  else RunMathContexts(result, result, value, op);
 
-  return RunMathContexts(leftContext, rightContext, op);
+  if (next == NULL) {
+    runner->frameSpot = spot;
+    return;
+  }
+
+  frame->item = next;
+  frame->state = FRAME_RIGHT;
+  PushOperand(runner, next->node);
 }
 
-RunnerContext* RunMathContexts(RunnerContext* left, RunnerContext* right, Token op){
-  if (left->dataType == STRING || right->dataType == STRING){
-    NOT_IMPLEMENTED("String concatenation");
+/**
+ * An operand's value. Binaries have already been run by
+ * their own frame.
+ */
+RunnerContext* GetOperandValue(Runner* runner, ASTNode* node){
+  if (node->type == BINARY) return GetContextByNodeId(runner, node->id);
+  return SetNodeValue(runner, node);
+}
+
+/**
+ * Finish a binary from its left operand alone when possible:
+ * && and || that are already decided, and strength reduced
+ * math whose right operand is a known constant. Returns
+ * whether the result was written.
+ */
+bool RunBinaryLeft(Runner* runner, ASTNode* binary, RunnerContext* left){
+  Token op = GET_BIN_OP(binary);
+  if (op == LAND || op == LOR) {
+    bool value = IsValueTrue(left->value);
+    if (value == (op == LOR)) {
+      GetContextForNode(runner, binary)->value = BooleanValue(value);
+      return true;
+    }
+    return false;
   }
 
-  if (left->dataType == STRING || left->dataType == CHAR ||
-      right->dataType == STRING || right->dataType == CHAR) {
-    NOT_IMPLEMENTED("String comparisons not implemented")      
+  if (GET_BIN_SHIFT(binary) >= 0 && IsIntegerType(VALUE_TYPE(left->value))) {
+    RunnerContext* result = GetContextForNode(runner, binary);
+    result->value = RunReducedMath(left->value, GET_BIN_SHIFT(binary), op);
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Both operands are known. The result has its own slot so
+ * the operands, which may be variables, are never overwritten.
+ */
+void RunBinaryRight(Runner* runner, ASTNode* binary, RunnerContext* left, RunnerContext* right){
+  Token op = GET_BIN_OP(binary);
+  RunnerContext* result = GetContextForNode(runner, binary);
+
+  if (op == LAND || op == LOR) {
+    result->value = BooleanValue(IsValueTrue(right->value));
+  }
+  else if (IsBooleanOperator(op)) {
+    result->value = BooleanValue(RunCompare(left->value, right->value, op));
   }
   else {
-    double leftVal = ContextToDouble(left);
-    double rightVal = ContextToDouble(right);
+    RunMathContexts(result, left, right, op);
+  }
+}
 
-    DEBUG_RUNNER("Runner: Math: %f %s %f\n", leftVal, TokenToString(op), rightVal)
+RunnerContext* RunMathContexts(RunnerContext* result, RunnerContext* left, RunnerContext* right, Token op){
+  Token leftType = VALUE_TYPE(left->value);
+  Token rightType = VALUE_TYPE(right->value);
+  if (leftType == STRING || rightType == STRING){
+    NOT_IMPLEMENTED("String concatenation");
+  }
 
-    // TODO: Figure out true type
-    left->value.vDouble = RunMath(leftVal, rightVal, op);
-    CastToType(left);
+  if (leftType == CHAR || rightType == CHAR) {
+    NOT_IMPLEMENTED("String comparisons not implemented")      
   }
 
-  return left;
+  DEBUG_RUNNER("Runner: Math: %s %s %s\n", TokenToString(leftType), TokenToString(op), TokenToString(rightType))
+  result->value = RunMath(left->value, right->value, op);
+
+  return result;
 }
 
-RunnerContext* RunFuncCall(Runner* runner){
+RunnerContext* RunFuncCall(Runner* runner, RunnerContext* result){
   ASTList* params = GET_FUNC_CALL_PARAMS(runner->currentNode);
   ASTNode* func = GET_FUNC_CALL_FUNC(runner->currentNode);
   DEBUG_RUNNER("Runner: Function Call %s()\n", GET_FUNC_NAME(func));
-  return RunFuncWithArgs(runner, func, params);
+  return RunFuncWithArgs(runner, func, params, result);
 }
 
-RunnerContext* RunFuncWithArgs(Runner* runner, ASTNode* func, ASTList* args){
+/**
+ * Run a function with the result going to the given slot.
+ * RETURN writes into it directly, so a call costs no extra
+ * slot and no copy; nested calls each pass their own node's
+ * slot. A function that returns nothing leaves it UNDEFINED.
+ * A memoized function given every argument first looks the
+ * argument values up, and only runs its body on a miss.
+ */
+RunnerContext* RunFuncWithArgs(Runner* runner, ASTNode* func, ASTList* args, RunnerContext* result){
   DEBUG_PRINT_RUNNER("Function Scope")
 
-  int argIdx = 0;
+  // Every argument is evaluated before any param is bound,
+  // an argument may call this same function
+  int arity = 0;
+  FOREACH_AST(GET_FUNC_PARAMS(func)){
+    arity++;
+  }
+  Value values[arity > 0 ? arity : 1];
+  ASTListItem* param = GET_FUNC_PARAMS(func)->first;
+  int bound = 0;
   FOREACH_AST(args){
-    ASTNode* arg = item->node;
-    int paramIdx = 0;
-    RunnerContext* context = SetNodeValue(runner, arg);
-
-    FOREACH_AST(GET_FUNC_PARAMS(func)){
-      if (argIdx == paramIdx++){
-        ASTNode* param = item->node;
-        context->node = param;
-        break;
-      }
-    }
+    if (param == NULL) break;
+    RunnerContext* value = SetNodeValue(runner, item->node);
+    values[bound++] = CastValue(value->value, GET_VAR_TYPE(param->node));
+    param = param->next;
+  }
+
+  MemoTable* memo = NULL;
+  if (GET_FUNC_MEMO(func) >= 0 && GET_FUNC_MEMO(func) < runner->totalMemos) {
+    memo = &runner->memos[GET_FUNC_MEMO(func)];
+    if (memo->arity != bound) memo = NULL;
+  }
+  if (memo != NULL && LookupMemo(memo, values, &result->value)) return result;
+
+  if (runner->stackBase - (char*) __builtin_frame_address(0) > RUNNER_STACK_LIMIT) {
+    RUNTIME_ERROR("Stack overflow");
+  }
 
-    argIdx++;
+  bool reentered = EnterActivation(runner, func);
+  param = GET_FUNC_PARAMS(func)->first;
+  for (int i = 0; i < bound; i++, param = param->next){
+    GetContextForNode(runner, param->node)->value = values[i];
   }
 
-  RunnerContext* context = Run(runner, GET_FUNC_BODY(func));
+  RunnerContext* previousSlot = runner->returnSlot;
+  runner->returnSlot = result;
+  Run(runner, GET_FUNC_BODY(func));
+  runner->returnSlot = previousSlot;
+
+  if (runner->control != RETURN) result->value = EmptyValue(UNDEFINED);
+  runner->control = UNDEFINED;
   GCScope(runner, GET_FUNC_BODY(func));
   GCAstList(runner, GET_FUNC_PARAMS(func));
-  return context;
+
+  // The slot may be one of the contexts put back
+  Value returned = result->value;
+  LeaveActivation(runner, func, reentered);
+  result->value = returned;
+  if (memo != NULL) StoreMemo(memo, values, returned);
+  return result;
 }
 
 RunnerContext* SetNodeValue(Runner* runner, ASTNode* node){
   CHECK(node != NULL);
+
+  // Expressions are recomputed; only values are looked up
+  if (node->type == BINARY) {
+    if (IsReusedValue(runner, node)) return GetContextByNodeId(runner, node->id);
+    ASTNode* previousNode = runner->currentNode;
+    runner->currentNode = node;
+    RunnerContext* result = RunBinary(runner);
+    runner->currentNode = previousNode;
+    return result;
+  }
+
+  // Post increment, the old value is kept in the node's own slot
+  if (node->type == INC || node->type == DEC) {
+    RunnerContext* result = GetContextForNode(runner, node);
+    RunnerContext* var = SetNodeValue(runner, GET_ASSIGN_VAR(node));
+    result->value = var->value;
+    var->value = IncrementValue(var->value, node->type == INC ? 1 : -1);
+    return result;
+  }
+
   RunnerContext* context = GetContextByNodeId(runner, node->id);
-  if (context != NULL){
+  if (context != NULL && node->type != FUNC_CALL){
     return context;
   }
 
-  context = GetNextContext(runner);
-  context->node = node;
+  if (context == NULL) context = GetContextForNode(runner, node);
 
   int type = (int) node->type;
   switch (type) {
     case BOOLEAN: {
-      context->dataType = node->type;
-      context->value.vBoolean = GET_BOOLEAN_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %d\n", context->value.vBoolean);
+      context->value = BooleanValue(GET_BOOLEAN_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %d\n", VALUE_BOOLEAN(context->value));
       break;
     }
     case BYTE: {
-      context->dataType = BYTE;
-      context->value.vByte = GET_BYTE_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %d\n", context->value.vByte);
+      context->value = ByteValue(GET_BYTE_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %d\n", VALUE_BYTE(context->value));
       break;
     }
     case SHORT: {
-      context->dataType = SHORT;
-      context->value.vShort = GET_SHORT_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %d\n", context->value.vShort);
+      context->value = ShortValue(GET_SHORT_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %d\n", VALUE_SHORT(context->value));
       break;
     }
     case INT: {
-      context->dataType = INT;
-      context->value.vInt = GET_INT_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %d\n", context->value.vInt);
+      context->value = IntValue(GET_INT_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %d\n", VALUE_INT(context->value));
       break;
     }
     case FLOAT: {
-      context->dataType = FLOAT;
-      context->value.vFloat = GET_FLOAT_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %f\n", context->value.vFloat);
+      context->value = FloatValue(GET_FLOAT_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %f\n", VALUE_FLOAT(context->value));
       break;
     }
     case DOUBLE: {
-      context->dataType = DOUBLE;
-      context->value.vDouble = GET_DOUBLE_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %f\n", context->value.vDouble);
+      context->value = DoubleValue(GET_DOUBLE_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %f\n", VALUE_DOUBLE(context->value));
       break;
     }
     case LONG: {
-      context->dataType = LONG;
-      context->value.vLong = GET_LONG_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %ld\n", context->value.vLong);
+      context->value = LongValue(GET_LONG_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %ld\n", VALUE_LONG(context->value));
       break;
     }
     case CHAR: {
-      context->dataType = CHAR;
-      context->value.vChar = GET_CHAR_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %c\n", context->value.vChar);
+      context->value = CharValue(GET_CHAR_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %c\n", VALUE_CHAR(context->value));
       break;
     }
     case STRING: {
-      context->dataType = STRING;
-      context->value.vString = GET_STRING_VALUE(node);
-      DEBUG_RUNNER("Runner: Set node value: %s\n", context->value.vString);
+      context->value = StringValue(GET_STRING_VALUE(node));
+      DEBUG_RUNNER("Runner: Set node value: %s\n", VALUE_STRING(context->value));
       break;
     }
     case VAR: {
@@ -239,10 +694,8 @@ RunnerContext* SetNodeValue(Runner* runner, ASTNode* node){
     case FUNC_CALL: {
       ASTNode* previousNode = runner->currentNode;
       runner->currentNode = node;
-      RunnerContext* newContext = RunFuncCall(runner);
+      RunFuncCall(runner, context);
       runner->currentNode = previousNode;
-      MergeContextValues(newContext, context);
-      GCContext(runner, newContext);
       break;
     }
   }
@@ -250,86 +703,37 @@ RunnerContext* SetNodeValue(Runner* runner, ASTNode* node){
   return context;
 }
 
-void MergeContextValues(RunnerContext* left, RunnerContext* right){
-  right->dataType = left->dataType;
-  right->value = left->value;
-}
-
 void RunSetVarType(Runner* runner, RunnerContext* context, ASTNode* node){
-  int type = (int) GET_VAR_TYPE(node);
-  switch (type) {
-    case BOOLEAN: {
-      context->dataType = BOOLEAN;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vBoolean = varContext->value.vBoolean;
-      break;
-    }
-    case BYTE: {
-      context->dataType = BYTE;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vByte = varContext->value.vByte;
-      break;
-    }
-    case SHORT: {
-      context->dataType = SHORT;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vShort = varContext->value.vShort;
-      break;
-    }
-    case INT: {
-      context->dataType = INT;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vInt = varContext->value.vInt;
-      break;
-    }
-    case FLOAT: {
-      context->dataType = FLOAT;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vFloat = varContext->value.vFloat;
-      break;
-    }
-    case DOUBLE: {
-      context->dataType = DOUBLE;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vDouble = varContext->value.vDouble;
-      break;
-    }
-    case LONG: {
-      context->dataType = LONG;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vLong = varContext->value.vLong;
-      break;
-    }
-    case CHAR: {
-      context->dataType = CHAR;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vChar = varContext->value.vChar;
-      break;
-    }
-    case STRING: {
-      context->dataType = STRING;
-      RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
-      context->value.vString = varContext->value.vString;
-      break;
-    }
+  if (GET_VAR_VALUE(node) == NULL) {
+    context->value = EmptyValue(GET_VAR_TYPE(node));
+    return;
   }
+
+  RunnerContext* varContext = SetNodeValue(runner, GET_VAR_VALUE(node));
+  context->value = CastValue(varContext->value, GET_VAR_TYPE(node));
 }
 
 RunnerContext* GetContextByNodeId(Runner* runner, int nodeId){
-  for (int i = 0; i < runner->totalContexts; i++){
-    RunnerContext* context = &runner->contexts[i];
-    if (context->node != NULL && context->node->id == nodeId){
-      return &runner->contexts[i];
-    }
-  }
+  return runner->nodeContexts[nodeId - runner->firstNodeId];
+}
 
-  return NULL;
+/**
+ * The node's context, allocating one if it has none yet
+ */
+RunnerContext* GetContextForNode(Runner* runner, ASTNode* node){
+  RunnerContext* context = GetContextByNodeId(runner, node->id);
+  if (context != NULL) return context;
+
+  context = GetNextContext(runner);
+  BindContext(runner, context, node);
+  return context;
 }
 
 RunnerContext* GetNextContext(Runner* runner) {
-  for (int i = 0; i < runner->totalContexts; i++) {
+  for (int i = runner->firstFreeContext; i < runner->totalContexts; i++) {
     if (!runner->contextUsed[i]) {
       runner->contextUsed[i] = true;
+      runner->firstFreeContext = i + 1;
       return &runner->contexts[i];  
     }
   }
@@ -337,44 +741,56 @@ RunnerContext* GetNextContext(Runner* runner) {
   RUNTIME_ERROR("Ran out of contexts");
 }
 
-void PrintContext(RunnerContext* context){
-  int type = (int) context->dataType;
+/**
+ * Numbers are formatted into the line and written at once
+ */
+void PrintContext(RunnerOutput* output, RunnerContext* context){
+  int type = (int) VALUE_TYPE(context->value);
+  char line[FORMAT_BUFFER_SIZE + 4] = ">> ";
+  char* value = &line[3];
+  int length;
   switch (type) {
     case BOOLEAN: {
-      printf(">> %d\n", context->value.vBoolean);
+      length = FormatLong(VALUE_BOOLEAN(context->value), value);
       break;
     }
     case BYTE: {
-      printf(">> %d\n", context->value.vByte);
+      length = FormatLong(VALUE_BYTE(context->value), value);
       break;
     }
     case SHORT: {
-      printf(">> %d\n", context->value.vShort);
+      length = FormatLong(VALUE_SHORT(context->value), value);
       break;
     }
     case INT: {
-      printf(">> %d\n", context->value.vInt);
+      length = FormatLong(VALUE_INT(context->value), value);
       break;
     }
     case FLOAT: {
-      printf(">> %f\n", context->value.vFloat);
+      length = FormatFloat(VALUE_FLOAT(context->value), value);
       break;
     }
     case DOUBLE: {
-      printf(">> %f\n", context->value.vDouble);
+      length = FormatDouble(VALUE_DOUBLE(context->value), value);
       break;
     }
     case LONG: {
-      printf(">> %ld\n", context->value.vLong);
+      length = FormatLong(VALUE_LONG(context->value), value);
       break;
     }
     case CHAR: {
-      printf(">> %d\n", context->value.vChar);
+      length = FormatLong(VALUE_CHAR(context->value), value);
       break;
     }
     case STRING: {
-      printf(">> %s\n", context->value.vString);
-      break;
+      char* string = VALUE_STRING(context->value);
+      WriteOutput(output, line, 3);
+      WriteOutput(output, string, (int) strlen(string));
+      WriteOutput(output, "\n", 1);
+      return;
     }
+    default: return;
   }
+  value[length] = '\n';
+  WriteOutput(output, line, length + 4);
 }
\ No newline at end of file
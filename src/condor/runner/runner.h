@@ -14,35 +14,57 @@
 #include "../ast/astlist.h"
 #include "./runner-math.h"
 #include "utils/debug.h"
+#include "../mem/allocate.h"
 #include "./runner-types.h"
+#include "./runner-memo.h"
+#include "./runner-activation.h"
+#include "../number/format.h"
 
 /**
  * Public Functions
  */
-void InitRunner(Runner* runner, Scope* scope);
+void InitRunner(Runner* runner, Scope* scope, RunnerOutput* output);
+void DestroyRunner(Runner* runner);
+void GetMemoStats(Runner* runner, int* hits, int* misses);
 RunnerContext* Run(Runner* runner, int scopeId);
+RunnerContext* RunStatements(Runner* runner, int scopeId, int start, int end);
 
 /**
  * Private functions
  */
 RunnerContext* RunStatement(Runner* runner);
-RunnerContext* RunFuncCall(Runner* runner);
-RunnerContext* RunFuncWithArgs(Runner* runner, ASTNode* func, ASTList* args);
+RunnerContext* RunReturn(Runner* runner);
+RunnerContext* RunFor(Runner* runner);
+RunnerContext* RunWhile(Runner* runner);
+RunnerContext* RunIf(Runner* runner);
+RunnerContext* RunSwitch(Runner* runner);
+bool RunCondition(Runner* runner, ASTNode* condition);
+RunnerContext* RunAssign(Runner* runner);
+RunnerContext* RunFuncCall(Runner* runner, RunnerContext* result);
+RunnerContext* RunFuncWithArgs(Runner* runner, ASTNode* func, ASTList* args, RunnerContext* result);
 RunnerContext* SetNodeValue(Runner* runner, ASTNode* node);
 RunnerContext* GetNextContext(Runner* runner);
 RunnerContext* GetContextByNodeId(Runner* runner, int nodeId);
+RunnerContext* GetContextForNode(Runner* runner, ASTNode* node);
+void BindContext(Runner* runner, RunnerContext* context, ASTNode* node);
 RunnerContext* RunBinary(Runner* runner);
+void PushFrame(Runner* runner, ASTNode* binary);
+void PushOperand(Runner* runner, ASTNode* node);
+bool IsReusedValue(Runner* runner, ASTNode* binary);
+void RunChainStep(Runner* runner, int spot);
+RunnerContext* GetOperandValue(Runner* runner, ASTNode* node);
+bool RunBinaryLeft(Runner* runner, ASTNode* binary, RunnerContext* left);
+void RunBinaryRight(Runner* runner, ASTNode* binary, RunnerContext* left, RunnerContext* right);
 void RunSetVarType(Runner* runner, RunnerContext* context, ASTNode* node);
-RunnerContext* RunMathContexts(RunnerContext* left, RunnerContext* right, Token op);
-void PrintContext(RunnerContext* context);
-void MergeContextValues(RunnerContext* left, RunnerContext* right);
+RunnerContext* RunMathContexts(RunnerContext* result, RunnerContext* left, RunnerContext* right, Token op);
+void PrintContext(RunnerOutput* output, RunnerContext* context);
 
 void GCScope(Runner* runner, int scopeId);
 void GCAstList(Runner* runner, ASTList* list);
 void GCContextByNodeId(Runner* runner, int nodeId);
 void GCContext(Runner* runner, RunnerContext* context);
 
-void ResetRunnerContext(RunnerContext* context);
+void ResetRunnerContext(Runner* runner, RunnerContext* context);
 
 #define CONTEXT_BOOLEAN_VALUE(node) node->value.booleanValue.value
 #define CONTEXT_INT_VALUE(node) node->value.intValue.value
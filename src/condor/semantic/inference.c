@@ -0,0 +1,263 @@
+#include "inference.h"
+
+#define NODE_INDEX(inference, node) ((int) ((node) - (inference)->scope->nodes))
+
+/**
+ * Infer the open types, then write them onto the declarations.
+ * A type that stays UNDEFINED, like a variable that is never
+ * given a value, keeps what was declared.
+ */
+void InferTypes(Scope* scope){
+	TypeInference inference;
+	InitTypeInference(&inference, scope);
+	SolveTypes(&inference);
+
+	for (int i = 0; i < scope->nodeLength; i++){
+		ASTNode* node = &scope->nodes[i];
+		Token type = inference.types[i];
+		if (!inference.open[i] || type == UNDEFINED) continue;
+		if (node->type == VAR){
+			SET_VAR_TYPE(node, type);
+			DEBUG_PRINT3("Inferred", GET_VAR_NAME(node), TokenToString(type));
+		}
+		else if (node->type == FUNC){
+			SET_FUNC_TYPE(node, type);
+			DEBUG_PRINT3("Inferred return", GET_FUNC_NAME(node), TokenToString(type));
+		}
+	}
+
+	DestroyTypeInference(&inference);
+}
+
+/**
+ * Apply the rules until no type changes after being used
+ */
+void SolveTypes(TypeInference* inference){
+	Scope* scope = inference->scope;
+	inference->stale = true;
+	while (inference->stale){
+		inference->stale = false;
+		for (int i = 0; i < scope->nodeLength; i++){
+			InferNodeTypes(inference, &scope->nodes[i]);
+		}
+	}
+}
+
+void InitTypeInference(TypeInference* inference, Scope* scope){
+	int length = scope->nodeLength;
+	inference->scope = scope;
+	inference->totalScopes = scope->scopeLength + 2;
+	inference->types = Allocate(sizeof(Token) * length);
+	inference->open = Allocate(sizeof(bool) * length);
+	inference->read = Allocate(sizeof(bool) * length);
+	inference->funcs = Allocate(sizeof(ASTNode*) * inference->totalScopes);
+	InitWorkStack(&inference->stack);
+	InitWorkStack(&inference->results);
+
+	// Every function's return type is inferred. So is the type
+	// of a variable declared with var, and of one whose value
+	// is a literal or binary, which PredictVarType also sets.
+	ASTNode* owners[inference->totalScopes];
+	for (int i = 0; i < inference->totalScopes; i++){
+		owners[i] = NULL;
+		inference->funcs[i] = NULL;
+	}
+	for (int i = 0; i < length; i++){
+		ASTNode* node = &scope->nodes[i];
+		ASTNode* value = node->type == VAR ? GET_VAR_VALUE(node) : NULL;
+		inference->types[i] = UNDEFINED;
+		inference->read[i] = false;
+		inference->open[i] = node->type == FUNC ||
+			(node->type == VAR && (GET_VAR_TYPE(node) == VAR ||
+				(value != NULL && (value->type == BINARY || IsNumber(value->type) || IsString(value->type)))));
+
+		int type = (int) node->type;
+		switch (type){
+			case FOR: owners[GET_FOR_BODY(node)] = node; break;
+			case WHILE: owners[GET_WHILE_BODY(node)] = node; break;
+			case IF: owners[GET_IF_BODY(node)] = node; break;
+			case SWITCH: owners[GET_SWITCH_BODY(node)] = node; break;
+			case CASE: owners[GET_CASE_BODY(node)] = node; break;
+			case FUNC: owners[GET_FUNC_BODY(node)] = node; break;
+		}
+	}
+
+	// Owners come before their bodies, so an owner's own scope
+	// is already resolved
+	for (int i = 1; i < inference->totalScopes; i++){
+		ASTNode* owner = owners[i];
+		if (owner == NULL || owner->type == FUNC) inference->funcs[i] = owner;
+		else if (owner->scopeId > 0 && owner->scopeId < i) inference->funcs[i] = inference->funcs[owner->scopeId];
+	}
+}
+
+void DestroyTypeInference(TypeInference* inference){
+	DestroyWorkStack(&inference->stack);
+	DestroyWorkStack(&inference->results);
+	Free(inference->types);
+	Free(inference->open);
+	Free(inference->read);
+	Free(inference->funcs);
+}
+
+/**
+ * Apply the rules for what a node tells about the types
+ */
+void InferNodeTypes(TypeInference* inference, ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case VAR: {
+			if (GET_VAR_VALUE(node) != NULL) UnifyType(inference, node, InferValueType(inference, node));
+			break;
+		}
+		case FUNC_CALL: {
+			ASTNode* func = GET_FUNC_CALL_FUNC(node);
+			if (func == NULL || func->type != FUNC) break;
+			ASTListItem* param = GET_FUNC_PARAMS(func)->first;
+			FOREACH_AST(GET_FUNC_CALL_PARAMS(node)){
+				if (param == NULL) break;
+				if (GET_VAR_VALUE(param->node) == NULL){
+					UnifyType(inference, param->node, InferExpressionType(inference, item->node));
+				}
+				param = param->next;
+			}
+			break;
+		}
+		case RETURN: {
+			if (node->scopeId <= 0 || node->scopeId >= inference->totalScopes) break;
+			ASTNode* func = inference->funcs[node->scopeId];
+			if (func != NULL) UnifyType(inference, func, InferExpressionType(inference, GET_RETURN_VALUE(node)));
+			break;
+		}
+		default: {
+			// A variable declared without a value takes the types
+			// assigned to it
+			if (!IsAssignment(node->type)) break;
+			ASTNode* var = GET_ASSIGN_VAR(node);
+			if (var == NULL || var->type != VAR || GET_VAR_VALUE(var) != NULL) break;
+
+			Token valueType = InferExpressionType(inference, GET_ASSIGN_VALUE(node));
+			if (node->type != ASSIGN){
+				Token varType = InferOperandType(inference, var);
+				if (!IsNumber(varType) || !IsNumber(valueType)) break;
+				valueType = GetOperatorType(GetAssignmentOperator(node->type), varType, valueType);
+			}
+			UnifyType(inference, var, valueType);
+			break;
+		}
+	}
+}
+
+/**
+ * The type of a variable's value, as PredictVarType gives it.
+ * A variable declared with a type keeps it unless the value is
+ * a literal or binary of another kind, like a string.
+ */
+Token InferValueType(TypeInference* inference, ASTNode* var){
+	ASTNode* value = GET_VAR_VALUE(var);
+	Token declared = GET_VAR_TYPE(var);
+	Token type = UNDEFINED;
+	if (IsNumber(value->type) || IsString(value->type)) type = value->type;
+	else if (value->type == BINARY || declared == VAR) type = InferExpressionType(inference, value);
+
+	if (IsNumber(declared) && IsNumber(type)) return declared;
+	return type;
+}
+
+/**
+ * The type of an expression from what is known so far:
+ * UNDEFINED when an operand is not known yet, VAR when one is
+ * dynamic. Walked like GetBinaryType. Each binary keeps the
+ * type it got, or UNDEFINED if it has none; the last pass
+ * sees the final types, so what it leaves is what
+ * GetBinaryType would compute.
+ */
+Token InferExpressionType(TypeInference* inference, ASTNode* node){
+	if (node == NULL) return UNDEFINED;
+	if (node->type != BINARY) return InferOperandType(inference, node);
+
+	WorkStack* work = &inference->stack;
+	WorkStack* types = &inference->results;
+	PushWork(work, node, 0, 0);
+	while (!IS_WORK_STACK_EMPTY(work)){
+		WorkItem item = PopWork(work);
+		if (item.node->type != BINARY){
+			PushWork(types, NULL, 0, InferOperandType(inference, item.node));
+		}
+		else if (item.state == 0 && GET_BIN_OPERANDS(item.node) != NULL){
+			ASTList* list = GET_BIN_OPERANDS(item.node);
+			int count = 0;
+			FOREACH_AST(list) count++;
+
+			PushWork(work, item.node, 1, count);
+			for (ASTListItem* operand = list->last; operand != NULL; operand = operand->prev){
+				PushWork(work, operand->node, 0, 0);
+			}
+		}
+		else if (item.state == 0){
+			PushWork(work, item.node, 1, 2);
+			PushWork(work, GET_BIN_RIGHT(item.node), 0, 0);
+			PushWork(work, GET_BIN_LEFT(item.node), 0, 0);
+		}
+		else{
+			WorkItem* operandTypes = &types->items[types->length - item.value];
+			Token type = operandTypes[0].value;
+			for (int i = 1; i < item.value; i++){
+				Token right = operandTypes[i].value;
+				if (type == UNDEFINED || right == UNDEFINED) type = UNDEFINED;
+				else if (type == VAR || right == VAR) type = VAR;
+				else type = GetOperatorType(GET_BIN_OP(item.node), type, right);
+			}
+			types->length -= item.value;
+			item.node->valueType = type == VAR ? UNDEFINED : type;
+			PushWork(types, NULL, 0, type);
+		}
+	}
+	return PopWork(types).value;
+}
+
+Token InferOperandType(TypeInference* inference, ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case VAR: {
+			int index = NODE_INDEX(inference, node);
+			if (!inference->open[index]) return GET_VAR_TYPE(node);
+			inference->read[index] = true;
+			return inference->types[index];
+		}
+		case INC:
+		case DEC: return InferOperandType(inference, GET_ASSIGN_VAR(node));
+		case FUNC_CALL: {
+			ASTNode* func = GET_FUNC_CALL_FUNC(node);
+			if (func == NULL || func->type != FUNC) return UNDEFINED;
+			inference->read[NODE_INDEX(inference, func)] = true;
+			return inference->types[NODE_INDEX(inference, func)];
+		}
+	}
+	if (IsNumber(node->type) || IsString(node->type)) return node->type;
+	return UNDEFINED;
+}
+
+/**
+ * Widen an open node's type by one of its sources
+ */
+void UnifyType(TypeInference* inference, ASTNode* node, Token type){
+	int index = NODE_INDEX(inference, node);
+	if (!inference->open[index]) return;
+
+	Token joined = JoinTypes(inference->types[index], type);
+	if (joined == inference->types[index]) return;
+	inference->types[index] = joined;
+	if (inference->read[index]) inference->stale = true;
+}
+
+/**
+ * The narrowest type holding both, VAR when there is none
+ */
+Token JoinTypes(Token a, Token b){
+	if (a == UNDEFINED) return b;
+	if (b == UNDEFINED || a == b) return a;
+	if (a == VAR || b == VAR) return VAR;
+	if (IsNumber(a) && IsNumber(b)) return GetPromotedType(a, b);
+	return VAR;
+}
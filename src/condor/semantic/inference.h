@@ -0,0 +1,58 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Type inference. Gives every variable declared with var,
+ * every param declared with var, and every function a static
+ * type before the semantics are checked:
+ * 	1. A variable with a value has the value's type
+ * 	2. A variable without one has the types assigned to it
+ * 	3. A param has the types of the arguments passed to it
+ * 	4. A function has the types of the values it returns
+ * A type with several sources is the widest of them, and VAR
+ * when they disagree (a string and a number), which leaves it
+ * dynamic. Calls and returns depend on each other, so the
+ * rules are applied again as long as a type changes after a
+ * rule used it. Code mostly uses what is declared before it,
+ * so one pass usually settles everything.
+ */
+
+#ifndef INFERENCE_H_
+#define INFERENCE_H_
+
+#include "../ast/scope.h"
+#include "../ast/ast.h"
+#include "../ast/astlist.h"
+#include "../ast/workstack.h"
+#include "../token/token.h"
+#include "../number/number.h"
+#include "../mem/allocate.h"
+#include "typechecker.h"
+#include "../../utils/assert.h"
+#include "../../utils/debug.h"
+
+typedef struct TypeInference {
+	Scope* scope;
+	int totalScopes;
+	Token* types; // By node index, UNDEFINED until something is known
+	bool* open; // By node index, the declarations being inferred
+	bool* read; // By node index, types some rule has used
+	ASTNode** funcs; // By scope id, the function the scope is in
+	bool stale; // A type changed after it was used
+	WorkStack stack;
+	WorkStack results;
+} TypeInference;
+
+void InferTypes(Scope* scope);
+void SolveTypes(TypeInference* inference);
+void InitTypeInference(TypeInference* inference, Scope* scope);
+void DestroyTypeInference(TypeInference* inference);
+void InferNodeTypes(TypeInference* inference, ASTNode* node);
+Token InferExpressionType(TypeInference* inference, ASTNode* node);
+Token InferOperandType(TypeInference* inference, ASTNode* node);
+Token InferValueType(TypeInference* inference, ASTNode* var);
+void UnifyType(TypeInference* inference, ASTNode* node, Token type);
+Token JoinTypes(Token a, Token b);
+
+#endif // INFERENCE_H_
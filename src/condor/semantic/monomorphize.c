@@ -0,0 +1,418 @@
+#include "monomorphize.h"
+
+#define NODE_INDEX(mono, node) ((int) ((node) - (mono)->scope->nodes))
+
+/**
+ * Give each function with var params a copy per type of
+ * arguments it is called with, returning how many copies were
+ * made. Copies use the nodes the lexer reserved after the
+ * parsed ones; a group keeps the widened function once they
+ * run out.
+ */
+int Monomorphize(Scope* scope){
+	if (CLONE_LIMIT <= 0) return 0;
+
+	int length = scope->nodeSpot;
+	bool found = false;
+	for (int i = 0; i < length && !found; i++){
+		ASTNode* node = &scope->nodes[i];
+		found = node->type == FUNC && HasVarParams(node);
+	}
+	if (!found) return 0;
+
+	Monomorphizer mono;
+	InitMonomorphizer(&mono, scope);
+	SolveTypes(&mono.inference);
+
+	int clones = 0;
+	for (int i = 0; i < length; i++){
+		ASTNode* node = &scope->nodes[i];
+		if (node->type == FUNC && HasVarParams(node)) clones += SpecializeCalls(&mono, node, length);
+	}
+
+	// The first inference left binary types for the widened
+	// params, they are inferred again for the copies
+	for (int i = 0; i < scope->nodeSpot && i < scope->nodeLength; i++){
+		scope->nodes[i].valueType = UNDEFINED;
+	}
+
+	DestroyMonomorphizer(&mono);
+	return clones;
+}
+
+void InitMonomorphizer(Monomorphizer* mono, Scope* scope){
+	mono->scope = scope;
+	mono->totalScopes = scope->scopeLength + 2;
+	mono->scopeCopies = Allocate(sizeof(int) * mono->totalScopes);
+	for (int i = 0; i < mono->totalScopes; i++) mono->scopeCopies[i] = 0;
+	InitTypeInference(&mono->inference, scope);
+	InitWorkStack(&mono->stack);
+	InitWorkStack(&mono->bodies);
+}
+
+void DestroyMonomorphizer(Monomorphizer* mono){
+	DestroyTypeInference(&mono->inference);
+	DestroyWorkStack(&mono->stack);
+	DestroyWorkStack(&mono->bodies);
+	Free(mono->scopeCopies);
+}
+
+bool HasVarParams(ASTNode* func){
+	FOREACH_AST(GET_FUNC_PARAMS(func)){
+		if (item->node != NULL && item->node->type == VAR && GET_VAR_TYPE(item->node) == VAR) return true;
+	}
+	return false;
+}
+
+/**
+ * Point each call to the function at the copy for its argument
+ * types. Calls from inside the function stay on whichever copy
+ * they are in, and calls in earlier copies were already
+ * decided, so only the parsed nodes outside it are looked at.
+ */
+int SpecializeCalls(Monomorphizer* mono, ASTNode* func, int length){
+	Scope* scope = mono->scope;
+	int arity = 0;
+	FOREACH_AST(GET_FUNC_PARAMS(func)){
+		if (item->node != NULL && item->node->type == VAR && GET_VAR_TYPE(item->node) == VAR) arity++;
+	}
+
+	mono->start = NODE_INDEX(mono, func);
+	mono->end = FindFuncEnd(mono, func, length);
+
+	Token signatures[(CLONE_LIMIT + 1) * arity];
+	ASTNode* targets[CLONE_LIMIT + 1];
+	int total = 0;
+	for (int i = 0; i < length; i++){
+		ASTNode* call = &scope->nodes[i];
+		if (call->type != FUNC_CALL || GET_FUNC_CALL_FUNC(call) != func) continue;
+		if (i >= mono->start && i <= mono->end) continue;
+
+		Token signature[arity];
+		if (!GetCallSignature(mono, call, func, signature)) continue;
+
+		int match = -1;
+		for (int j = 0; j < total && match < 0; j++){
+			if (memcmp(&signatures[j * arity], signature, sizeof(Token) * arity) == 0) match = j;
+		}
+		if (match < 0){
+			if (total > CLONE_LIMIT) continue;
+			ASTNode* target = func;
+			if (total > 0){
+				if (!CanCloneFunc(mono)) continue;
+				target = CloneFunc(mono);
+				DEBUG_PRINT2("Cloned", GET_FUNC_NAME(func));
+			}
+			memcpy(&signatures[total * arity], signature, sizeof(Token) * arity);
+			targets[total] = target;
+			match = total++;
+		}
+		SET_FUNC_CALL_FUNC(call, targets[match]);
+	}
+
+	for (int i = 0; i < mono->bodies.length; i++){
+		mono->scopeCopies[mono->bodies.items[i].value] = 0;
+	}
+	return total > 0 ? total - 1 : 0;
+}
+
+/**
+ * The types of the arguments given to the var params, false
+ * when one is not a known static type
+ */
+bool GetCallSignature(Monomorphizer* mono, ASTNode* call, ASTNode* func, Token* signature){
+	ASTListItem* arg = GET_FUNC_CALL_PARAMS(call)->first;
+	int count = 0;
+	FOREACH_AST(GET_FUNC_PARAMS(func)){
+		if (arg == NULL || arg->node == NULL) return false;
+		ASTNode* param = item->node;
+		if (param != NULL && param->type == VAR && GET_VAR_TYPE(param) == VAR){
+			Token type = InferExpressionType(&mono->inference, arg->node);
+			if (type == UNDEFINED || type == VAR) return false;
+			signature[count++] = type;
+		}
+		arg = arg->next;
+	}
+	return arg == NULL;
+}
+
+/**
+ * The last node of the function. A function is parsed in one
+ * go, so its nodes are the ones from it to the last node its
+ * params and statements reach. Its statements are those in
+ * its body's scopes, which are collected into bodies; they run
+ * up to the first statement after it.
+ */
+int FindFuncEnd(Monomorphizer* mono, ASTNode* func, int length){
+	Scope* scope = mono->scope;
+	WorkStack* stack = &mono->stack;
+	int start = NODE_INDEX(mono, func);
+	int end = start;
+	mono->bodies.length = 0;
+
+	PushWork(stack, func, 1, 0);
+	for (int i = start + 1; i <= length; i++){
+		while (!IS_WORK_STACK_EMPTY(stack)){
+			WorkItem work = PopWork(stack);
+			ASTNode* node = work.node;
+
+			// A variable used in an expression is declared elsewhere
+			if (node == NULL || (node->type == VAR && work.state == 0)) continue;
+
+			int index = NODE_INDEX(mono, node);
+			if (index > end) end = index;
+
+			int body = GetNodeBody(node);
+			if (body > 0 && body < mono->totalScopes && mono->scopeCopies[body] == 0){
+				mono->scopeCopies[body] = -1;
+				PushWork(&mono->bodies, NULL, 0, body);
+			}
+			PushChildren(stack, node);
+		}
+		if (i == length) break;
+
+		ASTNode* node = &scope->nodes[i];
+		if (node->scopeId <= 0) continue;
+		if (node->scopeId >= mono->totalScopes || mono->scopeCopies[node->scopeId] != -1) break;
+		PushWork(stack, node, 1, 0);
+	}
+	return end;
+}
+
+/**
+ * Push what a node owns. Declarations are pushed with state 1,
+ * a variable in an expression is pushed with state 0.
+ */
+void PushChildren(WorkStack* stack, ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case VAR: PushWork(stack, GET_VAR_VALUE(node), 0, 0); break;
+		case BINARY: {
+			if (GET_BIN_OPERANDS(node) != NULL){
+				FOREACH_AST(GET_BIN_OPERANDS(node)) PushWork(stack, item->node, 0, 0);
+			}
+			else {
+				PushWork(stack, GET_BIN_LEFT(node), 0, 0);
+				PushWork(stack, GET_BIN_RIGHT(node), 0, 0);
+			}
+			break;
+		}
+		case FUNC_CALL: {
+			FOREACH_AST(GET_FUNC_CALL_PARAMS(node)) PushWork(stack, item->node, 0, 0);
+			break;
+		}
+		case FUNC: {
+			FOREACH_AST(GET_FUNC_PARAMS(node)) PushWork(stack, item->node, 1, 0);
+			break;
+		}
+		case FOR: {
+			PushWork(stack, GET_FOR_VAR(node), 1, 0);
+			PushWork(stack, GET_FOR_CONDITION(node), 0, 0);
+			PushWork(stack, GET_FOR_INC(node), 0, 0);
+			break;
+		}
+		case IF: PushWork(stack, GET_IF_CONDITION(node), 0, 0); break;
+		case WHILE: PushWork(stack, GET_WHILE_CONDITION(node), 0, 0); break;
+		case SWITCH: PushWork(stack, GET_SWITCH_CONDITION(node), 0, 0); break;
+		case CASE: PushWork(stack, GET_CASE_CONDITION(node), 0, 0); break;
+		case RETURN: PushWork(stack, GET_RETURN_VALUE(node), 0, 0); break;
+		default: {
+			if (!IsAssignment(node->type) && node->type != INC && node->type != DEC) break;
+			PushWork(stack, GET_ASSIGN_VAR(node), 0, 0);
+			PushWork(stack, GET_ASSIGN_VALUE(node), 0, 0);
+			break;
+		}
+	}
+}
+
+/**
+ * The scope a node opens, 0 for none
+ */
+int GetNodeBody(ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case FOR: return GET_FOR_BODY(node);
+		case IF: return GET_IF_BODY(node);
+		case WHILE: return GET_WHILE_BODY(node);
+		case SWITCH: return GET_SWITCH_BODY(node);
+		case CASE: return GET_CASE_BODY(node);
+		case FUNC: return GET_FUNC_BODY(node);
+	}
+	return 0;
+}
+
+/**
+ * The list a node owns, if any
+ */
+ASTList* GetNodeList(ASTNode* node){
+	int type = (int) node->type;
+	switch (type){
+		case FUNC: return GET_FUNC_PARAMS(node);
+		case FUNC_CALL: return GET_FUNC_CALL_PARAMS(node);
+		case BINARY: return GET_BIN_OPERANDS(node);
+	}
+	return NULL;
+}
+
+/**
+ * Whether the reserved nodes, lists and scopes still hold a
+ * copy of the function
+ */
+bool CanCloneFunc(Monomorphizer* mono){
+	Scope* scope = mono->scope;
+	int lists = 0;
+	int items = 0;
+	for (int i = mono->start; i <= mono->end; i++){
+		ASTList* list = GetNodeList(&scope->nodes[i]);
+		if (list == NULL) continue;
+		lists++;
+		FOREACH_AST(list) items++;
+	}
+	return scope->nodeLength - scope->nodeSpot > mono->end - mono->start &&
+		scope->paramsLength - scope->paramsSpot >= lists &&
+		scope->paramItemsLength - scope->paramItemsSpot >= items &&
+		scope->scopeLength + 1 - scope->scopeSpot >= mono->bodies.length;
+}
+
+/**
+ * Copy the function's nodes in order after the last node
+ * used, so the copy's statements run in the same order, and
+ * give its scopes new ids. Returns the copy of the function.
+ */
+ASTNode* CloneFunc(Monomorphizer* mono){
+	Scope* scope = mono->scope;
+	mono->offset = scope->nodeSpot - mono->start;
+	for (int i = 0; i < mono->bodies.length; i++){
+		mono->scopeCopies[mono->bodies.items[i].value] = scope->scopes[scope->scopeSpot++];
+	}
+
+	for (int i = mono->start; i <= mono->end; i++){
+		ASTNode* node = &scope->nodes[i];
+		ASTNode* copy = GetNextNode(scope);
+		SET_NODE_TYPE(copy, node->type);
+		copy->meta = node->meta;
+		copy->isStmt = node->isStmt;
+		copy->valueType = UNDEFINED;
+		copy->scopeId = GetScopeCopy(mono, node->scopeId);
+		copy->parentScopeId = GetScopeCopy(mono, node->parentScopeId);
+	}
+	for (int i = mono->start; i <= mono->end; i++){
+		CopyChildren(mono, &scope->nodes[i + mono->offset]);
+	}
+	return &scope->nodes[mono->start + mono->offset];
+}
+
+/**
+ * Point a copied node at the copies of what it owns and of
+ * the declarations it uses that are in the function. What it
+ * uses from outside is shared.
+ */
+void CopyChildren(Monomorphizer* mono, ASTNode* copy){
+	int type = (int) copy->type;
+	switch (type){
+		case VAR: {
+			SET_VAR_NAME(copy, CloneString(GET_VAR_NAME(copy)));
+			SET_VAR_VALUE(copy, GetNodeCopy(mono, GET_VAR_VALUE(copy)));
+			break;
+		}
+		case STRING: {
+			SET_STRING_VALUE(copy, CloneString(GET_STRING_VALUE(copy)));
+			break;
+		}
+		case BINARY: {
+			SET_BINARY_LEFT(copy, GetNodeCopy(mono, GET_BIN_LEFT(copy)));
+			SET_BINARY_RIGHT(copy, GetNodeCopy(mono, GET_BIN_RIGHT(copy)));
+			SET_BINARY_OPERANDS(copy, CloneList(mono, GET_BIN_OPERANDS(copy)));
+			SET_BINARY_OWNER(copy, GetNodeCopy(mono, GET_BIN_OWNER(copy)));
+			break;
+		}
+		case FUNC_CALL: {
+			SET_FUNC_CALL_FUNC(copy, GetNodeCopy(mono, GET_FUNC_CALL_FUNC(copy)));
+			SET_FUNC_CALL_ARGS(copy, CloneList(mono, GET_FUNC_CALL_PARAMS(copy)));
+			break;
+		}
+		case FUNC: {
+			SET_FUNC_PARAMS(copy, CloneList(mono, GET_FUNC_PARAMS(copy)));
+			SET_FUNC_BODY(copy, GetScopeCopy(mono, GET_FUNC_BODY(copy)));
+			SET_FUNC_TYPE(copy, UNDEFINED);
+			SET_FUNC_PURE(copy, false);
+			SET_FUNC_MEMO(copy, -1);
+			break;
+		}
+		case FOR: {
+			SET_FOR_VAR(copy, GetNodeCopy(mono, GET_FOR_VAR(copy)));
+			SET_FOR_CONDITION(copy, GetNodeCopy(mono, GET_FOR_CONDITION(copy)));
+			SET_FOR_INC(copy, GetNodeCopy(mono, GET_FOR_INC(copy)));
+			SET_FOR_BODY(copy, GetScopeCopy(mono, GET_FOR_BODY(copy)));
+			break;
+		}
+		case IF: {
+			SET_IF_CONDITION(copy, GetNodeCopy(mono, GET_IF_CONDITION(copy)));
+			SET_IF_BODY(copy, GetScopeCopy(mono, GET_IF_BODY(copy)));
+			break;
+		}
+		case WHILE: {
+			SET_WHILE_CONDITION(copy, GetNodeCopy(mono, GET_WHILE_CONDITION(copy)));
+			SET_WHILE_BODY(copy, GetScopeCopy(mono, GET_WHILE_BODY(copy)));
+			break;
+		}
+		case SWITCH: {
+			SET_SWITCH_CONDITION(copy, GetNodeCopy(mono, GET_SWITCH_CONDITION(copy)));
+			SET_SWITCH_BODY(copy, GetScopeCopy(mono, GET_SWITCH_BODY(copy)));
+			break;
+		}
+		case CASE: {
+			SET_CASE_CONDITION(copy, GetNodeCopy(mono, GET_CASE_CONDITION(copy)));
+			SET_CASE_BODY(copy, GetScopeCopy(mono, GET_CASE_BODY(copy)));
+			break;
+		}
+		case RETURN: {
+			SET_RETURN_VALUE(copy, GetNodeCopy(mono, GET_RETURN_VALUE(copy)));
+			break;
+		}
+		default: {
+			if (!IsAssignment(copy->type) && copy->type != INC && copy->type != DEC) break;
+			SET_ASSIGN_VAR(copy, GetNodeCopy(mono, GET_ASSIGN_VAR(copy)));
+			SET_ASSIGN_VALUE(copy, GetNodeCopy(mono, GET_ASSIGN_VALUE(copy)));
+			break;
+		}
+	}
+}
+
+/**
+ * The copy of a node in the function, or the node itself when
+ * it is outside
+ */
+ASTNode* GetNodeCopy(Monomorphizer* mono, ASTNode* node){
+	if (node == NULL) return NULL;
+	int index = NODE_INDEX(mono, node);
+	if (index < mono->start || index > mono->end) return node;
+	return node + mono->offset;
+}
+
+int GetScopeCopy(Monomorphizer* mono, int scopeId){
+	if (scopeId <= 0 || scopeId >= mono->totalScopes) return scopeId;
+	int copy = mono->scopeCopies[scopeId];
+	return copy > 0 ? copy : scopeId;
+}
+
+ASTList* CloneList(Monomorphizer* mono, ASTList* list){
+	if (list == NULL) return NULL;
+	ASTList* copy = GetNextASTList(mono->scope);
+	copy->first = NULL;
+	copy->last = NULL;
+	copy->current = NULL;
+	copy->size = list->size;
+	copy->nodeId = list->nodeId;
+	FOREACH_AST(list){
+		AddToASTList(mono->scope, copy, GetNodeCopy(mono, item->node));
+	}
+	return copy;
+}
+
+char* CloneString(char* value){
+	if (value == NULL) return NULL;
+	char* copy = Allocate(strlen(value) + 1);
+	strcpy(copy, value);
+	return copy;
+}
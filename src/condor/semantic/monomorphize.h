@@ -0,0 +1,73 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Monomorphization. A param declared var takes the types of
+ * every argument passed to it, so one call with a double makes
+ * every call to the function run on doubles. Before the types
+ * are inferred, the calls to a function with such params are
+ * grouped by their argument types. The first group keeps the
+ * function; each other gets its own copy, which inference then
+ * types for that group alone.
+ *
+ * Argument types come from a first inference over the parsed
+ * tree, so a call whose arguments are only known through
+ * another function's var params goes by that function's widened
+ * types: one round of copies, not a copy per path of calls.
+ */
+
+#ifndef MONOMORPHIZE_H_
+#define MONOMORPHIZE_H_
+
+#include <string.h>
+#include "../ast/scope.h"
+#include "../ast/ast.h"
+#include "../ast/astlist.h"
+#include "../ast/workstack.h"
+#include "../token/token.h"
+#include "../mem/allocate.h"
+#include "../syntax/syntax.h"
+#include "inference.h"
+#include "../../utils/assert.h"
+#include "../../utils/debug.h"
+
+/**
+ * The most copies of one function. The lexer reserves nodes
+ * for them, see CountCloneNodes.
+ */
+#ifndef CLONE_LIMIT
+#define CLONE_LIMIT 4
+#endif
+
+typedef struct Monomorphizer {
+	Scope* scope;
+	int totalScopes;
+	int* scopeCopies; // By scope id, the copy's scope, -1 for a scope still to copy
+	int start; // The function being copied is the nodes from start
+	int end; // to end
+	int offset; // Each node's copy is offset nodes after it
+	TypeInference inference;
+	WorkStack stack;
+	WorkStack bodies;
+} Monomorphizer;
+
+int Monomorphize(Scope* scope);
+void InitMonomorphizer(Monomorphizer* mono, Scope* scope);
+void DestroyMonomorphizer(Monomorphizer* mono);
+bool HasVarParams(ASTNode* func);
+int SpecializeCalls(Monomorphizer* mono, ASTNode* func, int length);
+bool GetCallSignature(Monomorphizer* mono, ASTNode* call, ASTNode* func, Token* signature);
+int FindFuncEnd(Monomorphizer* mono, ASTNode* func, int length);
+void PushChildren(WorkStack* stack, ASTNode* node);
+int GetNodeBody(ASTNode* node);
+ASTList* GetNodeList(ASTNode* node);
+bool CanCloneFunc(Monomorphizer* mono);
+ASTNode* CloneFunc(Monomorphizer* mono);
+void CopyChildren(Monomorphizer* mono, ASTNode* copy);
+ASTNode* GetNodeCopy(Monomorphizer* mono, ASTNode* node);
+int GetScopeCopy(Monomorphizer* mono, int scopeId);
+ASTList* CloneList(Monomorphizer* mono, ASTList* list);
+char* CloneString(char* value);
+
+#endif // MONOMORPHIZE_H_
@@ -1,278 +1,479 @@
-#include "semantic.h"
-
-#include <stdio.h>
-
-void Scan(char* rawSourceCode){
-	BuildTree(rawSourceCode);
-}
-
-/**
- * Build the abstract syntax tree for saving
- */
-void BuildTree(char* rawSourceCode){
-	Clock clock;
-	StartClock(&clock);
-
-	DEBUG_PRINT("\n\n------Starting Program------\n");
-
-	// Build Lexer
-	Lexer lexer;
-	InitLexer(&lexer, rawSourceCode);
-
-	// Pre-allocate memory
-	// The heap is 3,000% slower than just using stack
-	// memory. So we are pre-allocating the memory
-	// using the stack
-	int totalNodes = CountTotalASTTokens(&lexer);
-	ResetLexer(&lexer);
-	int totalScopes = CountTotalScopes(&lexer);
-	ResetLexer(&lexer);
-	int totalFuncs = CountTotalFuncs(&lexer);
-	ResetLexer(&lexer);
-	int totalFuncCalls = CountTotalFuncCalls(&lexer);
-	ResetLexer(&lexer);
-	int totalParamItems = CountTotalParamItems(&lexer);
-	ResetLexer(&lexer);
-
-	// Pre-allocate the different param lists
-	ASTList params[totalFuncs + totalFuncCalls];
-	ASTListItem paramItems[totalParamItems];
-	InitParams(params, totalFuncs + totalFuncCalls);
-	InitParamItems(paramItems, totalParamItems);
-
-	// Pre-allocate the different variable types
-	ASTNode nodes[totalNodes];
-	InitNodes(nodes, totalNodes);
-
-	// Pre-allocate the different scopes
-	int scopes[totalScopes + 1];
-	for (int i = 0; i < totalScopes + 1; i++) scopes[i] = i + 1;
-
-	// Build the scope
-	Scope scope;
-	InitScope(&scope);
-	scope.nodeLength = totalNodes;
-	scope.nodes = nodes;
-	scope.scopeLength = totalScopes;
-	scope.scopes = scopes;
-
-	scope.params = params;
-	scope.paramItems = paramItems;
-	scope.paramsLength = totalFuncs + totalFuncCalls;
-	scope.paramItemsLength = totalParamItems;
-
-	// Let's build the tree
-	ParseStmtList(&scope, &lexer, scope.scopes[scope.scopeSpot++], false);
-	scope.nodeSpot = 0;
-	EnsureSemantics(&scope, 1);
-
-	#if EXPAND_AST
-	char* json = ExpandScope(&scope, 0);
-	WriteToFile("compiled.json", json);
-	#endif
-
-	int totalVars = 0;
-	for (int i = 0; i < scope.nodeLength; i++){
-		if (scope.nodes[i].type == VAR ||
-				scope.nodes[i].type == RETURN ||
-				(scope.nodes[i].type > BEGIN_NUMBER && 
-				 scope.nodes[i].type < END_STRING)) totalVars++;
-	}
-
-	Runner runner;
-	RunnerContext runnerContexts[totalVars];
-	runner.contexts = runnerContexts;
-	bool contextUsed[totalVars];
-	runner.contextUsed = contextUsed;
-
-	for (int i = 0; i < totalVars; i++) {
-		runner.contextUsed[i] = false;
-	}
-
-	runner.totalContexts = totalVars;
-	InitRunner(&runner, &scope);
-	Run(&runner, scope.scopes[0]);
-
-
-	// Cleanup
-	DestroyLexer(&lexer);
-	DestroyNodes(nodes, totalNodes);
-	DestroyScope(&scope);
-
-	EndClock(&clock);
-	DEBUG_PRINT("\n\n------Program Completed------\n");
-	DEBUG_PRINT("\n\n------Program Stats------\n");
-	#if DEBUG == 1
-	printf("Time: %lld nanoseconds\n", GetClockNanosecond(&clock));
-	
-	#endif
-}
-
-/**
- * Ensure that the semantics of the inserted code is correct
- */
-void EnsureSemantics(Scope* scope, int scopeId){
-	ASTNode* node = GetNextNode(scope);
-
-	if (node == NULL) return; // Done
-
-	while (node != NULL){
-
-		// wrong scope
-		if (node->scopeId != scopeId) {
-			node = GetNextNode(scope);
-			continue;
-		}
-
-		EnsureSemanticsForNode(scope, node);
-
-		node = GetNextNode(scope);
-	}
-}
-
-/**
- * Ensure the semantics for a given node
- */
-void EnsureSemanticsForNode(Scope* scope, ASTNode* node){
-	CHECK(node != NULL);
-	int type = (int) node->type;
-
-	switch (type){
-		case VAR: {
-			PredictVarType(node);
-			break;
-		}
-		case FOR: {
-			DEBUG_PRINT("Ensuring semantics for FOR loop");
-			PredictVarType(GET_FOR_VAR(node));
-			if (GetBinaryType(GET_FOR_CONDITION(node)) != BOOLEAN){
-				SEMANTIC_ERROR("Invalid For loop condition");
-			}
-			EnsureSemanticsForBody(scope, GET_FOR_BODY(node));
-			break;
-		}
-		case WHILE: {
-			DEBUG_PRINT("Ensuring semantics for WHILE loop");
-			if (GetBinaryType(GET_WHILE_CONDITION(node)) != BOOLEAN){
-				SEMANTIC_ERROR("Invalid While loop condition");
-			}
-			EnsureSemanticsForBody(scope, GET_WHILE_BODY(node));
-			break;
-		}
-		case IF: {
-			DEBUG_PRINT("Ensuring semantics for IF statement");
-			if (GetBinaryType(GET_IF_CONDITION(node)) != BOOLEAN){
-				SEMANTIC_ERROR("Invalid If condition");
-			}
-			EnsureSemanticsForBody(scope, GET_IF_BODY(node));
-			break;
-		}
-		case SWITCH: {
-			DEBUG_PRINT("Ensuring semantics for SWITCH statement");
-			if (GetBinaryType(GET_SWITCH_CONDITION(node)) != BOOLEAN){
-				SEMANTIC_ERROR("Invalid Switch condition");
-			}
-			EnsureSemanticsForBody(scope, GET_SWITCH_BODY(node));
-			break;
-		}
-		case CASE: {
-			DEBUG_PRINT("Ensuring semantics for CASE statement");
-			EnsureSemanticsForBody(scope, GET_CASE_BODY(node));
-			break;
-		}
-		case RETURN: {
-			DEBUG_PRINT("Ensuring semantics for RETURN statement");
-			PredictReturnType(node);
-			break;
-		}	
-		case FUNC: {
-			DEBUG_PRINT2("Ensuring semantics for FUNC", GET_FUNC_NAME(node));
-			ASTList* list = GET_FUNC_PARAMS(node);
-			FOREACH_AST(list){
-				EnsureSemanticsForNode(scope, item->node);
-			}
-			EnsureSemanticsForBody(scope, GET_FUNC_BODY(node));
-			break;
-		}
-		case FUNC_CALL: {
-			DEBUG_PRINT2("Ensuring semantics for FUNC_CALL", GET_FUNC_CALL_NAME(node));
-			ASTList* list = GET_FUNC_CALL_PARAMS(node);
-			int totalParams = 0;
-			FOREACH_AST(list){
-				EnsureSemanticsForNode(scope, item->node);
-				totalParams++;
-			}
-			
-			int totalArgs = 0;
-			ASTList* argList = GET_FUNC_CALL_FUNC_PARAMS(node);
-			FOREACH_AST(argList){
-				totalArgs++;
-			}
-
-			if (totalParams != totalArgs){
-				SEMANTIC_ERROR("Number of params/arguments don't match");
-			}
-
-			break;
-		}
-		default: {
-			break;
-		}
-	}
-}
-
-/**
- * Crawl for the body and reset the location when completed
- */
-void EnsureSemanticsForBody(Scope* scope, int scopeId){
-	int loc = scope->nodeSpot;
-	EnsureSemantics(scope, scopeId);
-	scope->nodeSpot = loc;
-}
-
-/**
- * Predict the return type of a scope
- */
-void PredictReturnType(ASTNode* node){
-	DEBUG_PRINT("Predicting return type");
-
-	if (node->type != RETURN) return;
-
-	ASTNode* value = GET_RETURN_VALUE(node);
-	if (value == NULL){
-		DEBUG_PRINT("Return type is undefined");
-		SET_RETURN_TYPE(node, UNDEFINED);
-	}
-	else if (IsNumber(value->type) || IsString(value->type)){
-		SET_RETURN_TYPE(node, value->type);
-		DEBUG_PRINT2("Return Type Set", TokenToString(value->type));
-	}
-	else if (value->type == BINARY){
-		SET_RETURN_TYPE(node, GetBinaryType(GET_RETURN_VALUE(node)));
-		DEBUG_PRINT2("Return Type Set", TokenToString(GET_RETURN_TYPE(node)));
-	}
-}
-
-/**
- * Predict the variable type, if possible
- */
-void PredictVarType(ASTNode* node){
-	DEBUG_PRINT3("Predicting Variable Type", GET_VAR_NAME(node), TokenToString(GET_VAR(node).dataType));
-
-	if (node->type != VAR) return; // already assigned
-
-	ASTNode* value = GET_VAR_VALUE(node);
-	if (value == NULL) {
-		if (GET_VAR(node).dataType == UNDEFINED){
-			DEBUG_PRINT2("Unable to predict variable type for variable", GET_VAR_NAME(node));
-		}
-	}
-	else if (IsNumber(value->type) || IsString(value->type)){
-		GET_VAR(node).dataType = value->type;
-		DEBUG_PRINT2("Variable Type Set", TokenToString(GET_VAR(node).dataType));
-	}
-	else if (value->type == BINARY){
-		GET_VAR(node).dataType = GetBinaryType(value);
-		DEBUG_PRINT2("Variable Type Set", TokenToString(GET_VAR(node).dataType));
-	}
-}
+#include "semantic.h"
+
+#include <stdio.h>
+
+void Scan(char* rawSourceCode){
+	RunnerOutput output;
+	InitFdOutput(&output, STDOUT_FILENO);
+	BuildTree(rawSourceCode, &output, NULL);
+	DestroyOutput(&output);
+}
+
+/**
+ * Run the source, handing the results to callback as they
+ * are flushed rather than printing them
+ */
+void ScanToCallback(char* rawSourceCode, OutputCallback callback, void* user){
+	RunnerOutput output;
+	InitCallbackOutput(&output, callback, user);
+	BuildTree(rawSourceCode, &output, NULL);
+	DestroyOutput(&output);
+}
+
+/**
+ * Run the source and return its results as one string, which
+ * the caller frees
+ */
+char* ScanToMemory(char* rawSourceCode, int* length){
+	RunnerOutput output;
+	InitMemoryOutput(&output);
+	BuildTree(rawSourceCode, &output, NULL);
+	char* memory = TakeOutputMemory(&output, length);
+	DestroyOutput(&output);
+	return memory;
+}
+
+/**
+ * Run the source, saving a snapshot to path just before the
+ * first top-level call to the function named entry. False
+ * when no snapshot was saved.
+ */
+bool ScanToSnapshot(char* rawSourceCode, char* entry, char* path){
+	RunnerOutput output;
+	InitFdOutput(&output, STDOUT_FILENO);
+	SnapshotPoint point;
+	point.entry = entry;
+	point.path = path;
+	point.saved = false;
+	BuildTree(rawSourceCode, &output, &point);
+	DestroyOutput(&output);
+	return point.saved;
+}
+
+/**
+ * Resume a snapshot saved by ScanToSnapshot, running from the
+ * entry call on. False when path is not a usable snapshot.
+ */
+bool ScanFromSnapshot(char* path){
+	RunnerOutput output;
+	InitFdOutput(&output, STDOUT_FILENO);
+	bool resumed = ResumeSnapshot(path, &output);
+	DestroyOutput(&output);
+	return resumed;
+}
+
+/**
+ * Build the abstract syntax tree for saving. With a snapshot
+ * point, the run saves a snapshot on its way.
+ */
+void BuildTree(char* rawSourceCode, RunnerOutput* output, SnapshotPoint* snapshot){
+	Clock clock;
+	StartClock(&clock);
+
+	DEBUG_PRINT("\n\n------Starting Program------\n");
+
+	// A tree saved by an earlier run of the same source skips
+	// the lexer, parser, checks and optimizer. A snapshot's
+	// tree keeps its entry calls, so is not shared with it.
+	CompileCache cache;
+	InitCompileCache(&cache, rawSourceCode);
+	if (snapshot != NULL) cache.enabled = false;
+	Scope cached;
+	if (LoadCompileCache(&cache, &cached)){
+		int totalVars, memoHits, memoMisses;
+		RunTree(&cached, output, snapshot, &totalVars, &memoHits, &memoMisses);
+		CloseCompileCache(&cache);
+
+		EndClock(&clock);
+		#if DEBUG == 1
+		fprintf(stderr, "Time: %lld nanoseconds\n", GetClockNanosecond(&clock));
+		fprintf(stderr, "Contexts: %d, from the compile cache\n", totalVars);
+		#endif
+		return;
+	}
+
+	// Build Lexer
+	Lexer lexer;
+	InitLexer(&lexer, rawSourceCode);
+
+	// Pre-allocate memory
+	// The heap is 3,000% slower than just using stack
+	// memory. So we are pre-allocating the memory
+	// using the stack
+	int totalNodes = CountTotalASTTokens(&lexer);
+	ResetLexer(&lexer);
+	int totalScopes = CountTotalScopes(&lexer);
+	ResetLexer(&lexer);
+	int totalFuncs = CountTotalFuncs(&lexer);
+	ResetLexer(&lexer);
+	int totalFuncCalls = CountTotalFuncCalls(&lexer);
+	ResetLexer(&lexer);
+	int totalParamItems = CountTotalParamItems(&lexer);
+	ResetLexer(&lexer);
+	int totalOperators = CountTotalOperators(&lexer);
+	ResetLexer(&lexer);
+	int cloneNodes = 0;
+	int cloneScopes = 0;
+	if (totalFuncs > 0){
+		totalNodes += CountInlineNodes(&lexer, INLINE_THRESHOLD);
+		ResetLexer(&lexer);
+		cloneNodes = CountCloneNodes(&lexer, CLONE_LIMIT, &cloneScopes);
+		ResetLexer(&lexer);
+	}
+
+	// A copy of a function has no more nodes, lists or items
+	// than the function has tokens
+	totalNodes += cloneNodes;
+	totalScopes += cloneScopes;
+
+	// A flattened chain of k operands uses one list and k items
+	// for its k - 1 operators, with k at least 3
+	int totalLists = totalFuncs + totalFuncCalls + totalOperators / 2;
+	totalParamItems += totalOperators + totalOperators / 2;
+	totalLists += cloneNodes;
+	totalParamItems += cloneNodes;
+
+	// Pre-allocate the different param lists
+	PREALLOCATE(ASTList, params, totalLists);
+	PREALLOCATE(ASTListItem, paramItems, totalParamItems);
+	InitParams(params, totalLists);
+	InitParamItems(paramItems, totalParamItems);
+
+	// Pre-allocate the different variable types
+	PREALLOCATE(ASTNode, nodes, totalNodes);
+	InitNodes(nodes, totalNodes);
+
+	// Pre-allocate the different scopes
+	int scopes[totalScopes + 1];
+	for (int i = 0; i < totalScopes + 1; i++) scopes[i] = i + 1;
+	int scopeParents[totalScopes + 2];
+
+	// Build the scope
+	Scope scope;
+	InitScope(&scope);
+	scope.nodeLength = totalNodes;
+	scope.nodes = nodes;
+	scope.scopeLength = totalScopes;
+	scope.scopes = scopes;
+
+	scope.params = params;
+	scope.paramItems = paramItems;
+	scope.paramsLength = totalLists;
+	scope.paramItemsLength = totalParamItems;
+	scope.entry = snapshot != NULL ? snapshot->entry : NULL;
+	scope.scopeParents = scopeParents;
+
+	// Let's build the tree
+	int top = scope.scopes[scope.scopeSpot++];
+	OpenScope(&scope, top);
+	ParseStmtList(&scope, &lexer, top, false);
+	CloseScope(&scope, top);
+	OptimizerStats stats;
+	stats.clonedFuncs = Monomorphize(&scope);
+	int parsedNodes = scope.nodeSpot;
+	InferTypes(&scope);
+	scope.nodeSpot = 0;
+	EnsureSemantics(&scope, 1);
+
+	// Inlined copies take the nodes after the parsed ones and
+	// their copies
+	scope.nodeSpot = parsedNodes;
+	Optimize(&scope, &stats);
+	SaveCompileCache(&cache, &scope);
+
+	#if EXPAND_AST
+	FILE* json = fopen("compiled.json", "w");
+	if (json != NULL){
+		ExpandScope(&scope, json);
+		fclose(json);
+	}
+	#endif
+
+	int totalVars, memoHits, memoMisses;
+	RunTree(&scope, output, snapshot, &totalVars, &memoHits, &memoMisses);
+
+	// Cleanup
+	DestroyLexer(&lexer);
+	DestroyNodes(nodes, totalNodes);
+	DestroyScope(&scope);
+	RELEASE(nodes, totalNodes);
+	RELEASE(paramItems, totalParamItems);
+	RELEASE(params, totalLists);
+
+	EndClock(&clock);
+	DEBUG_PRINT("\n\n------Program Completed------\n");
+	DEBUG_PRINT("\n\n------Program Stats------\n");
+	#if DEBUG == 1
+	fprintf(stderr, "Time: %lld nanoseconds\n", GetClockNanosecond(&clock));
+	fprintf(stderr, "Contexts: %d\n", totalVars);
+	fprintf(stderr, "Cloned functions: %d\n", stats.clonedFuncs);
+	fprintf(stderr, "Inlined calls: %d\n", stats.inlinedCalls);
+	fprintf(stderr, "Shared nodes: %d\n", stats.sharedNodes);
+	fprintf(stderr, "Memoized functions: %d, %d hits, %d misses\n", stats.memoizedFuncs, memoHits, memoMisses);
+	fprintf(stderr, "Dead code: %d nodes, %d statements, %d functions, %d variables\n",
+		stats.deadCode.nodes, stats.deadCode.statements, stats.deadCode.funcs, stats.deadCode.vars);
+	
+	#endif
+}
+
+/**
+ * Run a checked tree. contexts is set to the number it used.
+ */
+void RunTree(Scope* scope, RunnerOutput* output, SnapshotPoint* snapshot, int* contexts, int* memoHits, int* memoMisses){
+	int totalNodes = scope->nodeLength;
+	int totalScopes = scope->scopeLength;
+	int totalVars = 0;
+	for (int i = 0; i < scope->nodeLength; i++){
+		if (scope->nodes[i].type == VAR ||
+				scope->nodes[i].type == RETURN ||
+				scope->nodes[i].type == BINARY ||
+				scope->nodes[i].type == FUNC_CALL ||
+				scope->nodes[i].type == INC ||
+				scope->nodes[i].type == DEC ||
+				(scope->nodes[i].type > BEGIN_NUMBER && 
+				 scope->nodes[i].type < END_STRING)) totalVars++;
+	}
+
+	Runner runner;
+	PREALLOCATE(RunnerContext, runnerContexts, totalVars);
+	runner.contexts = runnerContexts;
+	PREALLOCATE(bool, contextUsed, totalVars);
+	runner.contextUsed = contextUsed;
+
+	for (int i = 0; i < totalVars; i++) {
+		runner.contextUsed[i] = false;
+	}
+
+	runner.totalContexts = totalVars;
+
+	PREALLOCATE(RunnerContext*, nodeContexts, totalNodes);
+	runner.nodeContexts = nodeContexts;
+	PREALLOCATE(ASTNode*, statements, totalNodes);
+	runner.statements = statements;
+	int scopeStarts[totalScopes + 3];
+	runner.scopeStarts = scopeStarts;
+	runner.totalScopes = totalScopes + 1;
+
+	InitRunner(&runner, scope, output);
+	if (snapshot != NULL){
+		RunToSnapshot(&runner, scope->scopes[0], snapshot);
+	}
+	else {
+		Run(&runner, scope->scopes[0]);
+	}
+	FlushOutput(output);
+	GetMemoStats(&runner, memoHits, memoMisses);
+
+	DestroyRunner(&runner);
+	RELEASE(statements, totalNodes);
+	RELEASE(nodeContexts, totalNodes);
+	RELEASE(contextUsed, totalVars);
+	RELEASE(runnerContexts, totalVars);
+	*contexts = totalVars;
+}
+
+/**
+ * Ensure that the semantics of the inserted code is correct
+ */
+void EnsureSemantics(Scope* scope, int scopeId){
+	ASTNode* node = GetNextNode(scope);
+
+	if (node == NULL) return; // Done
+
+	while (node != NULL){
+
+		// wrong scope
+		if (node->scopeId != scopeId) {
+			node = GetNextNode(scope);
+			continue;
+		}
+
+		EnsureSemanticsForNode(scope, node);
+
+		node = GetNextNode(scope);
+	}
+}
+
+/**
+ * Ensure the semantics for a given node
+ */
+void EnsureSemanticsForNode(Scope* scope, ASTNode* node){
+	CHECK(node != NULL);
+	int type = (int) node->type;
+
+	switch (type){
+		case VAR: {
+			PredictVarType(node);
+			break;
+		}
+		case FOR: {
+			DEBUG_PRINT("Ensuring semantics for FOR loop");
+			PredictVarType(GET_FOR_VAR(node));
+			if (GetBinaryType(GET_FOR_CONDITION(node)) != BOOLEAN){
+				SEMANTIC_ERROR("Invalid For loop condition");
+			}
+			EnsureSemanticsForBody(scope, GET_FOR_BODY(node));
+			break;
+		}
+		case WHILE: {
+			DEBUG_PRINT("Ensuring semantics for WHILE loop");
+			if (GetBinaryType(GET_WHILE_CONDITION(node)) != BOOLEAN){
+				SEMANTIC_ERROR("Invalid While loop condition");
+			}
+			EnsureSemanticsForBody(scope, GET_WHILE_BODY(node));
+			break;
+		}
+		case IF: {
+			DEBUG_PRINT("Ensuring semantics for IF statement");
+			if (GetBinaryType(GET_IF_CONDITION(node)) != BOOLEAN){
+				SEMANTIC_ERROR("Invalid If condition");
+			}
+			EnsureSemanticsForBody(scope, GET_IF_BODY(node));
+			break;
+		}
+		case SWITCH: {
+			DEBUG_PRINT("Ensuring semantics for SWITCH statement");
+			Token conditionType = GetExpressionType(GET_SWITCH_CONDITION(node));
+			if (!IsNumber(conditionType) && !IsString(conditionType) && conditionType != UNDEFINED){
+				SEMANTIC_ERROR("Invalid Switch condition");
+			}
+			EnsureSemanticsForBody(scope, GET_SWITCH_BODY(node));
+			break;
+		}
+		case CASE: {
+			DEBUG_PRINT("Ensuring semantics for CASE statement");
+			EnsureSemanticsForBody(scope, GET_CASE_BODY(node));
+			break;
+		}
+		case RETURN: {
+			DEBUG_PRINT("Ensuring semantics for RETURN statement");
+			PredictReturnType(node);
+			break;
+		}	
+		case FUNC: {
+			DEBUG_PRINT2("Ensuring semantics for FUNC", GET_FUNC_NAME(node));
+			ASTList* list = GET_FUNC_PARAMS(node);
+			FOREACH_AST(list){
+				EnsureSemanticsForNode(scope, item->node);
+			}
+			EnsureSemanticsForBody(scope, GET_FUNC_BODY(node));
+			break;
+		}
+		case FUNC_CALL: {
+			DEBUG_PRINT2("Ensuring semantics for FUNC_CALL", GET_FUNC_CALL_NAME(node));
+			ASTList* list = GET_FUNC_CALL_PARAMS(node);
+			int totalParams = 0;
+			FOREACH_AST(list){
+				EnsureSemanticsForNode(scope, item->node);
+				totalParams++;
+			}
+			
+			int totalArgs = 0;
+			ASTList* argList = GET_FUNC_CALL_FUNC_PARAMS(node);
+			FOREACH_AST(argList){
+				totalArgs++;
+			}
+
+			if (totalParams != totalArgs){
+				SEMANTIC_ERROR("Number of params/arguments don't match");
+			}
+
+			break;
+		}
+		case INC:
+		case DEC: {
+			DEBUG_PRINT("Ensuring semantics for increment");
+			if (GET_VAR_CONST(GET_ASSIGN_VAR(node))) SEMANTIC_ERROR("Assignment to constant");
+			if (!IsNumber(GetExpressionType(GET_ASSIGN_VAR(node)))){
+				SEMANTIC_OP_ERROR("Invalid operand for", node->type);
+			}
+			break;
+		}
+		default: {
+			if (IsAssignment(node->type)) EnsureAssignment(node);
+			break;
+		}
+	}
+}
+
+/**
+ * Constants can't be assigned, strings only take a plain
+ * assignment, bitwise compound assignments only take integers.
+ */
+void EnsureAssignment(ASTNode* node){
+	DEBUG_PRINT("Ensuring semantics for assignment");
+	Token op = node->type;
+	if (GET_VAR_CONST(GET_ASSIGN_VAR(node))) SEMANTIC_ERROR("Assignment to constant");
+	Token varType = GET_VAR_TYPE(GET_ASSIGN_VAR(node));
+	Token valueType = GetExpressionType(GET_ASSIGN_VALUE(node));
+	if (op == ASSIGN || varType == UNDEFINED || valueType == UNDEFINED) return;
+
+	if (!IsNumber(varType) || !IsNumber(valueType)){
+		SEMANTIC_OP_ERROR("Invalid operand for", op);
+	}
+	if (IsBitwiseOperator(GetAssignmentOperator(op)) &&
+		(!IsIntegerType(varType) || !IsIntegerType(valueType))){
+		SEMANTIC_OP_ERROR("Invalid operand for bitwise operator", op);
+	}
+}
+
+/**
+ * Crawl for the body and reset the location when completed
+ */
+void EnsureSemanticsForBody(Scope* scope, int scopeId){
+	int loc = scope->nodeSpot;
+	EnsureSemantics(scope, scopeId);
+	scope->nodeSpot = loc;
+}
+
+/**
+ * Predict the return type of a scope
+ */
+void PredictReturnType(ASTNode* node){
+	DEBUG_PRINT("Predicting return type");
+
+	if (node->type != RETURN) return;
+
+	ASTNode* value = GET_RETURN_VALUE(node);
+	if (value == NULL){
+		DEBUG_PRINT("Return type is undefined");
+		SET_RETURN_TYPE(node, UNDEFINED);
+	}
+	else if (IsNumber(value->type) || IsString(value->type)){
+		SET_RETURN_TYPE(node, value->type);
+		DEBUG_PRINT2("Return Type Set", TokenToString(value->type));
+	}
+	else if (value->type == BINARY){
+		SET_RETURN_TYPE(node, GetBinaryType(GET_RETURN_VALUE(node)));
+		DEBUG_PRINT2("Return Type Set", TokenToString(GET_RETURN_TYPE(node)));
+	}
+}
+
+/**
+ * Predict the variable type, if possible. A number type that
+ * was declared keeps its width, the value is converted to it.
+ */
+void PredictVarType(ASTNode* node){
+	DEBUG_PRINT3("Predicting Variable Type", GET_VAR_NAME(node), TokenToString(GET_VAR(node).dataType));
+
+	if (node->type != VAR) return; // already assigned
+
+	ASTNode* value = GET_VAR_VALUE(node);
+	Token valueType = UNDEFINED;
+	if (value == NULL) {
+		if (GET_VAR(node).dataType == UNDEFINED){
+			DEBUG_PRINT2("Unable to predict variable type for variable", GET_VAR_NAME(node));
+		}
+	}
+	else if (IsNumber(value->type) || IsString(value->type)){
+		valueType = value->type;
+	}
+	else if (value->type == BINARY){
+		valueType = GetBinaryType(value);
+	}
+
+	if (valueType == UNDEFINED) return;
+	if (IsNumber(GET_VAR(node).dataType) && IsNumber(valueType)) return;
+	GET_VAR(node).dataType = valueType;
+	DEBUG_PRINT2("Variable Type Set", TokenToString(GET_VAR(node).dataType));
+}
@@ -1,42 +1,65 @@
-// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
-// Use of this source code is governed by a BSD-style
-// license that can be found in the LICENSE file.
-
-#ifndef SEMANTIC_H_
-#define SEMANTIC_H_
-
-#include <stdio.h>
-#include "utils/clock.h" // For debugging
-#include "utils/debug.h"
-
-#include "../ast/scope.h"
-#include "../syntax/syntax.h"
-#include "../token/token.h"
-#include "../ast/astlist.h"
-#include "../runner/runner.h"
-#include "typechecker.h"
-#include "utils/file/file.h"
-
-void EnsureSemantics(Scope* scope, int scopeId);
-void EnsureSemanticsForBody(Scope* scope, int scopeId);
-
-void EnsureSemanticsForNode(Scope* scope, ASTNode* node);
-
-/**
- * Used to predict VAR type. Algorithm goes as follows:
- * 	1. String literal = string
- * 	2. number literal = number
- */
-void PredictVarType(ASTNode* node);
-
-/**
- * Used to predict RETURN type. Return type will
- * determine what the function return type is.
- */
-void PredictReturnType(ASTNode* node);
-
-// TODO: Remove
-void Scan(char* rawSourceCode);
-void BuildTree(char* rawSourceCode);
-
-#endif // SEMANTIC_H_
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef SEMANTIC_H_
+#define SEMANTIC_H_
+
+#include <stdio.h>
+#include "utils/clock.h" // For debugging
+#include "utils/debug.h"
+
+#include "../ast/scope.h"
+#include "../syntax/syntax.h"
+#include "../token/token.h"
+#include "../ast/astlist.h"
+#include "../runner/runner.h"
+#include "typechecker.h"
+#include "inference.h"
+#include "monomorphize.h"
+#include "../optimizer/optimizer.h"
+#include "../cache/cache.h"
+#include "../cache/snapshot.h"
+#include "utils/file/file.h"
+
+/**
+ * Arrays with more than STACK_LIMIT items are put on the heap
+ * instead of the stack, so a huge generated script does not
+ * overflow the C stack. Smaller ones keep using the stack,
+ * with at least one item since a script may have none.
+ */
+#define STACK_LIMIT 8192
+#define PREALLOCATE(type, name, count) \
+	type name##Stack[(count) > STACK_LIMIT || (count) < 1 ? 1 : (count)]; \
+	type* name = (count) > STACK_LIMIT ? Allocate(sizeof(type) * (count)) : name##Stack
+#define RELEASE(name, count) if ((count) > STACK_LIMIT) Free(name)
+
+void EnsureSemantics(Scope* scope, int scopeId);
+void EnsureSemanticsForBody(Scope* scope, int scopeId);
+
+void EnsureSemanticsForNode(Scope* scope, ASTNode* node);
+void EnsureAssignment(ASTNode* node);
+
+/**
+ * Used to predict VAR type. Algorithm goes as follows:
+ * 	1. String literal = string
+ * 	2. number literal = number
+ */
+void PredictVarType(ASTNode* node);
+
+/**
+ * Used to predict RETURN type. Return type will
+ * determine what the function return type is.
+ */
+void PredictReturnType(ASTNode* node);
+
+// TODO: Remove
+void Scan(char* rawSourceCode);
+void ScanToCallback(char* rawSourceCode, OutputCallback callback, void* user);
+char* ScanToMemory(char* rawSourceCode, int* length);
+bool ScanToSnapshot(char* rawSourceCode, char* entry, char* path);
+bool ScanFromSnapshot(char* path);
+void BuildTree(char* rawSourceCode, RunnerOutput* output, SnapshotPoint* snapshot);
+void RunTree(Scope* scope, RunnerOutput* output, SnapshotPoint* snapshot, int* contexts, int* memoHits, int* memoMisses);
+
+#endif // SEMANTIC_H_
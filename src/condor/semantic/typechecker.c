@@ -1,73 +1,155 @@
-#include "typechecker.h"
-
-/**
- * Get the binary type
- */
-Token GetBinaryType(ASTNode* node){
-
-	if (node->type == BOOLEAN) return BOOLEAN;
-	else if (node->type == VAR){
-		if (GET_VAR_TYPE(node) == UNDEFINED) {
-			NOT_IMPLEMENTED("GetBinaryType, var, undefined type");
-			return UNDEFINED;
-		}
-		return GET_VAR_TYPE(node);
-	}
-
-	CHECK(node->type == BINARY);
-	ASTNode* leftNode = GET_BIN_LEFT(node);
-	ASTNode* rightNode = GET_BIN_RIGHT(node);
-	Token op = GET_BIN_OP(node);
-
-	Token left = leftNode->type;
-	Token right = rightNode->type;
-
-	if (left == VAR) left = GET_VAR_TYPE(leftNode);
-	if (right == VAR) right = GET_VAR_TYPE(rightNode);
-
-	if (right == BINARY) right = GetBinaryType(rightNode);
-
-	// Check number types
-	if (IsNumber(left) && IsNumber(right) && IsBinaryOperator(op)){
-		if (left > right) return left;
-		return right;
-	}
-
-	if (left == STRING || right == STRING) {
-		if (op != ADD && IsBinaryOperator(op)) SEMANTIC_OP_ERROR("Invalid operator against string", op);
-		return STRING; // string dominates
-	}
-
-	if (IsBooleanOperator(op)) return BOOLEAN;
-
-	NOT_IMPLEMENTED(TokenToString(op));
-	return UNDEFINED;
-}
-
-#ifdef IS_TEST
-	void Test_GetBinaryType(){
-		ASTNode node;
-		node.type = BINARY;
-
-		ASTNode left;
-		ASTNode right;
-
-		Token numberTypes[] = {BOOLEAN, BYTE, SHORT, INT, FLOAT, DOUBLE, LONG, DOUBLE, CHAR, STRING};
-		Token operators[] = {LAND, LOR, EQL, NEQ, LEQ, GEQ, NOT, LESS, GREATER};
-
-		for (int i = 0; i < 8; i++){
-			for (int j = 0; j < 8; j++){
-				left.type = numberTypes[i];
-				right.type = numberTypes[j];
-				node.meta.binaryExpr.left = &left;
-				node.meta.binaryExpr.right = &right;
-				for (int k = 0; k < 9; k++){
-					node.meta.binaryExpr.op = operators[k];
-					Token result = GetBinaryType(&node);
-					if (result != BOOLEAN || result == UNDEFINED) FAILED_TEST3(TokenToString(numberTypes[i]), TokenToString(numberTypes[j]), TokenToString(operators[k]));
-				}
-			}
-		}
-		SUCCESS_TEST("Binary Types")
-	}
+#include "typechecker.h"
+
+/**
+ * Get the type of any expression node. A function call has
+ * its function's return type, see InferTypes.
+ */
+Token GetExpressionType(ASTNode* node){
+	if (node == NULL) return UNDEFINED;
+	if (node->type == BINARY) return GetBinaryType(node);
+	if (node->type == VAR) return GET_VAR_TYPE(node);
+	if (node->type == FUNC_CALL) return GetOperandType(node);
+	if (node->type == INC || node->type == DEC) return GET_VAR_TYPE(GET_ASSIGN_VAR(node));
+	if (IsNumber(node->type) || IsString(node->type)) return node->type;
+	return UNDEFINED;
+}
+
+/**
+ * The type of a binary operand that is not itself a binary
+ */
+Token GetOperandType(ASTNode* node){
+	if (node->type == VAR) return GET_VAR_TYPE(node);
+	if (node->type == INC || node->type == DEC) return GetExpressionType(node);
+	if (node->type == FUNC_CALL){
+		ASTNode* func = GET_FUNC_CALL_FUNC(node);
+		return func != NULL && func->type == FUNC ? GET_FUNC_TYPE(func) : UNDEFINED;
+	}
+	return node->type;
+}
+
+/**
+ * The type of op applied to operands of the given types
+ */
+Token GetOperatorType(Token op, Token left, Token right){
+	// Bitwise operators only take integers
+	if (IsBitwiseOperator(op)){
+		if (!IsIntegerType(left) || !IsIntegerType(right)) SEMANTIC_OP_ERROR("Invalid operand for bitwise operator", op);
+		return GetPromotedType(left, right);
+	}
+
+	// Check number types
+	if (IsNumber(left) && IsNumber(right) && IsBinaryOperator(op)){
+		return GetPromotedType(left, right);
+	}
+
+	if (left == STRING || right == STRING) {
+		if (op != ADD && IsBinaryOperator(op)) SEMANTIC_OP_ERROR("Invalid operator against string", op);
+		return STRING; // string dominates
+	}
+
+	if (IsBooleanOperator(op)) return BOOLEAN;
+
+	NOT_IMPLEMENTED(TokenToString(op));
+	return UNDEFINED;
+}
+
+/**
+ * Get the binary type. The tree is walked with an explicit
+ * stack: operands are typed left to right and each binary
+ * combines the top two types, so deep chains use no C stack.
+ * Every binary keeps its type, so a subtree is walked once
+ * and later queries are O(1).
+ */
+Token GetBinaryType(ASTNode* node){
+
+	if (node->type == BOOLEAN) return BOOLEAN;
+	else if (node->type == VAR){
+		if (GET_VAR_TYPE(node) == UNDEFINED) {
+			NOT_IMPLEMENTED("GetBinaryType, var, undefined type");
+			return UNDEFINED;
+		}
+		return GET_VAR_TYPE(node);
+	}
+
+	CHECK(node->type == BINARY);
+	if (node->valueType != UNDEFINED) return node->valueType;
+
+	WorkStack work;
+	WorkStack types;
+	InitWorkStack(&work);
+	InitWorkStack(&types);
+	PushWork(&work, node, 0, 0);
+
+	while (!IS_WORK_STACK_EMPTY(&work)){
+		WorkItem item = PopWork(&work);
+		if (item.node->type != BINARY){
+			PushWork(&types, NULL, 0, GetOperandType(item.node));
+		}
+		else if (item.state == 0 && item.node->valueType != UNDEFINED){
+			PushWork(&types, NULL, 0, item.node->valueType);
+		}
+		else if (item.state == 0 && GET_BIN_OPERANDS(item.node) != NULL){
+			// A chain, its operands are pushed last to first so
+			// they are typed first to last
+			ASTList* list = GET_BIN_OPERANDS(item.node);
+			int count = 0;
+			FOREACH_AST(list) count++;
+
+			PushWork(&work, item.node, 1, count);
+			for (ASTListItem* operand = list->last; operand != NULL; operand = operand->prev){
+				PushWork(&work, operand->node, 0, 0);
+			}
+		}
+		else if (item.state == 0){
+			PushWork(&work, item.node, 1, 2);
+			PushWork(&work, GET_BIN_RIGHT(item.node), 0, 0);
+			PushWork(&work, GET_BIN_LEFT(item.node), 0, 0);
+		}
+		else{
+			// Fold the operand types left to right
+			WorkItem* operandTypes = &types.items[types.length - item.value];
+			Token type = operandTypes[0].value;
+			for (int i = 1; i < item.value; i++){
+				type = GetOperatorType(GET_BIN_OP(item.node), type, operandTypes[i].value);
+			}
+			types.length -= item.value;
+			item.node->valueType = type;
+			PushWork(&types, NULL, 0, type);
+		}
+	}
+
+	Token type = PopWork(&types).value;
+	DestroyWorkStack(&work);
+	DestroyWorkStack(&types);
+	return type;
+}
+
+#ifdef IS_TEST
+	void Test_GetBinaryType(){
+		ASTNode node;
+		node.type = BINARY;
+
+		ASTNode left;
+		ASTNode right;
+
+		Token numberTypes[] = {BOOLEAN, BYTE, SHORT, INT, FLOAT, DOUBLE, LONG, DOUBLE, CHAR, STRING};
+		Token operators[] = {LAND, LOR, EQL, NEQ, LEQ, GEQ, NOT, LESS, GREATER};
+
+		for (int i = 0; i < 8; i++){
+			for (int j = 0; j < 8; j++){
+				left.type = numberTypes[i];
+				right.type = numberTypes[j];
+				node.meta.binaryExpr.left = &left;
+				node.meta.binaryExpr.right = &right;
+				for (int k = 0; k < 9; k++){
+					node.meta.binaryExpr.op = operators[k];
+					node.meta.binaryExpr.operands = NULL;
+					node.valueType = UNDEFINED;
+					Token result = GetBinaryType(&node);
+					if (result != BOOLEAN || result == UNDEFINED) FAILED_TEST3(TokenToString(numberTypes[i]), TokenToString(numberTypes[j]), TokenToString(operators[k]));
+				}
+			}
+		}
+		SUCCESS_TEST("Binary Types")
+	}
 #endif
\ No newline at end of file
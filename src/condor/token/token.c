@@ -1,40 +1,101 @@
-#include "token.h"
-
-struct TokensArray {
-	enum Tokens token;
-	char* str;
-} TokensArray[TOTAL_TOKENS] = {CREATE_TOKEN_LIST(T_ARRAY)};
-
-Token StringToToken(char* value){
-	if (value == NULL || strlen(value) == 0) return UNDEFINED;
-	for (int i = 0; i < (int) TOTAL_TOKENS; i++){
-		if (strlen(value) == strlen(TokensArray[i].str) && strcmp(value, TokensArray[i].str) == 0){
-			return TokensArray[i].token;
-		}
-	}
-	return UNDEFINED;
-}
-
-char* TokenToString(Token tok){
-	return TokensArray[tok].str;
-}
-
-bool IsAssignment(Token tok){
-	return tok > BEGIN_ASSIGNMENT && tok < END_ASSIGNMENT;
-}
-
-bool IsBinaryOperator(Token tok){
-	return tok > BEGIN_BINARY_OPERATOR && tok < END_BINARY_OPERATOR;
-}
-
-bool IsBooleanOperator(Token tok){
-	return tok > BEGIN_BOOLEAN_COMPARISON && tok < END_BOOLEAN_COMPARISON;
-}
-
-bool IsNumber(Token tok){
-	return tok > BEGIN_NUMBER && tok < END_NUMBER;
-}
-
-bool IsString(Token tok){
-	return tok > BEGIN_STRING && tok < END_STRING;
+#include "token.h"
+
+struct TokensArray {
+	enum Tokens token;
+	char* str;
+} TokensArray[TOTAL_TOKENS] = {CREATE_TOKEN_LIST(T_ARRAY)};
+
+Token StringToToken(char* value){
+	if (value == NULL || strlen(value) == 0) return UNDEFINED;
+	for (int i = 0; i < (int) TOTAL_TOKENS; i++){
+		if (strlen(value) == strlen(TokensArray[i].str) && strcmp(value, TokensArray[i].str) == 0){
+			return TokensArray[i].token;
+		}
+	}
+	return UNDEFINED;
+}
+
+char* TokenToString(Token tok){
+	return TokensArray[tok].str;
+}
+
+bool IsAssignment(Token tok){
+	return tok > BEGIN_ASSIGNMENT && tok < END_ASSIGNMENT;
+}
+
+/**
+ * The binary operator a compound assignment applies,
+ * e.g. ADD for +=. UNDEFINED for plain ASSIGN.
+ */
+Token GetAssignmentOperator(Token tok){
+	switch ((int) tok){
+		case ADD_ASSIGN: return ADD;
+		case SUB_ASSIGN: return SUB;
+		case MUL_ASSIGN: return MUL;
+		case DIV_ASSIGN: return DIV;
+		case MOD_ASSIGN: return MOD;
+		case AND_ASSIGN: return AND;
+		case OR_ASSIGN: return OR;
+		case XOR_ASSIGN: return XOR;
+		case SHL_ASSIGN: return SHL;
+		case SHR_ASSIGN: return SHR;
+		case AND_NOT_ASSIGN: return AND_NOT;
+	}
+	return UNDEFINED;
+}
+
+bool IsBinaryOperator(Token tok){
+	return tok > BEGIN_BINARY_OPERATOR && tok < END_BINARY_OPERATOR;
+}
+
+bool IsBitwiseOperator(Token tok){
+	return tok > BEGIN_BITWISE_OPERATOR && tok < END_BITWISE_OPERATOR;
+}
+
+bool IsBooleanOperator(Token tok){
+	return tok > BEGIN_BOOLEAN_COMPARISON && tok < END_BOOLEAN_COMPARISON;
+}
+
+/**
+ * How tightly an infix operator binds, higher binds tighter.
+ * 0 for tokens that are not infix operators.
+ */
+int GetPrecedence(Token tok){
+	int type = (int) tok;
+	switch (type){
+		case LOR: return 1;
+		case LAND: return 2;
+		case EQL: case NEQ:
+		case LESS: case LEQ:
+		case GREATER: case GEQ: return 3;
+		case ADD: case SUB:
+		case OR: case XOR: return 4;
+		case MUL: case DIV: case MOD:
+		case AND: case AND_NOT:
+		case SHL: case SHR: return 5;
+		case POW: return 6;
+	}
+	return 0;
+}
+
+bool IsRightAssociative(Token tok){
+	return tok == POW;
+}
+
+/**
+ * Operators whose chains (a op b op c ...) can be folded
+ * left to right in a single n-ary node.
+ */
+bool IsAssociativeOperator(Token tok){
+	return tok == ADD || tok == MUL ||
+		tok == AND || tok == OR || tok == XOR ||
+		tok == LAND || tok == LOR;
+}
+
+bool IsNumber(Token tok){
+	return tok > BEGIN_NUMBER && tok < END_NUMBER;
+}
+
+bool IsString(Token tok){
+	return tok > BEGIN_STRING && tok < END_STRING;
 }
\ No newline at end of file
@@ -1,39 +1,49 @@
-// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
-// Use of this source code is governed by a BSD-style
-// license that can be found in the LICENSE file.
-
-#ifndef ASSERT_H_
-#define ASSERT_H_
-
-#include <execinfo.h>
-#include "condor/token/token.h"
-
-#define EXPECT_TOKEN(got, tok, lexer) if (tok != got) { \
-	printf("Parse error: Expected: %s, but got: %s, at %d:%d\n", #tok, TokenToString(got), lexer->tracker.row, lexer->tracker.col + lexer->tracker.currentTokenPosition - 1); \
-	exit(0); \
-}
-
-#define EXPECT_STRING(val) { printf("Expected: %s\n", val); exit(0); }
-#define NOT_IMPLEMENTED(val) { printf("Not Implemented (%s:%d): %s\n", __FUNCTION__, __LINE__, val); exit(0); }
-#define CHECK(condition) { \
-	if (condition == false) { \
-		printf("Invalid Check: %s in %s:%d\n", #condition, __FUNCTION__, __LINE__); \
-		void* callstack[128]; \
-		int i, frames = backtrace(callstack, 128); \
-		char** strs = backtrace_symbols(callstack, frames); \
-		for (i = 0; i < frames; ++i) { \
-				printf("%s\n", strs[i]); \
-		} \
-		free(strs); \
-	} \
-}
-#define SEMANTIC_ERROR(msg) {printf("%s\n", msg); exit(0);}
-#define RUNTIME_ERROR(msg) {printf("%s\n", msg); exit(0);}
-#define SYMBOL_NOT_FOUND(symbol, lexer) {printf("Symbol not found: \"%s\", at %d:%d\n", symbol, lexer->tracker.row, lexer->tracker.col + lexer->tracker.currentTokenPosition - 1); exit(0);}
-#define SEMANTIC_OP_ERROR(msg, op) {printf("%s - %s\n", msg, TokenToString(op)); exit(0);}
-#define FAILED_TEST(msg){printf("Failed Test - %s - %s:%d\n", msg, __FUNCTION__, __LINE__); exit(0);}
-#define FAILED_TEST3(msg, msg2, msg3){printf("Failed Test - %s %s %s - %s:%d\n", msg, msg2, msg3, __FUNCTION__, __LINE__); exit(0);}
-#define SUCCESS_TEST(msg){printf("Success Test - %s\n", msg);}
-#define FETAL_CRASH(){printf("%s (%s:%d)\n", "Miscalculated memory, please report.", __FUNCTION__, __LINE__); exit(0);}
-
-#endif // ASSERT_H_
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef ASSERT_H_
+#define ASSERT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <execinfo.h>
+#include "condor/token/token.h"
+
+#define EXPECT_TOKEN(got, tok, lexer) if (tok != got) { \
+	printf("Parse error: Expected: %s, but got: %s, at %d:%d\n", #tok, TokenToString(got), lexer->tracker.row, lexer->tracker.col + lexer->tracker.currentTokenPosition - 1); \
+	exit(0); \
+}
+
+#define EXPECT_STRING(val) { printf("Expected: %s\n", val); exit(0); }
+#define NOT_IMPLEMENTED(val) { printf("Not Implemented (%s:%d): %s\n", __FUNCTION__, __LINE__, val); exit(0); }
+#define CHECK(condition) { \
+	if (condition == false) { \
+		printf("Invalid Check: %s in %s:%d\n", #condition, __FUNCTION__, __LINE__); \
+		PrintBacktrace(); \
+	} \
+}
+#define SEMANTIC_ERROR(msg) {printf("%s\n", msg); exit(0);}
+#define RUNTIME_ERROR(msg) {printf("%s\n", msg); exit(0);}
+#define SYMBOL_NOT_FOUND(symbol, lexer) {printf("Symbol not found: \"%s\", at %d:%d\n", symbol, lexer->tracker.row, lexer->tracker.col + lexer->tracker.currentTokenPosition - 1); exit(0);}
+#define SEMANTIC_OP_ERROR(msg, op) {printf("%s - %s\n", msg, TokenToString(op)); exit(0);}
+#define FAILED_TEST(msg){printf("Failed Test - %s - %s:%d\n", msg, __FUNCTION__, __LINE__); exit(0);}
+#define FAILED_TEST3(msg, msg2, msg3){printf("Failed Test - %s %s %s - %s:%d\n", msg, msg2, msg3, __FUNCTION__, __LINE__); exit(0);}
+#define SUCCESS_TEST(msg){printf("Success Test - %s\n", msg);}
+#define FETAL_CRASH(){printf("%s (%s:%d)\n", "Miscalculated memory, please report.", __FUNCTION__, __LINE__); exit(0);}
+
+/**
+ * Out of line, so each function using CHECK does not keep
+ * room for the call stack in its own frame
+ */
+__attribute__((noinline, cold, unused)) static void PrintBacktrace(void){
+	void* callstack[128];
+	int i, frames = backtrace(callstack, 128);
+	char** strs = backtrace_symbols(callstack, frames);
+	for (i = 0; i < frames; ++i) {
+			printf("%s\n", strs[i]);
+	}
+	free(strs);
+}
+
+#endif // ASSERT_H_
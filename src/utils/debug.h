@@ -5,6 +5,7 @@
 #ifndef DEBUG_H_
 #define DEBUG_H_
 
+#include <stdio.h>
 #include <string.h>
 
 #if TEST == 1
@@ -17,7 +18,8 @@
 	#define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
 	
 	/**
-	 * Debugging support. If the DEBUG_NAMESPACE variable is the filename, then it will print
+	 * Debugging support. If the DEBUG_NAMESPACE variable is the filename, then it will print.
+	 * It goes to stderr, so stdout keeps only the program's results.
 	 */
 	#ifndef DEBUG_NAMESPACE
 		#define DEBUG_NAMESPACE "All"
@@ -32,15 +34,15 @@
 		#define SHOULD_PRINT_SYNTAX true
 	#endif
 
-	#define DEBUG_PRINT(a) if (SHOULD_PRINT(__FILENAME__)) printf("%s:%d - %s\n", __FILENAME__, __LINE__, a);
-	#define DEBUG_PRINT2(a, b) if (SHOULD_PRINT(__FILENAME__)) printf("%s:%d - %s - %s\n", __FILENAME__, __LINE__, a, b);
-	#define DEBUG_PRINT3(a, b, c) if (SHOULD_PRINT(__FILENAME__)) printf("%s:%d - %s - %s - %s\n", __FILENAME__, __LINE__, a, b, c);
-	#define DEBUG_PRINT_RUNNER(a) if (SHOULD_PRINT(__FILENAME__)) {printf("Runner: %s\n", a); }
-	#define DEBUG_PRINT_RUNNER2(a, b) if (SHOULD_PRINT(__FILENAME__)) {printf("Runner: %s %s\n", a, b); }
-	#define DEBUG_RUNNER(fmt, ...) if (SHOULD_PRINT(__FILENAME__)) {printf(fmt, ##__VA_ARGS__); }
-	#define DEBUG_PRINT_SYNTAX(a) if (SHOULD_PRINT_SYNTAX) {printf("Parsing: %s:%d\n", a, __LINE__); }
-	#define DEBUG_PRINT_SYNTAX2(a, b) if(SHOULD_PRINT_SYNTAX) {printf("Parsing: %s %s:%d\n", a, b, __LINE__); }
-	#define TRACK() {if (true) {printf("%s : %d\n", __FUNCTION__, __LINE__);}}
+	#define DEBUG_PRINT(a) if (SHOULD_PRINT(__FILENAME__)) fprintf(stderr, "%s:%d - %s\n", __FILENAME__, __LINE__, a);
+	#define DEBUG_PRINT2(a, b) if (SHOULD_PRINT(__FILENAME__)) fprintf(stderr, "%s:%d - %s - %s\n", __FILENAME__, __LINE__, a, b);
+	#define DEBUG_PRINT3(a, b, c) if (SHOULD_PRINT(__FILENAME__)) fprintf(stderr, "%s:%d - %s - %s - %s\n", __FILENAME__, __LINE__, a, b, c);
+	#define DEBUG_PRINT_RUNNER(a) if (SHOULD_PRINT(__FILENAME__)) {fprintf(stderr, "Runner: %s\n", a); }
+	#define DEBUG_PRINT_RUNNER2(a, b) if (SHOULD_PRINT(__FILENAME__)) {fprintf(stderr, "Runner: %s %s\n", a, b); }
+	#define DEBUG_RUNNER(fmt, ...) if (SHOULD_PRINT(__FILENAME__)) {fprintf(stderr, fmt, ##__VA_ARGS__); }
+	#define DEBUG_PRINT_SYNTAX(a) if (SHOULD_PRINT_SYNTAX) {fprintf(stderr, "Parsing: %s:%d\n", a, __LINE__); }
+	#define DEBUG_PRINT_SYNTAX2(a, b) if(SHOULD_PRINT_SYNTAX) {fprintf(stderr, "Parsing: %s %s:%d\n", a, b, __LINE__); }
+	#define TRACK() {if (true) {fprintf(stderr, "%s : %d\n", __FUNCTION__, __LINE__);}}
 
 #else	 
 	#define DEBUG_PRINT(a) 
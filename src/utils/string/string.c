@@ -9,4 +9,100 @@ char* Concat(const char* left, const char* right){
     memcpy(result + len1, right, len2 + 1);//+1 to copy the null-terminator
 
     return result;
-}
\ No newline at end of file
+}
+
+void InitStringBuilder(StringBuilder* builder, Arena* arena){
+	builder->arena = arena;
+	builder->length = 0;
+	builder->capacity = STRING_BUILDER_CAPACITY;
+	builder->value = arena != NULL ?
+		ArenaAllocate(arena, builder->capacity) :
+		Allocate(builder->capacity);
+	if (builder->value == NULL) RUNTIME_ERROR("Out of memory for a string");
+	builder->value[0] = '\0';
+}
+
+/**
+ * An arena's memory is left to the arena
+ */
+void DestroyStringBuilder(StringBuilder* builder){
+	if (builder->arena == NULL && builder->value != NULL) Free(builder->value);
+	builder->value = NULL;
+	builder->length = 0;
+	builder->capacity = 0;
+}
+
+/**
+ * Make room for extra more characters
+ */
+void ReserveString(StringBuilder* builder, int extra){
+	int needed = builder->length + extra + 1;
+	if (needed <= builder->capacity) return;
+
+	int capacity = builder->capacity > 0 ? builder->capacity : STRING_BUILDER_CAPACITY;
+	while (capacity < needed) capacity *= 2;
+	char* value = builder->arena != NULL ?
+		ArenaReallocate(builder->arena, builder->value, builder->capacity, capacity) :
+		Reallocate(builder->value, capacity);
+	if (value == NULL) RUNTIME_ERROR("Out of memory for a string");
+	builder->value = value;
+	builder->capacity = capacity;
+}
+
+void AppendString(StringBuilder* builder, const char* value){
+	AppendStringLength(builder, value, (int) strlen(value));
+}
+
+void AppendStringLength(StringBuilder* builder, const char* value, int length){
+	ReserveString(builder, length);
+	memcpy(&builder->value[builder->length], value, length);
+	builder->length += length;
+	builder->value[builder->length] = '\0';
+}
+
+void AppendChar(StringBuilder* builder, char value){
+	ReserveString(builder, 1);
+	builder->value[builder->length++] = value;
+	builder->value[builder->length] = '\0';
+}
+
+void AppendLong(StringBuilder* builder, long value){
+	ReserveString(builder, FORMAT_BUFFER_SIZE);
+	builder->length += FormatLong(value, &builder->value[builder->length]);
+}
+
+void AppendDouble(StringBuilder* builder, double value){
+	ReserveString(builder, FORMAT_BUFFER_SIZE);
+	builder->length += FormatDouble(value, &builder->value[builder->length]);
+}
+
+/**
+ * printf into the free space. Only when it does not fit is
+ * the room made and the format run again.
+ */
+void AppendFormat(StringBuilder* builder, const char* format, ...){
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(&builder->value[builder->length], builder->capacity - builder->length, format, args);
+	va_end(args);
+	if (length < 0) return;
+
+	if (builder->length + length >= builder->capacity){
+		ReserveString(builder, length);
+		va_start(args, format);
+		vsnprintf(&builder->value[builder->length], builder->capacity - builder->length, format, args);
+		va_end(args);
+	}
+	builder->length += length;
+}
+
+/**
+ * The built string, which the caller frees unless it came
+ * from an arena. The builder starts over empty.
+ */
+char* TakeString(StringBuilder* builder, int* length){
+	char* value = builder->value;
+	if (length != NULL) *length = builder->length;
+	InitStringBuilder(builder, builder->arena);
+	return value;
+}
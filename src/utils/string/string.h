@@ -7,7 +7,12 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
 #include "condor/mem/allocate.h"
+#include "condor/mem/arena.h"
+#include "condor/number/format.h"
+#include "utils/assert.h"
 
 /**
  * freeWhich:
@@ -17,4 +22,33 @@
  */
 char* Concat(const char* left, const char* right);
 
+// The room a StringBuilder starts with
+#define STRING_BUILDER_CAPACITY 64
+
+/**
+ * A string appended to in place. The capacity doubles as it
+ * fills, so n appended characters cost O(n) copies. value is
+ * always NUL terminated.
+ *
+ * With an arena the memory comes from it and is released
+ * with the arena, see TakeString.
+ */
+typedef struct StringBuilder {
+	char* value;
+	int length;
+	int capacity; // Includes the NUL
+	Arena* arena; // NULL for Allocate
+} StringBuilder;
+
+void InitStringBuilder(StringBuilder* builder, Arena* arena);
+void DestroyStringBuilder(StringBuilder* builder);
+void ReserveString(StringBuilder* builder, int extra);
+void AppendString(StringBuilder* builder, const char* value);
+void AppendStringLength(StringBuilder* builder, const char* value, int length);
+void AppendChar(StringBuilder* builder, char value);
+void AppendLong(StringBuilder* builder, long value);
+void AppendDouble(StringBuilder* builder, double value);
+void AppendFormat(StringBuilder* builder, const char* format, ...);
+char* TakeString(StringBuilder* builder, int* length);
+
 #endif // STRING_H_
@@ -1,5 +1,90 @@
 #include <stdio.h>
+#include "test.h"
+#include "test_ast.h"
+#include "condor/ast/ast.h"
+#include "condor/ast/scope.h"
 
 void Test_InitNodes() {
   // InitNodes();
-}
\ No newline at end of file
+}
+
+void Test_ExpandScope() {
+  // var s = "a\"b\\c\n"; func f() { return; while () {} } var t = s;
+  // with the body's statements ahead of the top-level ones
+  ASTNode nodes[7];
+  InitNodes(nodes, 7);
+  for (int i = 0; i < 7; i++) nodes[i].id = i + 1;
+  SetStatement(&nodes[0], RETURN, 2);
+  nodes[0].meta.returnStmt.value = NULL;
+  SetStatement(&nodes[1], WHILE, 2);
+  nodes[1].meta.whileExpr.condition = NULL;
+  nodes[1].meta.whileExpr.body = 3;
+  SetStatement(&nodes[2], VAR, 1);
+  nodes[2].meta.varExpr.name = "s";
+  nodes[2].meta.varExpr.dataType = STRING;
+  nodes[2].meta.varExpr.value = &nodes[3];
+  nodes[3].type = STRING;
+  nodes[3].meta.stringExpr.value = "a\"b\\c\n";
+  SetStatement(&nodes[4], FUNC, 1);
+  nodes[4].meta.funcExpr.name = "f";
+  nodes[4].meta.funcExpr.params = NULL;
+  nodes[4].meta.funcExpr.body = 2;
+  SetStatement(&nodes[5], VAR, 1);
+  nodes[5].meta.varExpr.name = "t";
+  nodes[5].meta.varExpr.dataType = STRING;
+  nodes[5].meta.varExpr.value = &nodes[6];
+  nodes[6].type = VAR;
+  nodes[6].meta.varExpr.name = "s";
+  nodes[6].meta.varExpr.dataType = STRING;
+  nodes[6].meta.varExpr.value = NULL;
+
+  int scopes[] = {1, 2, 3, 4};
+  Scope scope;
+  InitScope(&scope);
+  scope.nodes = nodes;
+  scope.nodeLength = 7;
+  scope.scopes = scopes;
+  scope.scopeLength = 3;
+
+  char* json = ExpandToString(&scope);
+  char* expected = "["
+    "{\"type\": \"var\", \"id\": 3, \"name\": \"s\", \"dataType\": \"string\", \"value\": "
+      "{\"type\": \"string\", \"id\": 4, \"value\": \"a\\\"b\\\\c\\n\"}},"
+    "{\"type\": \"func\", \"id\": 5, \"name\": \"f\", \"params\": [], \"body\": ["
+      "{\"type\": \"return\", \"id\": 1, \"value\": null},"
+      "{\"type\": \"while\", \"id\": 2, \"condition\": null, \"body\": []}]},"
+    "{\"type\": \"var\", \"id\": 6, \"name\": \"t\", \"dataType\": \"string\", \"value\": "
+      "{\"type\": \"var\", \"id\": 7, \"name\": \"s\", \"dataType\": \"string\", \"value\": null}}"
+    "]";
+  if (strcmp(json, expected) != 0) FAILED_TEST3(expected, "was expanded as", json);
+  free(json);
+
+  // Nothing at the top level is still a list
+  scope.nodeLength = 0;
+  json = ExpandToString(&scope);
+  if (strcmp(json, "[]") != 0) FAILED_TEST3("[]", "was expanded as", json);
+  free(json);
+  SUCCESS_TEST("Expand scope");
+}
+
+void SetStatement(ASTNode* node, Token type, int scopeId) {
+  node->type = type;
+  node->isStmt = true;
+  node->scopeId = scopeId;
+}
+
+/**
+ * What ExpandScope writes, which the caller frees
+ */
+char* ExpandToString(Scope* scope) {
+  FILE* file = tmpfile();
+  if (file == NULL) FAILED_TEST("tmpfile");
+  ExpandScope(scope, file);
+  long length = ftell(file);
+  char* json = malloc(length + 1);
+  rewind(file);
+  if (fread(json, 1, length, file) != (size_t) length) FAILED_TEST("fread");
+  json[length] = '\0';
+  fclose(file);
+  return json;
+}
@@ -5,6 +5,12 @@
 #ifndef TEST_AST_H_
 #define TEST_AST_H_
 
+#include "condor/ast/ast.h"
+
 void Test_InitNodes();
+void Test_ExpandScope();
+
+void SetStatement(ASTNode* node, Token type, int scopeId);
+char* ExpandToString(Scope* scope);
 
 #endif // TEST_AST_H_
@@ -0,0 +1,107 @@
+#include <sys/stat.h>
+#include "test.h"
+#include "test_cache.h"
+#include "condor/cache/cache.h"
+
+#define CACHE_SOURCE "func fib(int n){ if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); } " \
+  "func tri(int n){ int s = 0; for (int i = 0; i < n; i++) { s += i; } return s; } " \
+  "var word = \"cached\"; fib(20); tri(10); word == \"cached\"; fib(21);"
+#define CACHE_OUTPUT ">> cached\n>> 6765\n>> 45\n>> 1\n>> 10946\n"
+
+void Test_CompileCache() {
+  char directory[] = "/tmp/condor_cache_XXXXXX";
+  if (mkdtemp(directory) == NULL) FAILED_TEST("mkdtemp");
+  setenv(CACHE_DIR_ENV, directory, 1);
+  char* path = GetCachePath(directory, CACHE_SOURCE);
+
+  // A miss saves the tree, and a later run maps it. A miss
+  // writes a new file, so the same inode means a hit.
+  EXPECT_OUTPUT(CACHE_SOURCE, CACHE_OUTPUT);
+  ino_t saved = GetInode(path);
+  if (saved == 0) FAILED_TEST("The tree is saved");
+  EXPECT_OUTPUT(CACHE_SOURCE, CACHE_OUTPUT);
+  if (GetInode(path) != saved) FAILED_TEST("The saved tree is a hit");
+
+  // Another source's tree under this source's name has a stale key
+  char* other = "func add(int a){ return a + 1; } add(1);";
+  char* stale = GetCachePath(directory, other);
+  if (rename(path, stale) != 0) FAILED_TEST("rename");
+  saved = GetInode(stale);
+  EXPECT_OUTPUT(other, ">> 2\n");
+  if (GetInode(stale) == saved) FAILED_TEST("A stale key is a miss");
+
+  // Damage anywhere is a miss, never a wrong run
+  EXPECT_OUTPUT(CACHE_SOURCE, CACHE_OUTPUT);
+  long size = GetFileSize(path);
+  for (long offset = 0; offset < size; offset += size / 24 + 1) {
+    FlipBit(path, offset);
+    saved = GetInode(path);
+    EXPECT_OUTPUT(CACHE_SOURCE, CACHE_OUTPUT);
+    if (GetInode(path) == saved) FAILED_TEST("A damaged tree is a miss");
+  }
+
+  unlink(path);
+  unlink(stale);
+  rmdir(directory);
+  free(path);
+  free(stale);
+  unsetenv(CACHE_DIR_ENV);
+  SUCCESS_TEST("Compile cache");
+}
+
+void Test_Snapshot() {
+  char path[] = "/tmp/condor_snapshot_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) FAILED_TEST("mkstemp");
+  close(fd);
+
+  // Saving runs the whole program, resuming runs it from the
+  // entry call on, with the string and fib's memo slots saved
+  EXPECT_SNAPSHOT(CACHE_SOURCE, "tri", path, CACHE_OUTPUT);
+  EXPECT_SNAPSHOT(NULL, NULL, path, ">> 45\n>> 1\n>> 10946\n");
+  EXPECT_SNAPSHOT(NULL, NULL, path, ">> 45\n>> 1\n>> 10946\n");
+
+  // Damage anywhere is refused
+  long size = GetFileSize(path);
+  for (long offset = 0; offset < size; offset += size / 40 + 1) {
+    FlipBit(path, offset);
+    EXPECT_SNAPSHOT(NULL, NULL, path, "Not resumed\n");
+    FlipBit(path, offset);
+  }
+  EXPECT_SNAPSHOT(NULL, NULL, path, ">> 45\n>> 1\n>> 10946\n");
+
+  unlink(path);
+  SUCCESS_TEST("Snapshot");
+}
+
+/**
+ * Where the cache keeps source's tree, which the caller frees
+ */
+char* GetCachePath(char* directory, char* source) {
+  char* path = malloc(PATH_MAX);
+  snprintf(path, PATH_MAX, "%s/%016llx.cdc", directory, (unsigned long long) HashCacheKey(source));
+  return path;
+}
+
+/**
+ * 0 when there is no file
+ */
+ino_t GetInode(char* path) {
+  struct stat info;
+  return stat(path, &info) == 0 ? info.st_ino : 0;
+}
+
+long GetFileSize(char* path) {
+  struct stat info;
+  return stat(path, &info) == 0 ? (long) info.st_size : 0;
+}
+
+void FlipBit(char* path, long offset) {
+  FILE* file = fopen(path, "r+b");
+  if (file == NULL) FAILED_TEST("fopen");
+  fseek(file, offset, SEEK_SET);
+  int byte = fgetc(file);
+  fseek(file, offset, SEEK_SET);
+  fputc(byte ^ (1 << (offset % 8)), file);
+  fclose(file);
+}
@@ -0,0 +1,18 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef TEST_CACHE_H_
+#define TEST_CACHE_H_
+
+#include <sys/types.h>
+
+void Test_CompileCache();
+void Test_Snapshot();
+
+char* GetCachePath(char* directory, char* source);
+ino_t GetInode(char* path);
+void FlipBit(char* path, long offset);
+long GetFileSize(char* path);
+
+#endif // TEST_CACHE_H_
@@ -0,0 +1,42 @@
+#include <stdint.h>
+#include "test.h"
+#include "test_mem.h"
+#include "condor/mem/arena.h"
+
+void Test_Arena() {
+  Arena arena;
+  InitArena(&arena);
+
+  // Allocations are aligned and do not overlap
+  char* a = ArenaAllocate(&arena, 3);
+  char* b = ArenaAllocate(&arena, 10);
+  if ((uintptr_t) a % 8 != 0 || (uintptr_t) b % 8 != 0) FAILED_TEST("Arena allocations are aligned");
+  if (b < a + 3) FAILED_TEST("Arena allocations do not overlap");
+  memcpy(a, "ab", 3);
+  memcpy(b, "cdefghijk", 10);
+
+  // The latest grows in place, an earlier one is copied
+  char* grown = ArenaReallocate(&arena, b, 10, 200);
+  if (grown != b || strcmp(grown, "cdefghijk") != 0) FAILED_TEST("The latest allocation grows in place");
+  char* moved = ArenaReallocate(&arena, a, 3, 100);
+  if (moved == a || strcmp(moved, "ab") != 0 || strcmp(grown, "cdefghijk") != 0) FAILED_TEST("An earlier allocation is copied");
+
+  // One bigger than a block gets its own, and the current
+  // block's free space is still handed out after it
+  char* small = ArenaAllocate(&arena, 8);
+  char* big = ArenaAllocate(&arena, ARENA_BLOCK_SIZE * 2);
+  memset(big, 'x', ARENA_BLOCK_SIZE * 2);
+  char* next = ArenaAllocate(&arena, 8);
+  if (next != small + 8) FAILED_TEST("A big allocation leaves the current block in use");
+
+  // Growing past a block moves to a new one
+  char* last = ArenaAllocate(&arena, 16);
+  memcpy(last, "last", 5);
+  char* far = ArenaReallocate(&arena, last, 16, ARENA_BLOCK_SIZE);
+  if (far == last || strcmp(far, "last") != 0) FAILED_TEST("Growing past the block copies");
+  if (big[ARENA_BLOCK_SIZE * 2 - 1] != 'x' || strcmp(moved, "ab") != 0) FAILED_TEST("Other allocations are left alone");
+
+  DestroyArena(&arena);
+  if (arena.blocks != NULL || arena.last != NULL) FAILED_TEST("Destroying empties the arena");
+  SUCCESS_TEST("Arena");
+}
@@ -0,0 +1,10 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef TEST_MEM_H_
+#define TEST_MEM_H_
+
+void Test_Arena();
+
+#endif // TEST_MEM_H_
@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include "test.h"
+#include "condor/number/number.h"
+#include "condor/number/format.h"
+
+/**
+ * A literal must read as the double strtod gives, bit for bit
+ */
+void ExpectParsedLike(char* literal) {
+  double parsed = ParseDoubleLiteral(literal, (int) strlen(literal));
+  double expected = strtod(literal, NULL);
+  if (memcmp(&parsed, &expected, sizeof(double)) != 0) FAILED_TEST3("Parsing", literal, "is not strtod's result");
+}
+
+void Test_ParseNumbers() {
+  long integer;
+  if (!ParseLongLiteral("9007199254740993", 16, &integer) || integer != 9007199254740993L) {
+    FAILED_TEST("2^53 + 1 as a long");
+  }
+  if (ParseLongLiteral("9223372036854775808", 19, &integer)) FAILED_TEST("A long that overflows");
+  if (ParseLongLiteral("1.5", 3, &integer)) FAILED_TEST("A decimal as a long");
+
+  // 2^53 + 1 is halfway between two doubles, it rounds to even
+  ExpectParsedLike("9007199254740993.0");
+  ExpectParsedLike("9007199254740995.0");
+  ExpectParsedLike("0.1");
+  ExpectParsedLike("0.2");
+  ExpectParsedLike("0.3");
+  ExpectParsedLike("123456789012345678901234567890.5");
+  ExpectParsedLike("1.7976931348623157");
+
+  // Subnormals go past the fast path's powers of ten
+  ExpectParsedLike("0.00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000494065645841246544");
+  ExpectParsedLike("0.0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000022250738585072009");
+
+  // Digits past the second decimal point are not read
+  double stopped = ParseDoubleLiteral("1.5.5", 5);
+  if (stopped != 1.5) FAILED_TEST("Reading stops at a second decimal point");
+
+  EXPECT_OUTPUT("func show(double x){ return x; } var a = 0.1; show(a + 0.2);", ">> 0.30000000000000004\n");
+#if NAN_BOXING
+  // A boxed long has 48 bits
+  EXPECT_OUTPUT("func show(long x){ return x; } show(9007199254740993);", "Integer overflow\n");
+#else
+  EXPECT_OUTPUT("func show(long x){ return x; } show(9007199254740993);", ">> 9007199254740993\n");
+#endif
+  SUCCESS_TEST("Parse numbers");
+}
+
+void ExpectFormatted(double value, char* expected) {
+  char buffer[FORMAT_BUFFER_SIZE];
+  int length = FormatDouble(value, buffer);
+  buffer[length] = '\0';
+  if (strcmp(buffer, expected) != 0) FAILED_TEST3(expected, "was formatted as", buffer);
+}
+
+/**
+ * Whether printf's nearest value with a significant digit
+ * fewer than formatted also reads back
+ */
+bool HasShorter(char* formatted, double value, bool isFloat) {
+  char digits[FORMAT_BUFFER_SIZE];
+  int length = 0;
+  for (char* spot = formatted; *spot != '\0' && *spot != 'e'; spot++) {
+    if (*spot >= '0' && *spot <= '9' && (length > 0 || *spot != '0')) digits[length++] = *spot;
+  }
+  while (length > 0 && digits[length - 1] == '0') length--;
+  if (length < 2) return false;
+
+  char shorter[64];
+  snprintf(shorter, sizeof(shorter), "%.*e", length - 2, value);
+  if (isFloat) return strtof(shorter, NULL) == (float) value;
+  return strtod(shorter, NULL) == value;
+}
+
+/**
+ * Deterministic bit patterns spread over every exponent
+ */
+uint64_t NextBits(uint64_t* state) {
+  *state = *state * 6364136223846793005UL + 1442695040888963407UL;
+  return *state ^ (*state >> 29);
+}
+
+void Test_FormatNumbers() {
+  char buffer[FORMAT_BUFFER_SIZE];
+  int length = FormatLong(-9223372036854775807L - 1, buffer);
+  buffer[length] = '\0';
+  if (strcmp(buffer, "-9223372036854775808") != 0) FAILED_TEST("The smallest long");
+
+  ExpectFormatted(0.0, "0.0");
+  ExpectFormatted(-0.0, "-0.0");
+  ExpectFormatted(0.1 + 0.2, "0.30000000000000004");
+  ExpectFormatted(9007199254740993.0, "9007199254740992.0");
+  ExpectFormatted(5e-324, "5e-324");
+  ExpectFormatted(1e23, "1e23");
+  ExpectFormatted(9e-265, "9e-265");
+  ExpectFormatted(5.9604644775390625e-8, "5.960464477539063e-8");
+  ExpectFormatted(2.2250738585072014e-308, "2.2250738585072014e-308");
+  ExpectFormatted(1.7976931348623157e308, "1.7976931348623157e308");
+  ExpectFormatted(1e21, "1e21");
+  ExpectFormatted(1e-7, "1e-7");
+  ExpectFormatted(0.000001, "0.000001");
+  ExpectFormatted(-2.5, "-2.5");
+  ExpectFormatted(0.0 / 0.0, "nan");
+  ExpectFormatted(-1.0 / 0.0, "-inf");
+
+  // Every double reads back as itself, and one printed without
+  // an exponent reads back through the literal parser as well
+  uint64_t state = 1;
+  for (int i = 0; i < 1000000; i++) {
+    uint64_t bits = NextBits(&state);
+    double value;
+    memcpy(&value, &bits, sizeof(double));
+    if (value != value) continue;
+
+    length = FormatDouble(value, buffer);
+    buffer[length] = '\0';
+    double back = strtod(buffer, NULL);
+    if (memcmp(&back, &value, sizeof(double)) != 0) FAILED_TEST3("Formatting", buffer, "does not read back");
+    if (HasShorter(buffer, value, false)) FAILED_TEST3("Formatting", buffer, "is not the shortest");
+
+    if (strchr(buffer, 'e') != NULL || value < 0) continue;
+    back = ParseDoubleLiteral(buffer, length);
+    if (memcmp(&back, &value, sizeof(double)) != 0) FAILED_TEST3("Parsing", buffer, "does not read back");
+  }
+
+  // Values with short decimals, which are all printed plainly
+  double scales[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+  for (int i = 0; i < 100000; i++) {
+    double value = (double) (NextBits(&state) % 100000000) / scales[NextBits(&state) % 9];
+    length = FormatDouble(value, buffer);
+    double back = ParseDoubleLiteral(buffer, length);
+    buffer[length] = '\0';
+    if (memcmp(&back, &value, sizeof(double)) != 0) FAILED_TEST3("Parsing", buffer, "does not read back");
+  }
+
+  for (int i = 0; i < 1000000; i++) {
+    uint32_t bits = (uint32_t) NextBits(&state);
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    if (value != value) continue;
+
+    length = FormatFloat(value, buffer);
+    buffer[length] = '\0';
+    float back = strtof(buffer, NULL);
+    if (memcmp(&back, &value, sizeof(float)) != 0) FAILED_TEST3("Formatting", buffer, "does not read back as a float");
+    if (HasShorter(buffer, value, true)) FAILED_TEST3("Formatting", buffer, "is not the shortest for a float");
+  }
+  SUCCESS_TEST("Format numbers");
+}
@@ -0,0 +1,11 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef TEST_NUMBER_H_
+#define TEST_NUMBER_H_
+
+void Test_ParseNumbers();
+void Test_FormatNumbers();
+
+#endif // TEST_NUMBER_H_
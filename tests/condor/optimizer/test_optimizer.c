@@ -0,0 +1,48 @@
+#include "test.h"
+#include "condor/optimizer/optimizer.h"
+
+void Test_DeadCode() {
+  // The loop variable's initializer stays whatever the incrementor
+  EXPECT_OUTPUT("int s = 0; for (int i = 0; i < 7; i += 2) { s += i; } int t = s * 1;", ">> 0\n>> 12\n");
+  EXPECT_OUTPUT("int s = 0; for (int i = 1; i < 7; i *= 2) { s += i; } int t = s * 1;", ">> 0\n>> 7\n");
+  EXPECT_OUTPUT("int s = 0; for (int i = 0; i < 7; i++) { s += i; } int t = s * 1;", ">> 0\n>> 21\n");
+  SUCCESS_TEST("Dead code");
+}
+
+void Test_Passes() {
+  // Only the calls print, so what a pass removes or rewrites
+  // inside the functions must not show
+  char* sources[] = {
+    "func sum(int n){ int s = 0; for (int i = 0; i < n; i++) { if (i % 3 == 0) { s += i * 4; } if (i % 3 != 0) { s += i / 2; } } return s; } sum(10); sum(0);",
+    "func fib(int n){ if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); } fib(15); fib(15);",
+    "func mix(int a, int b){ int x = (a + b) * (a + b); int y = (a + b) * 8; int z = 2 * 3 + 4; int w = z << 2; return x + y - w + (a + b) % 16; } mix(3, 4); mix(-5, 2);",
+    "func twice(int a){ return a * 2; } func quad(int b){ return twice(twice(b)); } quad(7); quad(twice(3));",
+    "func steps(int n){ int c = 0; int k = n; while (k > 1) { int odd = k % 2; if (odd == 0) { k = k / 2; } if (odd == 1) { k = 3 * k + 1; } c++; } return c; } steps(27);",
+    "func calc(long a){ long b = 1 << 4; long unused = a * 99; return a * b + a / 4 - a % 8 + (a >> 1); } calc(100); calc(-100);",
+  };
+  char* expected[] = {
+    ">> 84\n>> 0\n",
+    ">> 610\n>> 610\n",
+    ">> 72\n>> -58\n",
+    ">> 28\n>> 24\n",
+    ">> 111\n",
+    ">> 1671\n>> -1671\n",
+  };
+  char* skipped[] = {"inline", "fold", "dead", "cse", "memo", "reduce", "all"};
+
+  for (int i = 0; i < 6; i++) {
+    unsetenv(NO_OPTIMIZE_ENV);
+    EXPECT_OUTPUT(sources[i], expected[i]);
+    for (int k = 0; k < 7; k++) {
+      setenv(NO_OPTIMIZE_ENV, skipped[k], 1);
+      EXPECT_OUTPUT(sources[i], expected[i]);
+    }
+  }
+
+  // Switched off for real, an unread declaration is kept and printed
+  setenv(NO_OPTIMIZE_ENV, "fold,dead", 1);
+  EXPECT_OUTPUT("var l = 3; l + 1;", ">> 3\n>> 4\n");
+  unsetenv(NO_OPTIMIZE_ENV);
+  EXPECT_OUTPUT("var l = 3; l + 1;", ">> 4\n");
+  SUCCESS_TEST("Optimizer passes");
+}
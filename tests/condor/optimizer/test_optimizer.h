@@ -0,0 +1,11 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef TEST_OPTIMIZER_H_
+#define TEST_OPTIMIZER_H_
+
+void Test_DeadCode();
+void Test_Passes();
+
+#endif // TEST_OPTIMIZER_H_
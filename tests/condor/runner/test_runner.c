@@ -0,0 +1,149 @@
+#include "test.h"
+#include "test_runner.h"
+#include "condor/runner/runner-math.h"
+#include "condor/runner/runner-output.h"
+#include "Condor.h"
+
+void Test_Power() {
+  long power;
+  if (!RunPower(3, 39, &power) || power != 4052555153018976267L) FAILED_TEST("3 ** 39");
+  if (RunPower(2, 63, &power)) FAILED_TEST("2 ** 63 overflows a long");
+  if (RunPower(-2, 64, &power)) FAILED_TEST("-2 ** 64 overflows a long");
+  if (!RunPower(-2, 63, &power) || power != -9223372036854775807L - 1) FAILED_TEST("-2 ** 63");
+
+  EXPECT_OUTPUT("func p(int a, int b){ return a ** b; } p(2, 10); p(0 - 2, 3); p(7, 0);", ">> 1024\n>> -8\n>> 1\n");
+  EXPECT_OUTPUT("func p(int a, int b){ return a ** b; } p(2, 0 - 1); p(1, 0 - 5); p(0 - 1, 0 - 3);", ">> 0\n>> 1\n>> -1\n");
+  EXPECT_OUTPUT("func p(int a, int b){ return a ** b; } p(2, 31);", "Integer overflow\n");
+  EXPECT_OUTPUT("func p(int a, int b){ return a ** b; } p(0, 0 - 1);", "Division by zero\n");
+  EXPECT_OUTPUT("func p(long a, long b){ return a ** b; } p(3, 29);", ">> 68630377364883\n");
+  EXPECT_OUTPUT("func p(double a, double b){ return a ** b; } p(2.0, 0.5); p(2.0, 0.0 - 1.0);", ">> 1.4142135623730951\n>> 0.5\n");
+
+  // Right associative, and folded ahead of time
+  EXPECT_OUTPUT("func p(int a){ return a ** 2 ** 3; } p(2);", ">> 256\n");
+  EXPECT_OUTPUT("func f(int a){ return 2 ** 10 + a; } f(1);", ">> 1025\n");
+  SUCCESS_TEST("Power");
+}
+
+void Test_ConstantShifts() {
+  EXPECT_OUTPUT("func f(int a){ return a << 2; } f(3);", ">> 12\n");
+  EXPECT_OUTPUT("func f(int a){ return a >> 70; } f(3);", ">> 0\n");
+
+  // A negative count is only an error once the shift runs
+  EXPECT_OUTPUT("func f(long a, bool b){ if (b) { return a << -1; } return a; } f(3, false);", ">> 3\n");
+  EXPECT_OUTPUT("func f(long a, bool b){ if (b) { return a << -1; } return a; } f(3, true);", "Negative shift count\n");
+  SUCCESS_TEST("Constant Shifts");
+}
+
+void Test_Calls() {
+  // Arguments calling the same function, the if and the loop keep it from being inlined
+  EXPECT_OUTPUT("func sub(int a, int b){ if (a > 100) { return 0; } return a - b; } sub(sub(10, 3), sub(5, 1));", ">> 3\n");
+  EXPECT_OUTPUT("func add(int a, int b){ int c = a + b; for (int i = 0; i < 1; i++) { c = c + 0; } return c; } add(add(1, 2), add(3, 4));", ">> 10\n");
+
+  EXPECT_OUTPUT("func fib(int n){ if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); } fib(10); fib(20);", ">> 55\n>> 6765\n");
+  EXPECT_OUTPUT("func f(int n){ if (n == 0) { return 0; } return f(n - 1) + n; } f(10);", ">> 55\n");
+  EXPECT_OUTPUT("func f(int n){ if (n == 0) { return 0; } return n + f(n - 1); } f(10);", ">> 55\n");
+  EXPECT_OUTPUT("func f(int n){ int s = 0; for (int i = 0; i < n; i++) { s += f(i) + 1; } return s; } f(5);", ">> 31\n");
+  EXPECT_OUTPUT("func fact(long n){ if (n < 2) { return 1; } return n * fact(n - 1); } fact(15);", ">> 1307674368000\n");
+  EXPECT_OUTPUT("func d(int n){ if (n == 0) { return 0; } return d(n - 1) + 1; } d(1000);", ">> 1000\n");
+  EXPECT_OUTPUT("func d(int n){ if (n == 0) { return 0; } return d(n - 1) + 1; } d(1000000);", "Stack overflow\n");
+  EXPECT_OUTPUT("func even(int n){ if (n == 0) { return 1; } return odd(n - 1); }", "Symbol not found: \"odd\", at 1:54\n");
+  SUCCESS_TEST("Calls");
+}
+
+void Test_Narrowing() {
+  // Declarations
+  EXPECT_OUTPUT("int x = 1000000000; int y = x * 4;", "Integer overflow\n");
+  EXPECT_OUTPUT("int y = 5000000000;", "Integer overflow\n");
+  EXPECT_OUTPUT("byte b = 300;", "Integer overflow\n");
+  EXPECT_OUTPUT("long l = 9000000000; int k = l;", ">> 9000000000\nInteger overflow\n");
+  EXPECT_OUTPUT("byte b = -128; short s = 32767; int i = -2147483648; b + 0; s + 0; i + 0;", ">> -128\n>> 32767\n>> -2147483648\n");
+
+  // Plain and compound assignment alike
+  EXPECT_OUTPUT("int x = 1000000000; x = x * 4;", ">> 1000000000\nInteger overflow\n");
+  EXPECT_OUTPUT("int x = 1000000000; x *= 4;", ">> 1000000000\nInteger overflow\n");
+  EXPECT_OUTPUT("int x = 3000000000.5;", "Integer overflow\n");
+
+  // Arguments, literal or not, inlined or not
+  EXPECT_OUTPUT("func f(int a){ return a; } f(5000000000);", "Integer overflow\n");
+  EXPECT_OUTPUT("func g(int c){ return c + 1; } long l = 3000000000; g(l);", "Integer overflow\n");
+  EXPECT_OUTPUT("func g(int c){ return c + 1; } func w(long v){ return g(v * 2); } w(20); w(2000000000);", ">> 41\nInteger overflow\n");
+  EXPECT_OUTPUT("func h(byte q){ if (q > 0) { return q; } return 0; } h(200);", "Integer overflow\n");
+  EXPECT_OUTPUT("func h(byte q){ return q; } h(100);", ">> 100\n");
+  SUCCESS_TEST("Narrowing");
+}
+
+void Test_Output() {
+  // Writes are gathered, and one too big is passed on as is
+  TestChunks chunks = {NULL, 0, 0};
+  RunnerOutput output;
+  InitCallbackOutput(&output, CollectChunk, &chunks);
+  WriteOutput(&output, ">> 1\n", 5);
+  if (chunks.calls != 0) FAILED_TEST("A small write is gathered");
+  char* big = malloc(OUTPUT_BUFFER_SIZE + 1);
+  memset(big, 'x', OUTPUT_BUFFER_SIZE + 1);
+  WriteOutput(&output, big, OUTPUT_BUFFER_SIZE + 1);
+  if (chunks.calls != 2 || chunks.length != OUTPUT_BUFFER_SIZE + 6) FAILED_TEST("A big write flushes and passes on");
+  WriteOutput(&output, ">> 2\n", 5);
+  DestroyOutput(&output);
+  if (chunks.calls != 3 || memcmp(&chunks.data[chunks.length - 5], ">> 2\n", 5) != 0) FAILED_TEST("Destroying flushes");
+
+  // Memory grows to hold it all, and starts over once taken
+  InitMemoryOutput(&output);
+  for (int i = 0; i < 3; i++) WriteOutput(&output, big, OUTPUT_BUFFER_SIZE + 1);
+  int length;
+  char* memory = TakeOutputMemory(&output, &length);
+  if (length != 3 * (OUTPUT_BUFFER_SIZE + 1) || memory[length] != '\0') FAILED_TEST("Memory holds every write");
+  free(memory);
+  memory = TakeOutputMemory(&output, &length);
+  if (length != 0) FAILED_TEST("Taken memory starts over");
+  free(memory);
+  DestroyOutput(&output);
+  free(big);
+  free(chunks.data);
+
+  // Every sink gets what Scan prints, past a buffer's worth
+  int count = OUTPUT_BUFFER_SIZE / 8 + 100;
+  char* source = malloc(count * 9 + 64);
+  char* expected = malloc(count * 8 + 1);
+  int spot = sprintf(source, "func f(int a){ return a; } ");
+  for (int i = 0; i < count; i++) {
+    spot += sprintf(&source[spot], "f(%d);", 1000 + i % 9000);
+    sprintf(&expected[i * 8], ">> %d\n", 1000 + i % 9000);
+  }
+  EXPECT_OUTPUT(source, expected);
+  TestRun test = {source, NULL, NULL};
+  char* sunk = CaptureOutput(ScanToMemoryChild, &test);
+  if (strcmp(sunk, expected) != 0) FAILED_TEST("ScanToMemory prints as Scan does");
+  free(sunk);
+  sunk = CaptureOutput(ScanToCallbackChild, &test);
+  if (strcmp(sunk, expected) != 0) FAILED_TEST("ScanToCallback prints as Scan does");
+  free(sunk);
+  free(source);
+  free(expected);
+
+  // Results come before an error that stops the run
+  EXPECT_OUTPUT("func d(int a){ return 10 / a; } d(1); d(2); d(0); d(5);", ">> 10\n>> 5\nDivision by zero\n");
+  SUCCESS_TEST("Output");
+}
+
+void CollectChunk(const char* data, int length, void* user) {
+  TestChunks* chunks = user;
+  chunks->data = realloc(chunks->data, chunks->length + length);
+  memcpy(&chunks->data[chunks->length], data, length);
+  chunks->length += length;
+  chunks->calls++;
+}
+
+void ScanToMemoryChild(TestRun* test) {
+  int length;
+  char* memory = ScanToMemory(test->source, &length);
+  fwrite(memory, 1, length, stdout);
+  free(memory);
+}
+
+void ScanToCallbackChild(TestRun* test) {
+  TestChunks chunks = {NULL, 0, 0};
+  ScanToCallback(test->source, CollectChunk, &chunks);
+  fwrite(chunks.data, 1, chunks.length, stdout);
+  free(chunks.data);
+}
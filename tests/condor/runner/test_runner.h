@@ -0,0 +1,29 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef TEST_RUNNER_H_
+#define TEST_RUNNER_H_
+
+#include "test.h"
+
+void Test_Power();
+void Test_ConstantShifts();
+void Test_Calls();
+void Test_Narrowing();
+void Test_Output();
+
+/**
+ * What an output callback was handed, in order
+ */
+typedef struct TestChunks {
+  char* data;
+  int length;
+  int calls;
+} TestChunks;
+
+void CollectChunk(const char* data, int length, void* user);
+void ScanToMemoryChild(TestRun* test);
+void ScanToCallbackChild(TestRun* test);
+
+#endif // TEST_RUNNER_H_
@@ -0,0 +1,72 @@
+#include "test.h"
+
+void Test_Operands() {
+  EXPECT_OUTPUT("func s(int a){ return a * (a + 1); } s(3);", ">> 12\n");
+  EXPECT_OUTPUT("func s(int a){ return (a + 1) * ((a - 1) * 2); } s(3);", ">> 16\n");
+  EXPECT_OUTPUT("func f(int a){ if ((a + 1) > 2) { return 1; } return 0; } f(3); f(1);", ">> 1\n>> 0\n");
+  EXPECT_OUTPUT("func f(int a){ return (a; } f(3);", "Parse error: Expected: RPAREN, but got: ;, at 1:25\n");
+
+  // Negation binds tighter than any binary operator
+  EXPECT_OUTPUT("func id(int a){ return a; } id(-1); id(-(-7)); id(- 3 * 2);", ">> -1\n>> 7\n>> -6\n");
+  EXPECT_OUTPUT("func n(int a){ return -a ** 2; } n(3);", ">> 9\n");
+  EXPECT_OUTPUT("func f(double d){ return -d; } f(2.5);", ">> -2.5\n");
+  EXPECT_OUTPUT("func f(long d){ return -d; } f(5);", ">> -5\n");
+
+  EXPECT_OUTPUT("func f(int a, int b){ return (a - -b) * -(a + b) ** 2; } f(2, 3);", ">> 125\n");
+  EXPECT_OUTPUT("func f(int a){ return a -; } f(3);", "Expected: Operand after an operator\n");
+  EXPECT_OUTPUT("func f(int a){ return -; } f(3);", "Expected: Operand after -\n");
+
+  // Only the post increment is an expression
+  EXPECT_OUTPUT("int s = 0; int i = 0; s += ++i;", "Expected: Variable before ++ or --\n");
+  EXPECT_OUTPUT("int i = 0; int s = --i;", "Expected: Variable before ++ or --\n");
+  SUCCESS_TEST("Operands");
+}
+
+void Test_DeepNesting() {
+  // Nesting uses the parser's stacks, not the C stack
+  int depth = 30000;
+  char* source = malloc(depth * 4 + 64);
+  int length = sprintf(source, "func f(int a){ return ");
+  for (int i = 0; i < depth; i++) source[length++] = '(';
+  source[length++] = 'a';
+  for (int i = 0; i < depth; i++) source[length++] = ')';
+  strcpy(&source[length], " + 1; } f(2);");
+  EXPECT_OUTPUT(source, ">> 3\n");
+
+  length = sprintf(source, "func f(int a){ return ");
+  for (int i = 0; i < depth; i++) {
+    source[length++] = '-';
+    source[length++] = ' ';
+  }
+  strcpy(&source[length], "a; } f(2);");
+  EXPECT_OUTPUT(source, ">> 2\n");
+
+  length = sprintf(source, "func f(int a){ return ");
+  for (int i = 0; i < depth; i++) {
+    source[length++] = '-';
+    source[length++] = '(';
+  }
+  source[length++] = 'a';
+  for (int i = 0; i < depth; i++) source[length++] = ')';
+  strcpy(&source[length], "; } f(2);");
+  EXPECT_OUTPUT(source, ">> 2\n");
+  free(source);
+  SUCCESS_TEST("Deep nesting");
+}
+
+void Test_Scopes() {
+  // A name means the declaration in the innermost open scope
+  EXPECT_OUTPUT("func g(int a){ return a + 1; } func f(int a){ return g(a) * 10; } f(4);", ">> 50\n");
+  EXPECT_OUTPUT("func f(int a){ return a; } func g(int a){ return a * 2; } g(5); f(3);", ">> 10\n>> 3\n");
+  EXPECT_OUTPUT("func multiply(int a, int b){ return a * b; } func add(int a, int b){ return a + b; } multiply(add(9, 8), add(7, 6));", ">> 221\n");
+  EXPECT_OUTPUT("var a = 7; func f(int a){ return a * 2; } f(3); a + 0;", ">> 6\n>> 7\n");
+  EXPECT_OUTPUT("var k = 5; func f(int a){ return a + k; } f(1);", ">> 6\n");
+  EXPECT_OUTPUT("func f(int a){ int b = a; if (a > 1) { int b = 100; a = b; } return a + b; } f(2); f(1);", ">> 102\n>> 2\n");
+  EXPECT_OUTPUT("func s(int n){ int t = 0; for (int i = 0; i < n; i++) { t += i; } return t; } "
+    "func p(int n){ int t = 1; for (int i = 1; i <= n; i++) { t *= i; } return t; } s(4); p(4);", ">> 6\n>> 24\n");
+
+  // Nor is it seen once its scope is closed
+  EXPECT_OUTPUT("func f(int a){ if (a > 0) { int t = a; } return t; } f(1);", "Expected: Invalid identifier\n");
+  EXPECT_OUTPUT("for (int i = 0; i < 3; i++) { } i + 0;", "Expected: Invalid identifier\n");
+  SUCCESS_TEST("Scopes");
+}
@@ -0,0 +1,12 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef TEST_SYNTAX_H_
+#define TEST_SYNTAX_H_
+
+void Test_Operands();
+void Test_DeepNesting();
+void Test_Scopes();
+
+#endif // TEST_SYNTAX_H_
@@ -1,6 +1,30 @@
 #include <stdio.h>
 #include "./condor/ast/test_ast.h"
+#include "./condor/cache/test_cache.h"
+#include "./condor/mem/test_mem.h"
+#include "./condor/number/test_number.h"
+#include "./condor/optimizer/test_optimizer.h"
+#include "./condor/runner/test_runner.h"
+#include "./condor/syntax/test_syntax.h"
+#include "./utils/string/test_string.h"
 
 int main() {
   Test_InitNodes();
-}
\ No newline at end of file
+  Test_ExpandScope();
+  Test_Arena();
+  Test_StringBuilder();
+  Test_ParseNumbers();
+  Test_FormatNumbers();
+  Test_Power();
+  Test_ConstantShifts();
+  Test_Calls();
+  Test_Narrowing();
+  Test_Output();
+  Test_DeadCode();
+  Test_Passes();
+  Test_Operands();
+  Test_DeepNesting();
+  Test_Scopes();
+  Test_CompileCache();
+  Test_Snapshot();
+}
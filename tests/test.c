@@ -0,0 +1,62 @@
+#include "test.h"
+#include "Condor.h"
+
+char* RunSource(char* source) {
+  TestRun test = {source, NULL, NULL};
+  return CaptureOutput(ScanChild, &test);
+}
+
+char* RunSnapshot(char* source, char* entry, char* path) {
+  TestRun test = {source, entry, path};
+  return CaptureOutput(source != NULL ? SaveSnapshotChild : ResumeSnapshotChild, &test);
+}
+
+void ScanChild(TestRun* test) {
+  Scan(test->source);
+}
+
+void SaveSnapshotChild(TestRun* test) {
+  if (!ScanToSnapshot(test->source, test->entry, test->path)) printf("Not saved\n");
+}
+
+void ResumeSnapshotChild(TestRun* test) {
+  if (!ScanFromSnapshot(test->path)) printf("Not resumed\n");
+}
+
+char* CaptureOutput(void (*run)(TestRun* test), TestRun* test) {
+  int pipes[2];
+  if (pipe(pipes) != 0) FAILED_TEST("pipe");
+
+  // Anything buffered would be printed again by the child
+  fflush(stdout);
+  pid_t child = fork();
+  if (child < 0) FAILED_TEST("fork");
+  if (child == 0) {
+    close(pipes[0]);
+    dup2(pipes[1], STDOUT_FILENO);
+    run(test);
+    fflush(stdout);
+    exit(0);
+  }
+
+  close(pipes[1]);
+  int capacity = 256;
+  int length = 0;
+  char* output = malloc(capacity);
+  for (;;) {
+    if (capacity - length < 64) {
+      capacity *= 2;
+      output = realloc(output, capacity);
+    }
+    ssize_t got = read(pipes[0], &output[length], capacity - length - 32);
+    if (got <= 0) break;
+    length += (int) got;
+  }
+  close(pipes[0]);
+
+  int status;
+  waitpid(child, &status, 0);
+  if (WIFSIGNALED(status)) length += sprintf(&output[length], "Signal %d\n", WTERMSIG(status));
+  output[length] = '\0';
+  return output;
+}
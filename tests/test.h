@@ -0,0 +1,56 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+/**
+ * Helpers shared by the tests. A failure prints "Failed Test"
+ * and exits, which ctest reports as a failed test.
+ */
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "utils/assert.h"
+
+/**
+ * Run source in a child process and return what it printed,
+ * results and errors alike, which the caller frees. A crash
+ * shows up as "Signal n".
+ */
+char* RunSource(char* source);
+
+/**
+ * The same for snapshots: with source, save the snapshot at
+ * path before entry's first call, and without, resume it. A
+ * snapshot that is not saved or not resumed prints so.
+ */
+char* RunSnapshot(char* source, char* entry, char* path);
+
+typedef struct TestRun {
+  char* source;
+  char* entry;
+  char* path;
+} TestRun;
+
+char* CaptureOutput(void (*run)(TestRun* test), TestRun* test);
+void ScanChild(TestRun* test);
+void SaveSnapshotChild(TestRun* test);
+void ResumeSnapshotChild(TestRun* test);
+
+#define EXPECT_OUTPUT(source, expected) { \
+  char* output = RunSource(source); \
+  if (strcmp(output, expected) != 0) FAILED_TEST3(source, "printed", output); \
+  free(output); \
+}
+
+#define EXPECT_SNAPSHOT(source, entry, path, expected) { \
+  char* output = RunSnapshot(source, entry, path); \
+  if (strcmp(output, expected) != 0) FAILED_TEST3(path, "printed", output); \
+  free(output); \
+}
+
+#endif // TEST_H_
@@ -0,0 +1,59 @@
+#include "test.h"
+#include "test_string.h"
+
+void ExpectBuilt(StringBuilder* builder, char* expected) {
+  if (strcmp(builder->value, expected) != 0) FAILED_TEST3(expected, "was built as", builder->value);
+  if (builder->length != (int) strlen(expected)) FAILED_TEST3(expected, "has the wrong length, built as", builder->value);
+}
+
+void Test_StringBuilder() {
+  Arena arena;
+  InitArena(&arena);
+  Arena* arenas[] = {NULL, &arena};
+
+  for (int i = 0; i < 2; i++) {
+    StringBuilder builder;
+    InitStringBuilder(&builder, arenas[i]);
+    ExpectBuilt(&builder, "");
+    AppendString(&builder, "x = ");
+    AppendLong(&builder, -9223372036854775807L - 1);
+    AppendChar(&builder, ',');
+    AppendDouble(&builder, 0.1 + 0.2);
+    AppendStringLength(&builder, "; ignored", 1);
+    ExpectBuilt(&builder, "x = -9223372036854775808,0.30000000000000004;");
+
+    // A format that does not fit in the free space runs again
+    builder.length = 0;
+    AppendFormat(&builder, "%s-%d", "ab", 12);
+    ExpectBuilt(&builder, "ab-12");
+    AppendFormat(&builder, "%0200d", 7);
+    if (builder.length != 205 || builder.value[204] != '7' || builder.value[205] != '\0') FAILED_TEST("AppendFormat past the capacity");
+
+    // Thousands of appends, with another string built on the
+    // same arena in between, which moves the first
+    builder.length = 0;
+    StringBuilder other;
+    InitStringBuilder(&other, arenas[i]);
+    for (int k = 0; k < 20000; k++) {
+      AppendChar(&builder, (char) ('a' + k % 26));
+      if (k % 1000 == 0) AppendLong(&other, k);
+    }
+    if (builder.length != 20000 || strlen(builder.value) != 20000) FAILED_TEST("20000 appends");
+    for (int k = 0; k < 20000; k++) {
+      if (builder.value[k] != 'a' + k % 26) FAILED_TEST("Appends keep what came before");
+    }
+    if (strncmp(other.value, "0100020003000", 13) != 0 || other.length != 87) FAILED_TEST3("0100020003000", "was built as", other.value);
+
+    // Taking the string starts the builder over
+    int length;
+    char* taken = TakeString(&builder, &length);
+    if (length != 20000 || taken[19999] != 'a' + 19999 % 26) FAILED_TEST("TakeString hands the string over");
+    ExpectBuilt(&builder, "");
+    if (arenas[i] == NULL) free(taken);
+    DestroyStringBuilder(&builder);
+    DestroyStringBuilder(&other);
+  }
+
+  DestroyArena(&arena);
+  SUCCESS_TEST("String builder");
+}
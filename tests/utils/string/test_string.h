@@ -0,0 +1,14 @@
+// Copyright Chase Willden and The CondorLang Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef TEST_STRING_H_
+#define TEST_STRING_H_
+
+#include "utils/string/string.h"
+
+void Test_StringBuilder();
+
+void ExpectBuilt(StringBuilder* builder, char* expected);
+
+#endif // TEST_STRING_H_